@@ -21,6 +21,7 @@
 #pragma once
 
 #include <glib-object.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 #include "as-macros-private.h"
 #include "asc-canvas.h"
 #include "asc-font.h"
@@ -41,4 +42,42 @@ gboolean asc_canvas_draw_text (AscCanvas   *canvas,
 			       gint	    line_pad,
 			       GError	  **error);
 
+AS_INTERNAL_VISIBLE
+GdkPixbuf *asc_canvas_to_pixbuf (AscCanvas *canvas);
+
+/**
+ * AscSvgCacheStats:
+ * @n_parsed:	Number of SVG documents parsed.
+ * @n_hits:	Number of renders that reused an already parsed document.
+ * @n_evicted:	Number of documents dropped from the cache.
+ * @n_rendered:	Number of successful renders.
+ * @parse_usec:	Total time spent parsing, in microseconds.
+ * @render_usec: Total time spent rendering, in microseconds.
+ *
+ * Statistics of an #AscSvgCache.
+ **/
+typedef struct {
+	guint n_parsed;
+	guint n_hits;
+	guint n_evicted;
+	guint n_rendered;
+	gint64 parse_usec;
+	gint64 render_usec;
+} AscSvgCacheStats;
+
+typedef struct _AscSvgCache AscSvgCache;
+
+AS_INTERNAL_VISIBLE
+AscSvgCache *asc_svg_cache_new (gsize max_size);
+AS_INTERNAL_VISIBLE
+void	     asc_svg_cache_free (AscSvgCache *cache);
+AS_INTERNAL_VISIBLE
+void	     asc_svg_cache_clear (AscSvgCache *cache);
+AS_INTERNAL_VISIBLE
+void	     asc_svg_cache_get_stats (AscSvgCache *cache, AscSvgCacheStats *stats);
+AS_INTERNAL_VISIBLE
+GdkPixbuf   *asc_svg_cache_render (AscSvgCache *cache, GBytes *data, guint size, GError **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscSvgCache, asc_svg_cache_free)
+
 AS_END_PRIVATE_DECLS
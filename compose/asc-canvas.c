@@ -28,6 +28,7 @@
 #include "asc-canvas.h"
 #include "asc-canvas-private.h"
 
+#include <string.h>
 #include <cairo.h>
 #include <cairo-ft.h>
 #ifdef HAVE_SVG_SUPPORT
@@ -52,6 +53,8 @@ typedef struct {
 G_DEFINE_TYPE_WITH_PRIVATE (AscCanvas, asc_canvas, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (asc_canvas_get_instance_private (o))
 
+static const cairo_user_data_key_t asc_canvas_font_key;
+
 /**
  * asc_canvas_error_quark:
  *
@@ -141,21 +144,16 @@ asc_canvas_get_height (AscCanvas *canvas)
 	return priv->height;
 }
 
+#ifdef HAVE_SVG_SUPPORT
 /**
- * asc_canvas_render_svg:
- * @canvas: an #AscCanvas instance.
- * @stream: SVG data input stream.
- * @error: A #GError or %NULL
+ * asc_canvas_render_svg_handle:
  *
- * Render an SVG graphic from the SVG data provided.
- **/
-gboolean
-asc_canvas_render_svg (AscCanvas *canvas, GInputStream *stream, GError **error)
+ * Render an already parsed SVG document to fill the canvas.
+ */
+static gboolean
+asc_canvas_render_svg_handle (AscCanvas *canvas, RsvgHandle *handle, GError **error)
 {
-#ifdef HAVE_SVG_SUPPORT
 	AscCanvasPrivate *priv = GET_PRIVATE (canvas);
-	RsvgHandle *handle = NULL;
-	gboolean ret = FALSE;
 	gdouble srf_width, srf_height;
 #if LIBRSVG_CHECK_VERSION(2, 52, 0)
 	RsvgRectangle viewport;
@@ -163,20 +161,6 @@ asc_canvas_render_svg (AscCanvas *canvas, GInputStream *stream, GError **error)
 	RsvgDimensionData dims;
 #endif
 
-	/* NOTE: unfortunately, Cairo/RSvg may use Fontconfig internally, so
-	 * we need to lock this down since a parallel-processed font
-	 * might need to access this too. */
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&fontconfig_mutex);
-
-	handle = rsvg_handle_new_from_stream_sync (stream,
-						   NULL,
-						   RSVG_HANDLE_FLAGS_NONE,
-						   NULL,
-						   error);
-	if (handle == NULL)
-		goto out;
-	rsvg_handle_set_dpi (handle, 100);
-
 	srf_width = (gdouble) cairo_image_surface_get_width (priv->srf);
 	srf_height = (gdouble) cairo_image_surface_get_height (priv->srf);
 
@@ -188,11 +172,10 @@ asc_canvas_render_svg (AscCanvas *canvas, GInputStream *stream, GError **error)
 	viewport.width = srf_width;
 	viewport.height = srf_height;
 
-	ret = rsvg_handle_render_document (handle, priv->cr, &viewport, error);
-	if (!ret) {
+	if (!rsvg_handle_render_document (handle, priv->cr, &viewport, error)) {
 		cairo_restore (priv->cr);
 		g_prefix_error (error, "SVG graphic rendering failed:");
-		goto out;
+		return FALSE;
 	}
 #else
 	rsvg_handle_get_dimensions (handle, &dims);
@@ -200,21 +183,67 @@ asc_canvas_render_svg (AscCanvas *canvas, GInputStream *stream, GError **error)
 	/* cairo_translate (cr, (srf_width - dims.width) / 2, (srf_height - dims.height) / 2); */
 	cairo_scale (priv->cr, srf_width / dims.width, srf_height / dims.height);
 
-	ret = rsvg_handle_render_cairo (handle, priv->cr);
-	if (!ret) {
+	if (!rsvg_handle_render_cairo (handle, priv->cr)) {
 		cairo_restore (priv->cr);
 		g_set_error_literal (error,
 				     ASC_CANVAS_ERROR,
 				     ASC_CANVAS_ERROR_DRAWING,
 				     "SVG graphic rendering failed.");
-		goto out;
+		return FALSE;
 	}
 #endif
 
-	ret = TRUE;
-out:
-	if (handle != NULL)
-		g_object_unref (handle);
+	return TRUE;
+}
+
+/**
+ * asc_canvas_parse_svg:
+ *
+ * Parse SVG data from a stream, which may be gzip-compressed.
+ */
+static RsvgHandle *
+asc_canvas_parse_svg (GInputStream *stream, GError **error)
+{
+	RsvgHandle *handle;
+
+	/* RSvg may use Fontconfig internally via Pango, make sure its configuration
+	 * is loaded once and never rescanned while we render in parallel */
+	asc_font_init_fontconfig ();
+
+	handle = rsvg_handle_new_from_stream_sync (stream,
+						   NULL,
+						   RSVG_HANDLE_FLAGS_NONE,
+						   NULL,
+						   error);
+	if (handle == NULL)
+		return NULL;
+	rsvg_handle_set_dpi (handle, 100);
+
+	return handle;
+}
+#endif
+
+/**
+ * asc_canvas_render_svg:
+ * @canvas: an #AscCanvas instance.
+ * @stream: SVG data input stream.
+ * @error: A #GError or %NULL
+ *
+ * Render an SVG graphic from the SVG data provided.
+ **/
+gboolean
+asc_canvas_render_svg (AscCanvas *canvas, GInputStream *stream, GError **error)
+{
+#ifdef HAVE_SVG_SUPPORT
+	RsvgHandle *handle;
+	gboolean ret;
+
+	handle = asc_canvas_parse_svg (stream, error);
+	if (handle == NULL)
+		return FALSE;
+
+	ret = asc_canvas_render_svg_handle (canvas, handle, error);
+	g_object_unref (handle);
 	return ret;
 #else
 	g_warning ("Unable to render SVG graphic: AppStream built without SVG support.");
@@ -229,6 +258,42 @@ out:
 #endif
 }
 
+/**
+ * asc_canvas_create_font_face:
+ *
+ * Create a Cairo font face for the given font. Cairo may cache the face
+ * beyond the lifetime of our canvas, so the font is kept alive for as long
+ * as Cairo holds a reference to it.
+ */
+static cairo_font_face_t *
+asc_canvas_create_font_face (AscFont *font, GError **error)
+{
+	cairo_font_face_t *cff;
+	cairo_status_t status;
+
+	cff = cairo_ft_font_face_create_for_ft_face (asc_font_get_ftface (font), FT_LOAD_DEFAULT);
+	status = cairo_font_face_status (cff);
+	if (status == CAIRO_STATUS_SUCCESS) {
+		status = cairo_font_face_set_user_data (cff,
+							&asc_canvas_font_key,
+							g_object_ref (font),
+							g_object_unref);
+		if (status != CAIRO_STATUS_SUCCESS)
+			g_object_unref (font);
+	}
+	if (status != CAIRO_STATUS_SUCCESS) {
+		g_set_error (error,
+			     ASC_CANVAS_ERROR,
+			     ASC_CANVAS_ERROR_FONT,
+			     "Could not set font face for Cairo: %i",
+			     status);
+		cairo_font_face_destroy (cff);
+		return NULL;
+	}
+
+	return cff;
+}
+
 /**
  * asc_canvas_draw_text_line:
  * @canvas: an #AscCanvas instance.
@@ -247,11 +312,8 @@ asc_canvas_draw_text_line (AscCanvas *canvas,
 {
 	AscCanvasPrivate *priv = GET_PRIVATE (canvas);
 	cairo_font_face_t *cff = NULL;
-	cairo_status_t status;
 	cairo_text_extents_t te;
 	gint text_size;
-	gboolean ret = FALSE;
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&fontconfig_mutex);
 
 	/* set default value */
 	if (border_width < 0)
@@ -265,19 +327,12 @@ asc_canvas_draw_text_line (AscCanvas *canvas,
 		return FALSE;
 	}
 
-	cff = cairo_ft_font_face_create_for_ft_face (asc_font_get_ftface (font), FT_LOAD_DEFAULT);
-
 	/* set font face for Cairo surface */
-	status = cairo_font_face_status (cff);
-	if (status != CAIRO_STATUS_SUCCESS) {
-		g_set_error (error,
-			     ASC_CANVAS_ERROR,
-			     ASC_CANVAS_ERROR_FONT,
-			     "Could not set font face for Cairo: %i",
-			     status);
-		goto out;
-	}
+	cff = asc_canvas_create_font_face (font, error);
+	if (cff == NULL)
+		return FALSE;
 	cairo_set_font_face (priv->cr, cff);
+	cairo_font_face_destroy (cff);
 
 	text_size = 128;
 	while (text_size-- > 0) {
@@ -298,12 +353,7 @@ asc_canvas_draw_text_line (AscCanvas *canvas,
 	cairo_show_text (priv->cr, text);
 
 	cairo_save (priv->cr);
-	ret = TRUE;
-
-out:
-	if (cff != NULL)
-		cairo_font_face_destroy (cff);
-	return ret;
+	return TRUE;
 }
 
 /**
@@ -325,9 +375,7 @@ asc_canvas_draw_text (AscCanvas *canvas,
 		      GError **error)
 {
 	AscCanvasPrivate *priv = GET_PRIVATE (canvas);
-	gboolean ret = FALSE;
 	cairo_font_face_t *cff = NULL;
-	cairo_status_t status;
 	cairo_text_extents_t te;
 	g_auto(GStrv) lines = NULL;
 	guint lines_len;
@@ -335,7 +383,6 @@ asc_canvas_draw_text (AscCanvas *canvas,
 	const gchar *longest_line;
 	gint text_size;
 	double x_pos, y_pos, te_height;
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&fontconfig_mutex);
 
 	/* set default values */
 	if (border_width < 0)
@@ -351,18 +398,12 @@ asc_canvas_draw_text (AscCanvas *canvas,
 		return FALSE;
 	}
 
-	cff = cairo_ft_font_face_create_for_ft_face (asc_font_get_ftface (font), FT_LOAD_DEFAULT);
 	/* set font face for Cairo surface */
-	status = cairo_font_face_status (cff);
-	if (status != CAIRO_STATUS_SUCCESS) {
-		g_set_error (error,
-			     ASC_CANVAS_ERROR,
-			     ASC_CANVAS_ERROR_FONT,
-			     "Could not set font face for Cairo: %i",
-			     status);
-		goto out;
-	}
+	cff = asc_canvas_create_font_face (font, error);
+	if (cff == NULL)
+		return FALSE;
 	cairo_set_font_face (priv->cr, cff);
+	cairo_font_face_destroy (cff);
 
 	/* calculate best font size */
 	line_padding = line_pad;
@@ -408,12 +449,7 @@ asc_canvas_draw_text (AscCanvas *canvas,
 	}
 
 	cairo_save (priv->cr);
-	ret = TRUE;
-
-out:
-	if (cff != NULL)
-		cairo_font_face_destroy (cff);
-	return ret;
+	return TRUE;
 }
 
 /**
@@ -442,3 +478,294 @@ asc_canvas_save_png (AscCanvas *canvas, const gchar *fname, GError **error)
 
 	return asc_optimize_png (fname, error);
 }
+
+/**
+ * asc_canvas_to_pixbuf:
+ * @canvas: an #AscCanvas instance.
+ *
+ * Convert the canvas contents to a #GdkPixbuf.
+ *
+ * Returns: (transfer full): a new #GdkPixbuf
+ **/
+GdkPixbuf *
+asc_canvas_to_pixbuf (AscCanvas *canvas)
+{
+	AscCanvasPrivate *priv = GET_PRIVATE (canvas);
+	GdkPixbuf *pix;
+	const guchar *srf_data;
+	guchar *pix_data;
+	gint srf_stride;
+	gint pix_stride;
+
+	cairo_surface_flush (priv->srf);
+	srf_data = cairo_image_surface_get_data (priv->srf);
+	srf_stride = cairo_image_surface_get_stride (priv->srf);
+
+	pix = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, priv->width, priv->height);
+	pix_data = gdk_pixbuf_get_pixels (pix);
+	pix_stride = gdk_pixbuf_get_rowstride (pix);
+
+	/* Cairo stores premultiplied ARGB in native endianness, GdkPixbuf wants plain RGBA */
+	for (gint y = 0; y < priv->height; y++) {
+		const guint32 *src = (const guint32 *) (srf_data + (gsize) y * srf_stride);
+		guchar *dst = pix_data + (gsize) y * pix_stride;
+
+		for (gint x = 0; x < priv->width; x++) {
+			guint32 px = src[x];
+			guint alpha = px >> 24;
+
+			if (alpha == 0) {
+				dst[0] = dst[1] = dst[2] = 0;
+			} else {
+				dst[0] = (((px >> 16) & 0xff) * 255 + alpha / 2) / alpha;
+				dst[1] = (((px >> 8) & 0xff) * 255 + alpha / 2) / alpha;
+				dst[2] = ((px & 0xff) * 255 + alpha / 2) / alpha;
+			}
+			dst[3] = alpha;
+			dst += 4;
+		}
+	}
+
+	return pix;
+}
+
+#ifdef HAVE_SVG_SUPPORT
+typedef struct {
+	GMutex mutex;
+	RsvgHandle *handle;
+	gchar *hash;
+	gsize cost;
+	GList lru_link;
+} AscSvgCacheEntry;
+
+static void
+asc_svg_cache_entry_clear (AscSvgCacheEntry *entry)
+{
+	g_mutex_clear (&entry->mutex);
+	g_object_unref (entry->handle);
+	g_free (entry->hash);
+}
+
+static AscSvgCacheEntry *
+asc_svg_cache_entry_ref (AscSvgCacheEntry *entry)
+{
+	return g_atomic_rc_box_acquire (entry);
+}
+
+static void
+asc_svg_cache_entry_unref (AscSvgCacheEntry *entry)
+{
+	g_atomic_rc_box_release_full (entry, (GDestroyNotify) asc_svg_cache_entry_clear);
+}
+#endif
+
+struct _AscSvgCache {
+	GMutex mutex;
+	GHashTable *entries;
+	GQueue lru;
+	gsize max_cost;
+	gsize cost;
+	AscSvgCacheStats stats;
+};
+
+/**
+ * asc_svg_cache_unlink_all:
+ *
+ * Empty the LRU queue. The queue links are embedded in the
+ * entries, so they must only be unlinked and never freed.
+ */
+static void
+asc_svg_cache_unlink_all (AscSvgCache *cache)
+{
+#ifdef HAVE_SVG_SUPPORT
+	while (cache->lru.head != NULL)
+		g_queue_unlink (&cache->lru, cache->lru.head);
+#endif
+	g_queue_init (&cache->lru);
+}
+
+/**
+ * asc_svg_cache_new:
+ * @max_size: Approximate amount of SVG data to keep parsed, in bytes.
+ *
+ * Create a new cache of parsed SVG documents, so the same document
+ * can be rendered in multiple sizes and by multiple units without
+ * parsing it again. Documents are identified by a hash of their data
+ * and the least recently used ones are dropped once @max_size is exceeded.
+ *
+ * Returns: (transfer full): a new #AscSvgCache
+ **/
+AscSvgCache *
+asc_svg_cache_new (gsize max_size)
+{
+	AscSvgCache *cache = g_new0 (AscSvgCache, 1);
+
+	g_mutex_init (&cache->mutex);
+#ifdef HAVE_SVG_SUPPORT
+	cache->entries = g_hash_table_new_full (g_str_hash,
+						g_str_equal,
+						NULL,
+						(GDestroyNotify) asc_svg_cache_entry_unref);
+#else
+	cache->entries = g_hash_table_new (g_str_hash, g_str_equal);
+#endif
+	g_queue_init (&cache->lru);
+	cache->max_cost = max_size;
+
+	return cache;
+}
+
+/**
+ * asc_svg_cache_free:
+ * @cache: an #AscSvgCache
+ *
+ * Free the cache and all documents it holds.
+ **/
+void
+asc_svg_cache_free (AscSvgCache *cache)
+{
+	if (cache == NULL)
+		return;
+	asc_svg_cache_unlink_all (cache);
+	g_hash_table_unref (cache->entries);
+	g_mutex_clear (&cache->mutex);
+	g_free (cache);
+}
+
+/**
+ * asc_svg_cache_clear:
+ * @cache: an #AscSvgCache
+ *
+ * Drop all cached documents and reset the statistics.
+ **/
+void
+asc_svg_cache_clear (AscSvgCache *cache)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+	asc_svg_cache_unlink_all (cache);
+	g_hash_table_remove_all (cache->entries);
+	cache->cost = 0;
+	memset (&cache->stats, 0, sizeof (cache->stats));
+}
+
+/**
+ * asc_svg_cache_get_stats:
+ * @cache: an #AscSvgCache
+ * @stats: (out caller-allocates): Location to store the statistics.
+ *
+ * Get parse and render statistics for this cache.
+ **/
+void
+asc_svg_cache_get_stats (AscSvgCache *cache, AscSvgCacheStats *stats)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+	*stats = cache->stats;
+}
+
+/**
+ * asc_svg_cache_render:
+ * @cache: an #AscSvgCache
+ * @data: SVG data, may be gzip-compressed.
+ * @size: Edge length of the square image to render.
+ * @error: A #GError or %NULL
+ *
+ * Render the SVG document in @data to a square image, reusing an already
+ * parsed document if the same data was seen before.
+ *
+ * Returns: (transfer full): the rendered image, or %NULL on error.
+ **/
+GdkPixbuf *
+asc_svg_cache_render (AscSvgCache *cache, GBytes *data, guint size, GError **error)
+{
+#ifdef HAVE_SVG_SUPPORT
+	AscSvgCacheEntry *entry = NULL;
+	g_autoptr(AscCanvas) cv = NULL;
+	g_autofree gchar *hash = NULL;
+	gint64 start_time;
+	gboolean ret;
+
+	hash = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, data);
+
+	g_mutex_lock (&cache->mutex);
+	entry = g_hash_table_lookup (cache->entries, hash);
+	if (entry != NULL) {
+		/* mark as most recently used */
+		g_queue_unlink (&cache->lru, &entry->lru_link);
+		g_queue_push_tail_link (&cache->lru, &entry->lru_link);
+		asc_svg_cache_entry_ref (entry);
+		cache->stats.n_hits++;
+	}
+	g_mutex_unlock (&cache->mutex);
+
+	if (entry == NULL) {
+		AscSvgCacheEntry *existing;
+		g_autoptr(GInputStream) stream = NULL;
+		RsvgHandle *handle;
+
+		start_time = g_get_monotonic_time ();
+		stream = g_memory_input_stream_new_from_bytes (data);
+		handle = asc_canvas_parse_svg (stream, error);
+		if (handle == NULL)
+			return NULL;
+
+		entry = g_atomic_rc_box_new0 (AscSvgCacheEntry);
+		g_mutex_init (&entry->mutex);
+		entry->handle = handle;
+		entry->hash = g_steal_pointer (&hash);
+		entry->cost = g_bytes_get_size (data);
+		entry->lru_link.data = entry;
+
+		g_mutex_lock (&cache->mutex);
+		cache->stats.n_parsed++;
+		cache->stats.parse_usec += g_get_monotonic_time () - start_time;
+
+		existing = g_hash_table_lookup (cache->entries, entry->hash);
+		if (existing != NULL) {
+			/* another thread parsed the same document in the meantime */
+			asc_svg_cache_entry_unref (entry);
+			entry = asc_svg_cache_entry_ref (existing);
+		} else {
+			g_hash_table_insert (cache->entries,
+					     entry->hash,
+					     asc_svg_cache_entry_ref (entry));
+			g_queue_push_tail_link (&cache->lru, &entry->lru_link);
+			cache->cost += entry->cost;
+
+			/* evict the least recently used documents, entries that are still
+			 * being rendered stay alive until the render is done */
+			while (cache->cost > cache->max_cost && cache->lru.head != &entry->lru_link) {
+				AscSvgCacheEntry *old = g_queue_peek_head (&cache->lru);
+				g_queue_unlink (&cache->lru, &old->lru_link);
+				cache->cost -= old->cost;
+				cache->stats.n_evicted++;
+				g_hash_table_remove (cache->entries, old->hash);
+			}
+		}
+		g_mutex_unlock (&cache->mutex);
+	}
+
+	/* RsvgHandle is not threadsafe, so only one thread can render a document at a time */
+	start_time = g_get_monotonic_time ();
+	cv = asc_canvas_new (size, size);
+	g_mutex_lock (&entry->mutex);
+	ret = asc_canvas_render_svg_handle (cv, entry->handle, error);
+	g_mutex_unlock (&entry->mutex);
+	asc_svg_cache_entry_unref (entry);
+	if (!ret)
+		return NULL;
+
+	g_mutex_lock (&cache->mutex);
+	cache->stats.n_rendered++;
+	cache->stats.render_usec += g_get_monotonic_time () - start_time;
+	g_mutex_unlock (&cache->mutex);
+
+	return asc_canvas_to_pixbuf (cv);
+#else
+	g_set_error_literal (error,
+			     ASC_CANVAS_ERROR,
+			     ASC_CANVAS_ERROR_UNSUPPORTED,
+			     "AppStream was built without SVG support.");
+	return NULL;
+#endif
+}
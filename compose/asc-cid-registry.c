@@ -0,0 +1,180 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:asc-cid-registry
+ * @short_description: Registry of component IDs seen in a compose run.
+ *
+ * Every component ID may only be provided by one unit. This registry records
+ * which unit owns an ID, identified by the position of the unit in the compose run.
+ * If multiple units provide the same ID, the one that comes first always wins,
+ * no matter in which order the units are actually processed.
+ *
+ * The registry is split into shards with their own locks, so threads
+ * registering different IDs rarely have to wait for each other.
+ */
+
+#include "config.h"
+#include "asc-cid-registry.h"
+
+#define ASC_CID_REGISTRY_N_SHARDS 32
+
+typedef struct {
+	GMutex mutex;
+	GHashTable *owners; /* utf8->uint (component-id -> owner + 1) */
+} AscCidRegistryShard;
+
+struct _AscCidRegistry {
+	AscCidRegistryShard shards[ASC_CID_REGISTRY_N_SHARDS];
+};
+
+static AscCidRegistryShard *
+asc_cid_registry_get_shard (AscCidRegistry *creg, const gchar *cid)
+{
+	return &creg->shards[g_str_hash (cid) % ASC_CID_REGISTRY_N_SHARDS];
+}
+
+/**
+ * asc_cid_registry_new:
+ *
+ * Create a new, empty component ID registry.
+ *
+ * Returns: (transfer full): a new #AscCidRegistry
+ **/
+AscCidRegistry *
+asc_cid_registry_new (void)
+{
+	AscCidRegistry *creg = g_new0 (AscCidRegistry, 1);
+
+	for (guint i = 0; i < ASC_CID_REGISTRY_N_SHARDS; i++) {
+		g_mutex_init (&creg->shards[i].mutex);
+		creg->shards[i].owners = g_hash_table_new_full (g_str_hash,
+								g_str_equal,
+								g_free,
+								NULL);
+	}
+	return creg;
+}
+
+/**
+ * asc_cid_registry_free:
+ * @creg: an #AscCidRegistry
+ *
+ * Free the registry.
+ **/
+void
+asc_cid_registry_free (AscCidRegistry *creg)
+{
+	if (creg == NULL)
+		return;
+	for (guint i = 0; i < ASC_CID_REGISTRY_N_SHARDS; i++) {
+		g_hash_table_unref (creg->shards[i].owners);
+		g_mutex_clear (&creg->shards[i].mutex);
+	}
+	g_free (creg);
+}
+
+/**
+ * asc_cid_registry_clear:
+ * @creg: an #AscCidRegistry
+ *
+ * Forget all registered component IDs.
+ **/
+void
+asc_cid_registry_clear (AscCidRegistry *creg)
+{
+	for (guint i = 0; i < ASC_CID_REGISTRY_N_SHARDS; i++) {
+		g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&creg->shards[i].mutex);
+		g_hash_table_remove_all (creg->shards[i].owners);
+	}
+}
+
+/**
+ * asc_cid_registry_claim:
+ * @creg: an #AscCidRegistry
+ * @cid: The component ID.
+ * @owner: Position of the unit providing the component.
+ *
+ * Register @owner as provider of @cid, unless it is already provided by
+ * the same or an earlier unit. Checking and registering the ID happens atomically.
+ *
+ * If a later unit had claimed @cid before, @owner takes its place. Use
+ * asc_cid_registry_get_owner() once all units are processed to find out
+ * whether a claim is still valid.
+ *
+ * Returns: %TRUE if @owner is now the provider of @cid.
+ **/
+gboolean
+asc_cid_registry_claim (AscCidRegistry *creg, const gchar *cid, guint owner)
+{
+	AscCidRegistryShard *shard = asc_cid_registry_get_shard (creg, cid);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&shard->mutex);
+	gpointer value;
+
+	value = g_hash_table_lookup (shard->owners, cid);
+	if (value != NULL && GPOINTER_TO_UINT (value) - 1 <= owner)
+		return FALSE;
+
+	g_hash_table_insert (shard->owners, g_strdup (cid), GUINT_TO_POINTER (owner + 1));
+	return TRUE;
+}
+
+/**
+ * asc_cid_registry_get_owner:
+ * @creg: an #AscCidRegistry
+ * @cid: The component ID.
+ * @owner: (out) (optional): Position of the unit providing the component.
+ *
+ * Look up the current provider of @cid.
+ *
+ * Returns: %TRUE if @cid was registered.
+ **/
+gboolean
+asc_cid_registry_get_owner (AscCidRegistry *creg, const gchar *cid, guint *owner)
+{
+	AscCidRegistryShard *shard = asc_cid_registry_get_shard (creg, cid);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&shard->mutex);
+	gpointer value;
+
+	value = g_hash_table_lookup (shard->owners, cid);
+	if (value == NULL)
+		return FALSE;
+	if (owner != NULL)
+		*owner = GPOINTER_TO_UINT (value) - 1;
+	return TRUE;
+}
+
+/**
+ * asc_cid_registry_get_size:
+ * @creg: an #AscCidRegistry
+ *
+ * Returns: The number of registered component IDs.
+ **/
+guint
+asc_cid_registry_get_size (AscCidRegistry *creg)
+{
+	guint size = 0;
+
+	for (guint i = 0; i < ASC_CID_REGISTRY_N_SHARDS; i++) {
+		g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&creg->shards[i].mutex);
+		size += g_hash_table_size (creg->shards[i].owners);
+	}
+	return size;
+}
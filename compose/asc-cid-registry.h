@@ -0,0 +1,46 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include "as-macros-private.h"
+
+AS_BEGIN_PRIVATE_DECLS
+
+typedef struct _AscCidRegistry AscCidRegistry;
+
+AS_INTERNAL_VISIBLE
+AscCidRegistry *asc_cid_registry_new (void);
+AS_INTERNAL_VISIBLE
+void		asc_cid_registry_free (AscCidRegistry *creg);
+AS_INTERNAL_VISIBLE
+void		asc_cid_registry_clear (AscCidRegistry *creg);
+
+AS_INTERNAL_VISIBLE
+gboolean	asc_cid_registry_claim (AscCidRegistry *creg, const gchar *cid, guint owner);
+AS_INTERNAL_VISIBLE
+gboolean	asc_cid_registry_get_owner (AscCidRegistry *creg, const gchar *cid, guint *owner);
+AS_INTERNAL_VISIBLE
+guint		asc_cid_registry_get_size (AscCidRegistry *creg);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscCidRegistry, asc_cid_registry_free)
+
+AS_END_PRIVATE_DECLS
@@ -29,6 +29,7 @@
 
 #include <errno.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "as-utils-private.h"
 #include "as-yaml.h"
@@ -38,12 +39,37 @@
 #include "asc-utils.h"
 #include "asc-hint.h"
 #include "asc-result.h"
+#include "asc-result-private.h"
 
 #include "asc-utils-metainfo.h"
 #include "asc-utils-l10n.h"
 #include "asc-utils-screenshots.h"
 #include "asc-utils-fonts.h"
 #include "asc-image.h"
+#include "asc-canvas-private.h"
+#include "asc-media-registry.h"
+#include "asc-cid-registry.h"
+#include "asc-trace.h"
+
+/* amount of SVG data we keep parsed for rendering icons in multiple sizes */
+#define ASC_COMPOSE_SVG_CACHE_SIZE (32 * 1024 * 1024)
+
+/* objects that are expensive to set up, kept alive to process many units */
+typedef struct {
+	AsMetadata *mdata;
+	AsValidator *validator;
+	AsCurl *acurl;
+} AscComposeWorker;
+
+static void
+asc_compose_worker_free (AscComposeWorker *worker)
+{
+	g_object_unref (worker->mdata);
+	g_object_unref (worker->validator);
+	if (worker->acurl != NULL)
+		g_object_unref (worker->acurl);
+	g_free (worker);
+}
 
 typedef struct {
 	GPtrArray *units;
@@ -67,8 +93,15 @@ typedef struct {
 	gchar *icons_result_dir;
 	gchar *media_result_dir;
 	gchar *hints_result_dir;
-
-	GHashTable *known_cids;
+	gchar *trace_fname;
+
+	AscCidRegistry *cid_registry;
+	AscSvgCache *svg_cache;
+	AscMediaRegistry *media_registry;
+	GPtrArray *idle_workers;
+	AscTrace *trace;
+	gchar *spill_dir;
+	guint spill_serial;
 	GMutex mutex;
 
 	AscCheckMetadataEarlyFn check_md_early_fn;
@@ -89,8 +122,12 @@ asc_compose_init (AscCompose *compose)
 	priv->units = g_ptr_array_new_with_free_func (g_object_unref);
 	priv->results = g_ptr_array_new_with_free_func (g_object_unref);
 	priv->allowed_cids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-	priv->known_cids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->cid_registry = asc_cid_registry_new ();
 	priv->custom_allowed = g_ptr_array_new_with_free_func (g_free);
+	priv->svg_cache = asc_svg_cache_new (ASC_COMPOSE_SVG_CACHE_SIZE);
+	priv->media_registry = asc_media_registry_new ();
+	priv->idle_workers = g_ptr_array_new_with_free_func (
+	    (GDestroyNotify) asc_compose_worker_free);
 	g_mutex_init (&priv->mutex);
 
 	/* defaults */
@@ -107,6 +144,25 @@ asc_compose_init (AscCompose *compose)
 	priv->icon_policy = asc_icon_policy_new ();
 }
 
+/**
+ * asc_compose_remove_spill_dir:
+ *
+ * Remove the directory of spilled results, including the files
+ * of results that are still referenced elsewhere.
+ */
+static void
+asc_compose_remove_spill_dir (AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+
+	if (priv->spill_dir == NULL)
+		return;
+	if (!as_utils_delete_dir_recursive (priv->spill_dir))
+		g_warning ("Unable to remove directory for temporary results: %s",
+			   priv->spill_dir);
+	g_clear_pointer (&priv->spill_dir, g_free);
+}
+
 static void
 asc_compose_finalize (GObject *object)
 {
@@ -116,10 +172,14 @@ asc_compose_finalize (GObject *object)
 	g_ptr_array_unref (priv->units);
 	g_ptr_array_unref (priv->results);
 	g_ptr_array_unref (priv->custom_allowed);
+	asc_compose_remove_spill_dir (compose);
 	g_free (priv->cainfo);
 
 	g_hash_table_unref (priv->allowed_cids);
-	g_hash_table_unref (priv->known_cids);
+	asc_cid_registry_free (priv->cid_registry);
+	asc_svg_cache_free (priv->svg_cache);
+	asc_media_registry_free (priv->media_registry);
+	g_ptr_array_unref (priv->idle_workers);
 	as_ref_string_release (priv->prefix);
 	as_ref_string_release (priv->origin);
 	g_free (priv->media_baseurl);
@@ -128,6 +188,8 @@ asc_compose_finalize (GObject *object)
 	g_free (priv->icons_result_dir);
 	g_free (priv->media_result_dir);
 	g_free (priv->hints_result_dir);
+	g_free (priv->trace_fname);
+	asc_trace_free (priv->trace);
 
 	if (priv->locale_unit != NULL)
 		g_object_unref (priv->locale_unit);
@@ -160,7 +222,12 @@ asc_compose_reset (AscCompose *compose)
 	g_hash_table_remove_all (priv->allowed_cids);
 	g_ptr_array_set_size (priv->units, 0);
 	g_ptr_array_set_size (priv->results, 0);
-	g_hash_table_remove_all (priv->known_cids);
+	asc_compose_remove_spill_dir (compose);
+	asc_cid_registry_clear (priv->cid_registry);
+	asc_svg_cache_clear (priv->svg_cache);
+	asc_media_registry_clear (priv->media_registry);
+	g_ptr_array_set_size (priv->idle_workers, 0);
+	g_clear_pointer (&priv->trace, asc_trace_free);
 }
 
 /**
@@ -437,6 +504,9 @@ asc_compose_set_cainfo (AscCompose *compose, const gchar *cainfo)
 	AscComposePrivate *priv = GET_PRIVATE (compose);
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	as_assign_string_safe (priv->cainfo, cainfo);
+
+	/* idle workers were set up with the old CA info */
+	g_ptr_array_set_size (priv->idle_workers, 0);
 }
 
 /**
@@ -555,6 +625,104 @@ asc_compose_set_hints_result_dir (AscCompose *compose, const gchar *dir)
 	as_assign_string_safe (priv->hints_result_dir, dir);
 }
 
+/**
+ * asc_compose_get_trace_filename:
+ * @compose: an #AscCompose instance.
+ *
+ * Get the file a trace of the compose run is written to.
+ */
+const gchar *
+asc_compose_get_trace_filename (AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	return priv->trace_fname;
+}
+
+/**
+ * asc_compose_set_trace_filename:
+ * @compose: an #AscCompose instance.
+ * @fname: (nullable): the trace file, or %NULL to disable tracing.
+ *
+ * Record how long each processing stage takes for every unit and component,
+ * and write the result to @fname in the Chrome trace-event JSON format
+ * once the compose run is done. The trace can be inspected with Perfetto
+ * or chrome://tracing.
+ */
+void
+asc_compose_set_trace_filename (AscCompose *compose, const gchar *fname)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+	as_assign_string_safe (priv->trace_fname, fname);
+}
+
+/**
+ * asc_compose_get_trace_summary:
+ * @compose: an #AscCompose instance.
+ *
+ * Get a human-readable summary of the time spent in each processing stage
+ * during the last compose run. This is only available if a trace file was set.
+ *
+ * Returns: (transfer full) (nullable): The summary, or %NULL if no trace was recorded.
+ */
+gchar *
+asc_compose_get_trace_summary (AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	if (priv->trace == NULL)
+		return NULL;
+	return asc_trace_get_summary (priv->trace);
+}
+
+/**
+ * asc_compose_get_statistics_summary:
+ * @compose: an #AscCompose instance.
+ *
+ * Get a human-readable summary of the media processing statistics of all
+ * compose runs since this instance was created or last reset, such as
+ * the time spent parsing and rendering SVG icons and the data saved by
+ * reusing media generated from identical input.
+ *
+ * Returns: (transfer full) (nullable): The summary, or %NULL if no media was processed.
+ */
+gchar *
+asc_compose_get_statistics_summary (AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	AscSvgCacheStats svg_stats;
+	AscMediaRegistryStats media_stats;
+	GString *str = g_string_new (NULL);
+
+	asc_svg_cache_get_stats (priv->svg_cache, &svg_stats);
+	if (svg_stats.n_parsed > 0 || svg_stats.n_hits > 0)
+		g_string_append_printf (
+		    str,
+		    "SVG icons: %u parsed in %.1f ms, %u rendered in %.1f ms, %u cache hits, %u evicted\n",
+		    svg_stats.n_parsed,
+		    svg_stats.parse_usec / 1000.0,
+		    svg_stats.n_rendered,
+		    svg_stats.render_usec / 1000.0,
+		    svg_stats.n_hits,
+		    svg_stats.n_evicted);
+
+	asc_media_registry_get_stats (priv->media_registry, &media_stats);
+	if (media_stats.n_reused > 0) {
+		g_autofree gchar *bytes_saved_str = g_format_size (media_stats.bytes_saved);
+		g_string_append_printf (
+		    str,
+		    "Media: %u files reused from identical data, saving %s and %.1f s of processing\n",
+		    media_stats.n_reused,
+		    bytes_saved_str,
+		    media_stats.usec_saved / (gdouble) G_USEC_PER_SEC);
+	}
+
+	if (str->len == 0) {
+		g_string_free (str, TRUE);
+		return NULL;
+	}
+	return g_string_free (str, FALSE);
+}
+
 /**
  * asc_compose_remove_custom_allowed:
  * @compose: an #AscCompose instance.
@@ -769,19 +937,66 @@ asc_compose_has_errors (AscCompose *compose)
 	return FALSE;
 }
 
+/**
+ * AscCatalogWriter:
+ *
+ * Helper to stream catalog metadata to a (compressed) file as soon as
+ * the results of each unit are finalized. Data is always written in
+ * unit order, so the generated catalog is deterministic regardless of
+ * the order in which worker threads complete their tasks.
+ */
+typedef struct {
+	GPtrArray *tasks; /* no ref */
+	guint next_idx;
+
+	GFile *part_file;
+	GFile *final_file;
+	GOutputStream *out;
+
+	gboolean have_data;
+	GError *error;
+	GMutex mutex;
+} AscCatalogWriter;
+
+static void
+asc_catalog_writer_free (AscCatalogWriter *cwriter)
+{
+	if (cwriter->out != NULL) {
+		/* we were never closed properly, so the partial file must not be used */
+		g_output_stream_close (cwriter->out, NULL, NULL);
+		g_object_unref (cwriter->out);
+		g_file_delete (cwriter->part_file, NULL, NULL);
+	}
+	g_object_unref (cwriter->part_file);
+	g_object_unref (cwriter->final_file);
+	g_clear_error (&cwriter->error);
+	g_mutex_clear (&cwriter->mutex);
+	g_free (cwriter);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscCatalogWriter, asc_catalog_writer_free)
+
 typedef struct {
 	AscUnit *unit;
 	AscResult *result;
 	GHashTable *files_units_map; /* no ref */
+	guint idx;
+	GPtrArray *claimed_cids;
+
+	AscCatalogWriter *cwriter; /* no ref */
+	gchar *catalog_data;
+	gboolean finished;
 } AscComposeTask;
 
 static AscComposeTask *
-asc_compose_task_new (AscUnit *unit)
+asc_compose_task_new (AscUnit *unit, guint idx)
 {
 	AscComposeTask *ctask;
 	ctask = g_new0 (AscComposeTask, 1);
 	ctask->unit = g_object_ref (unit);
 	ctask->result = asc_result_new ();
+	ctask->idx = idx;
+	ctask->claimed_cids = g_ptr_array_new_with_free_func (g_free);
 	return ctask;
 }
 
@@ -790,6 +1005,8 @@ asc_compose_task_free (AscComposeTask *ctask)
 {
 	g_object_unref (ctask->unit);
 	g_object_unref (ctask->result);
+	g_ptr_array_unref (ctask->claimed_cids);
+	g_free (ctask->catalog_data);
 	g_free (ctask);
 }
 
@@ -915,6 +1132,51 @@ asc_compose_find_icon_filename (AscCompose *compose,
 	return NULL;
 }
 
+/**
+ * asc_compose_load_icon_image:
+ *
+ * Load icon data, rendering vector graphics at the given size.
+ */
+static AscImage *
+asc_compose_load_icon_image (AscCompose *compose,
+			     GBytes *img_bytes,
+			     gboolean is_vector_icon,
+			     gboolean is_compressed,
+			     guint render_size,
+			     GError **error)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	const void *img_data;
+	gsize img_len;
+
+	if (is_vector_icon) {
+		g_autoptr(GdkPixbuf) pix = NULL;
+		g_autoptr(GError) tmp_error = NULL;
+
+		/* render from the shared cache, so each SVG document is only parsed once */
+		pix = asc_svg_cache_render (priv->svg_cache, img_bytes, render_size, &tmp_error);
+		if (pix != NULL) {
+			AscImage *img = asc_image_new ();
+			asc_image_set_pixbuf (img, pix);
+			return img;
+		}
+
+		/* if we can't render SVGs ourselves, GdkPixbuf might be able to */
+		if (!g_error_matches (tmp_error, ASC_CANVAS_ERROR, ASC_CANVAS_ERROR_UNSUPPORTED)) {
+			g_propagate_error (error, g_steal_pointer (&tmp_error));
+			return NULL;
+		}
+	}
+
+	img_data = g_bytes_get_data (img_bytes, &img_len);
+	return asc_image_new_from_data (img_data,
+					img_len,
+					is_vector_icon ? render_size : 0,
+					is_compressed,
+					ASC_IMAGE_LOAD_FLAG_ALWAYS_RESIZE,
+					error);
+}
+
 static void
 asc_compose_process_icons (AscCompose *compose,
 			   AscResult *cres,
@@ -973,21 +1235,28 @@ asc_compose_process_icons (AscCompose *compose,
 		g_autofree gchar *res_icon_basename = NULL;
 		g_autoptr(AscImage) img = NULL;
 		g_autoptr(AsIcon) icon = NULL;
+		g_autofree gchar *mreg_key = NULL;
 		g_autoptr(GBytes) img_bytes = NULL;
 		gboolean is_vector_icon = FALSE;
-		const void *img_data;
-		gsize img_len;
+		gboolean ret;
+		gint64 trace_start;
 		g_autoptr(GError) error = NULL;
 
 		/* skip icon if its size should be skipped */
 		if (icon_state == ASC_ICON_STATE_IGNORED)
 			continue;
 
+		trace_start = asc_trace_begin (priv->trace);
 		icon_fname = asc_compose_find_icon_filename (compose,
 							     unit,
 							     icon_name,
 							     size,
 							     scale_factor);
+		asc_trace_end (priv->trace,
+			       trace_start,
+			       "icon-lookup",
+			       asc_unit_get_bundle_id (unit),
+			       as_component_get_id (cpt));
 
 		if (icon_fname == NULL) {
 			/* only a 64x64px icon is mandatory, everything else is optional */
@@ -1017,55 +1286,86 @@ asc_compose_process_icons (AscCompose *compose,
 					     NULL);
 			return;
 		}
-		img_data = g_bytes_get_data (img_bytes, &img_len);
-		img = asc_image_new_from_data (img_data,
-					       img_len,
-					       is_vector_icon ? size * scale_factor : 0,
-					       g_str_has_suffix (icon_fname, ".svgz"),
-					       ASC_IMAGE_LOAD_FLAG_ALWAYS_RESIZE,
-					       &error);
-		if (img == NULL) {
-			asc_result_add_hint (cres,
-					     cpt,
-					     "file-read-error",
-					     "fname",
-					     icon_fname,
-					     "msg",
-					     error->message,
-					     NULL);
-			return;
-		}
-
-		/* we only take exact-ish size matches for 48x48px */
-		if (size == 48 && asc_image_get_width (img) > 48)
-			continue;
-
 		res_icon_size_str = (scale_factor == 1)
 					? g_strdup_printf ("%ix%i", size, size)
 					: g_strdup_printf ("%ix%i@%i", size, size, scale_factor);
 		res_icon_sizedir = g_build_filename (icon_export_dir, res_icon_size_str, NULL);
-
-		g_mkdir_with_parents (res_icon_sizedir, 0755);
 		res_icon_basename = g_strdup_printf ("%s.png", as_component_get_id (cpt));
 		res_icon_fname = g_build_filename (res_icon_sizedir, res_icon_basename, NULL);
 
-		/* scale & save the image */
-		g_debug ("Saving icon: %s", res_icon_fname);
-		if (!asc_image_save_filename (img,
+		/* reuse the result if identical icon data was already rendered in this size */
+		mreg_key = asc_media_registry_make_key (img_bytes, res_icon_size_str);
+		if (asc_media_registry_reuse (priv->media_registry,
+					      mreg_key,
 					      res_icon_fname,
-					      size * scale_factor,
-					      size * scale_factor,
-					      ASC_IMAGE_SAVE_FLAG_OPTIMIZE,
-					      &error)) {
-			asc_result_add_hint (cres,
-					     cpt,
-					     "icon-write-error",
-					     "fname",
-					     icon_fname,
-					     "msg",
-					     error->message,
-					     NULL);
-			return;
+					      NULL,
+					      NULL)) {
+			g_debug ("Reusing icon: %s", res_icon_fname);
+		} else {
+			gint64 start_time = g_get_monotonic_time ();
+
+			trace_start = asc_trace_begin (priv->trace);
+			img = asc_compose_load_icon_image (compose,
+							   img_bytes,
+							   is_vector_icon,
+							   g_str_has_suffix (icon_fname, ".svgz"),
+							   size * scale_factor,
+							   &error);
+			asc_trace_end (priv->trace,
+				       trace_start,
+				       is_vector_icon ? "icon-render-svg" : "icon-load",
+				       asc_unit_get_bundle_id (unit),
+				       as_component_get_id (cpt));
+			if (img == NULL) {
+				asc_result_add_hint (cres,
+						     cpt,
+						     "file-read-error",
+						     "fname",
+						     icon_fname,
+						     "msg",
+						     error->message,
+						     NULL);
+				return;
+			}
+
+			/* we only take exact-ish size matches for 48x48px */
+			if (size == 48 && asc_image_get_width (img) > 48)
+				continue;
+
+			g_mkdir_with_parents (res_icon_sizedir, 0755);
+
+			/* scale & save the image */
+			g_debug ("Saving icon: %s", res_icon_fname);
+			trace_start = asc_trace_begin (priv->trace);
+			ret = asc_image_save_filename (img,
+						       res_icon_fname,
+						       size * scale_factor,
+						       size * scale_factor,
+						       ASC_IMAGE_SAVE_FLAG_OPTIMIZE,
+						       &error);
+			asc_trace_end (priv->trace,
+				       trace_start,
+				       "icon-save",
+				       asc_unit_get_bundle_id (unit),
+				       as_component_get_id (cpt));
+			if (!ret) {
+				asc_result_add_hint (cres,
+						     cpt,
+						     "icon-write-error",
+						     "fname",
+						     icon_fname,
+						     "msg",
+						     error->message,
+						     NULL);
+				return;
+			}
+
+			asc_media_registry_add (priv->media_registry,
+						mreg_key,
+						res_icon_fname,
+						asc_image_get_width (img),
+						asc_image_get_height (img),
+						g_get_monotonic_time () - start_time);
 		}
 
 		/* create a remote reference if we have data for it */
@@ -1092,7 +1392,7 @@ asc_compose_process_icons (AscCompose *compose,
 			g_mkdir_with_parents (icons_media_path, 0755);
 
 			g_debug ("Adding media pool icon: %s", icon_media_fname);
-			if (!as_copy_file (res_icon_fname, icon_media_fname, &error)) {
+			if (!asc_link_or_copy_file (res_icon_fname, icon_media_fname, &error)) {
 				g_warning ("Unable to write media pool icon: %s", icon_media_fname);
 				asc_result_add_hint (cres,
 						     cpt,
@@ -1177,12 +1477,34 @@ as_compose_yaml_write_handler_cb (void *ptr, unsigned char *buffer, size_t size)
 	return 1;
 }
 
+/**
+ * asc_compose_drop_displaced_components:
+ *
+ * Remove components of a task that were also provided by an earlier unit,
+ * which was processed only after this task claimed the component ID.
+ * This must only be called once all earlier units have been processed.
+ *
+ * Returns: %TRUE if any component was removed.
+ */
 static gboolean
-asc_compose_component_known (AscCompose *compose, AsComponent *cpt)
+asc_compose_drop_displaced_components (AscCompose *compose, AscComposeTask *ctask)
 {
 	AscComposePrivate *priv = GET_PRIVATE (compose);
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
-	return g_hash_table_contains (priv->known_cids, as_component_get_id (cpt));
+	gboolean removed = FALSE;
+
+	for (guint i = 0; i < ctask->claimed_cids->len; i++) {
+		const gchar *cid = g_ptr_array_index (ctask->claimed_cids, i);
+		guint owner;
+
+		if (!asc_cid_registry_get_owner (priv->cid_registry, cid, &owner) ||
+		    owner == ctask->idx)
+			continue;
+		asc_result_add_hint_by_cid (ctask->result, cid, "duplicate-component", NULL);
+		removed = TRUE;
+	}
+	g_ptr_array_set_size (ctask->claimed_cids, 0);
+
+	return removed;
 }
 
 /**
@@ -1332,51 +1654,112 @@ asc_compose_finalize_components (AscCompose *compose, AscResult *cres)
 	}
 }
 
+/**
+ * asc_compose_acquire_worker:
+ *
+ * Take an idle worker, or create a new one if all existing
+ * workers are busy. Workers are reused for all units of a run, so at most
+ * one worker per processing thread is ever created.
+ */
+static AscComposeWorker *
+asc_compose_acquire_worker (AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	AscComposeWorker *worker = NULL;
+	g_autofree gchar *cainfo = NULL;
+	g_autoptr(GError) tmp_error = NULL;
+
+	g_mutex_lock (&priv->mutex);
+	if (priv->idle_workers->len > 0)
+		worker = g_ptr_array_steal_index_fast (priv->idle_workers,
+						       priv->idle_workers->len - 1);
+	cainfo = g_strdup (priv->cainfo);
+	g_mutex_unlock (&priv->mutex);
+
+	if (worker != NULL) {
+		/* drop everything the previous unit left behind */
+		as_metadata_clear_components (worker->mdata);
+		as_metadata_clear_releases (worker->mdata);
+		as_validator_clear_release_data (worker->validator);
+		return worker;
+	}
+
+	worker = g_new0 (AscComposeWorker, 1);
+
+	/* configure metadata loader */
+	worker->mdata = as_metadata_new ();
+	as_metadata_set_locale (worker->mdata, "ALL");
+	as_metadata_set_format_style (worker->mdata, AS_FORMAT_STYLE_METAINFO);
+
+	/* create validator */
+	worker->validator = as_validator_new ();
+
+	/* Curl interface for this worker */
+	worker->acurl = as_curl_new (&tmp_error);
+	if (worker->acurl == NULL)
+		g_critical ("Unable to initialize networking: %s", tmp_error->message);
+	else if (cainfo != NULL)
+		as_curl_set_cainfo (worker->acurl, cainfo);
+
+	return worker;
+}
+
+/**
+ * asc_compose_release_worker:
+ *
+ * Return a worker to the idle list once it is done with a unit.
+ */
+static void
+asc_compose_release_worker (AscCompose *compose, AscComposeWorker *worker)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+
+	/* a worker without networking could not be set up properly, try again next time */
+	if (worker->acurl == NULL) {
+		asc_compose_worker_free (worker);
+		return;
+	}
+
+	g_ptr_array_add (priv->idle_workers, worker);
+}
+
 static void
-asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
+asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose, AscComposeWorker *worker)
 {
 	AscComposePrivate *priv = GET_PRIVATE (compose);
 	g_autofree gchar *metainfo_dir = NULL;
 	g_autofree gchar *app_dir = NULL;
 	g_autofree gchar *share_dir = NULL;
-	g_autoptr(AsMetadata) mdata = NULL;
-	g_autoptr(AsValidator) validator = NULL;
 	g_autoptr(GPtrArray) mi_fnames = NULL;
 	g_autoptr(GHashTable) de_fname_map = NULL;
 	g_autoptr(GPtrArray) found_cpts = NULL;
-	g_autoptr(AsCurl) acurl = NULL;
 	g_autoptr(GError) tmp_error = NULL;
+	AsMetadata *mdata = worker->mdata;
+	AsValidator *validator = worker->validator;
+	AsCurl *acurl = worker->acurl;
+	const gchar *unit_name = asc_unit_get_bundle_id (ctask->unit);
 	gboolean has_fonts = FALSE;
 	gboolean filter_cpts = FALSE;
 	GPtrArray *contents = NULL;
+	gint64 unit_trace_start;
+	gint64 trace_start;
+
+	unit_trace_start = asc_trace_begin (priv->trace);
 
 	/* propagate unit bundle ID */
 	asc_result_set_bundle_id (ctask->result, asc_unit_get_bundle_id (ctask->unit));
 	asc_result_set_bundle_kind (ctask->result, asc_unit_get_bundle_kind (ctask->unit));
 
-	/* configure metadata loader */
-	mdata = as_metadata_new ();
-	as_metadata_set_locale (mdata, "ALL");
-	as_metadata_set_format_style (mdata, AS_FORMAT_STYLE_METAINFO);
-
-	/* create validator */
-	validator = as_validator_new ();
-
-	/* Curl interface for this task */
-	acurl = as_curl_new (&tmp_error);
-	if (acurl == NULL) {
-		g_critical ("Unable to initialize networking: %s", tmp_error->message);
-		g_error_free (g_steal_pointer (&tmp_error));
-	}
-	if (priv->cainfo != NULL)
-		as_curl_set_cainfo (acurl, priv->cainfo);
-
 	/* give unit a hint as to which paths we want to read */
 	share_dir = g_build_filename (priv->prefix, "share", NULL);
 	asc_unit_add_relevant_path (ctask->unit, share_dir);
 
 	/* open our unit for reading */
+	trace_start = asc_trace_begin (priv->trace);
 	if (!asc_unit_open (ctask->unit, &tmp_error)) {
+		asc_trace_end (priv->trace, trace_start, "unit-open", unit_name, NULL);
+		asc_trace_end (priv->trace, unit_trace_start, "unit", unit_name, NULL);
 		g_warning ("Failed to open unit: %s", tmp_error->message);
 		asc_result_add_hint (ctask->result,
 				     NULL,
@@ -1388,6 +1771,7 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 				     NULL);
 		return;
 	}
+	asc_trace_end (priv->trace, trace_start, "unit-open", unit_name, NULL);
 	contents = asc_unit_get_contents (ctask->unit);
 
 	/* collect interesting data for this unit */
@@ -1428,6 +1812,7 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 		mi_basename = g_path_get_basename (mi_fname);
 
 		g_debug ("Processing: %s", mi_fname);
+		trace_start = asc_trace_begin (priv->trace);
 		mi_bytes = asc_unit_read_data (ctask->unit, mi_fname, &local_error);
 		if (mi_bytes == NULL) {
 			asc_result_add_hint_by_cid (ctask->result,
@@ -1443,6 +1828,7 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 		}
 		as_metadata_clear_components (mdata);
 		cpt = asc_parse_metainfo_data (ctask->result, mdata, mi_bytes, mi_basename);
+		asc_trace_end (priv->trace, trace_start, "metainfo-parse", unit_name, mi_basename);
 		if (cpt == NULL) {
 			g_debug ("Rejected: %s", mi_basename);
 			continue;
@@ -1457,16 +1843,18 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 			}
 		}
 
-		/* check if we have a duplicate */
-		if (asc_compose_component_known (compose, cpt)) {
+		/* check if we have a duplicate - if an earlier unit provides the same
+		 * component later on, this unit's component gets dropped again */
+		if (!asc_cid_registry_claim (priv->cid_registry,
+					     as_component_get_id (cpt),
+					     ctask->idx)) {
 			asc_result_add_hint_simple (ctask->result, cpt, "duplicate-component");
 			continue;
-		} else {
-			g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
-			g_hash_table_add (priv->known_cids, g_strdup (as_component_get_id (cpt)));
 		}
+		g_ptr_array_add (ctask->claimed_cids, g_strdup (as_component_get_id (cpt)));
 
 		/* process any release information of this component and download release data if needed */
+		trace_start = asc_trace_begin (priv->trace);
 		asc_process_metainfo_releases (
 		    ctask->result,
 		    ctask->unit,
@@ -1475,15 +1863,26 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 		    as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_ALLOW_NET),
 		    acurl,
 		    &rel_bytes);
+		asc_trace_end (priv->trace,
+			       trace_start,
+			       "releases",
+			       unit_name,
+			       as_component_get_id (cpt));
 
 		/* validate the data */
 		if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_VALIDATE)) {
+			trace_start = asc_trace_begin (priv->trace);
 			asc_validate_metainfo_data_for_component (ctask->result,
 								  validator,
 								  cpt,
 								  mi_bytes,
 								  mi_basename,
 								  rel_bytes);
+			asc_trace_end (priv->trace,
+				       trace_start,
+				       "validate",
+				       unit_name,
+				       as_component_get_id (cpt));
 		}
 
 		/* legacy support: Synthesize launchable entry if none was set,
@@ -1559,6 +1958,7 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 						g_autoptr(GBytes) de_bytes = NULL;
 
 						g_debug ("Reading: %s", de_fname);
+						trace_start = asc_trace_begin (priv->trace);
 						de_bytes = asc_unit_read_data (ctask->unit,
 									       de_fname,
 									       &local_error);
@@ -1587,6 +1987,11 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 						    AS_FORMAT_VERSION_LATEST,
 						    priv->de_l10n_fn,
 						    priv->de_l10n_fn_udata);
+						asc_trace_end (priv->trace,
+							       trace_start,
+							       "desktop-entry",
+							       unit_name,
+							       as_component_get_id (cpt));
 						if (de_cpt != NULL) {
 							/* update component hash based on new source data */
 							asc_result_update_component_gcid (
@@ -1616,6 +2021,7 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 			g_autoptr(GError) local_error = NULL;
 
 			g_debug ("Reading orphan desktop-entry: %s", de_fname);
+			trace_start = asc_trace_begin (priv->trace);
 			de_bytes = asc_unit_read_data (ctask->unit, de_fname, &local_error);
 			if (de_bytes == NULL) {
 				asc_result_add_hint_by_cid (ctask->result,
@@ -1641,17 +2047,22 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 			    AS_FORMAT_VERSION_LATEST,
 			    priv->de_l10n_fn,
 			    priv->de_l10n_fn_udata);
+			asc_trace_end (priv->trace, trace_start, "desktop-entry", unit_name, de_basename);
 			if (de_cpt != NULL && !asc_result_is_ignored (ctask->result, de_cpt))
 				asc_result_add_hint_simple (ctask->result, de_cpt, "no-metainfo");
 		}
 	}
 
 	/* allow external function to alter the detected components early on before we do expensive processing */
-	if (priv->check_md_early_fn != NULL)
+	if (priv->check_md_early_fn != NULL) {
+		trace_start = asc_trace_begin (priv->trace);
 		priv->check_md_early_fn (ctask->result, ctask->unit, priv->check_md_early_fn_udata);
+		asc_trace_end (priv->trace, trace_start, "early-check", unit_name, NULL);
+	}
 
 	/* process translation status */
 	if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_PROCESS_TRANSLATIONS)) {
+		trace_start = asc_trace_begin (priv->trace);
 		if (priv->locale_unit == NULL) {
 			asc_read_translation_status (ctask->result,
 						     ctask->unit,
@@ -1663,6 +2074,7 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 						     priv->prefix,
 						     priv->min_l10n_percentage);
 		}
+		asc_trace_end (priv->trace, trace_start, "translations", unit_name, NULL);
 	}
 
 	/* process icons and screenshots */
@@ -1682,22 +2094,30 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 			else
 				icons_export_dir = g_strdup (priv->icons_result_dir);
 
+			trace_start = asc_trace_begin (priv->trace);
 			asc_compose_process_icons (compose,
 						   ctask->result,
 						   cpt,
 						   ctask->unit,
 						   icons_export_dir);
+			asc_trace_end (priv->trace,
+				       trace_start,
+				       "icons",
+				       unit_name,
+				       as_component_get_id (cpt));
 			/* skip the next steps if the component has been ignored */
 			if (asc_result_is_ignored (ctask->result, cpt))
 				continue;
 		}
 
 		/* screenshots, but only if we allow network access */
-		if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_ALLOW_NET) && acurl != NULL)
+		if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_ALLOW_NET) && acurl != NULL) {
+			trace_start = asc_trace_begin (priv->trace);
 			asc_process_screenshots (
 			    ctask->result,
 			    cpt,
 			    acurl,
+			    priv->media_registry,
 			    priv->media_result_dir,
 			    as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_NO_PARTIAL_URLS)
 				? priv->media_baseurl
@@ -1705,6 +2125,12 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 			    priv->max_scr_size_bytes,
 			    as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_ALLOW_SCREENCASTS),
 			    as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_STORE_SCREENSHOTS));
+			asc_trace_end (priv->trace,
+				       trace_start,
+				       "screenshots",
+				       unit_name,
+				       as_component_get_id (cpt));
+		}
 
 		if (as_component_get_kind (cpt) == AS_COMPONENT_KIND_FONT)
 			has_fonts = TRUE;
@@ -1712,12 +2138,14 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 
 	/* handle all font components present in this unit */
 	if (has_fonts && as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_PROCESS_FONTS)) {
+		trace_start = asc_trace_begin (priv->trace);
 		asc_process_fonts (ctask->result,
 				   ctask->unit,
 				   priv->media_result_dir,
 				   priv->icons_result_dir,
 				   priv->icon_policy,
 				   priv->flags);
+		asc_trace_end (priv->trace, trace_start, "fonts", unit_name, NULL);
 	}
 
 	/* clean up superfluous hints in case we were filtering the results, as some rejected
@@ -1731,14 +2159,173 @@ asc_compose_process_task_cb (AscComposeTask *ctask, AscCompose *compose)
 	}
 
 	/* postprocess components and add remaining values and hints */
-	if (!as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_NO_FINAL_CHECK))
+	if (!as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_NO_FINAL_CHECK)) {
+		trace_start = asc_trace_begin (priv->trace);
 		asc_compose_finalize_components (compose, ctask->result);
+		asc_trace_end (priv->trace, trace_start, "finalize", unit_name, NULL);
+	}
 
 	asc_unit_close (ctask->unit);
+	asc_trace_end (priv->trace, unit_trace_start, "unit", unit_name, NULL);
+}
+
+/**
+ * AscHintsExportTask:
+ *
+ * Hints report data for a single result.
+ */
+typedef struct {
+	AscResult *result; /* no ref */
+	const gchar *origin;
+	const gchar **hints_cids;
+	GString *html;
+} AscHintsExportTask;
+
+static void
+asc_hints_export_task_free (AscHintsExportTask *htask)
+{
+	g_free (htask->hints_cids);
+	g_string_free (htask->html, TRUE);
+	g_free (htask);
+}
+
+/**
+ * asc_compose_emit_hints_yaml:
+ *
+ * Emit the hints of a single result as one entry of the YAML hints sequence.
+ */
+static void
+asc_compose_emit_hints_yaml (yaml_emitter_t *emitter, AscHintsExportTask *htask)
+{
+	AscResult *result = htask->result;
+	const gchar **hints_cids = htask->hints_cids;
+
+	as_yaml_mapping_start (emitter);
+	as_yaml_emit_entry (emitter, "Unit", asc_result_get_bundle_id (result));
+	as_yaml_emit_scalar (emitter, "Hints");
+	as_yaml_sequence_start (emitter);
+	for (guint j = 0; hints_cids[j] != NULL; j++) {
+		GPtrArray *hints = asc_result_get_hints (result, hints_cids[j]);
+
+		as_yaml_mapping_start (emitter);
+		as_yaml_emit_scalar (emitter, hints_cids[j]);
+		as_yaml_sequence_start (emitter);
+		for (guint k = 0; k < hints->len; k++) {
+			GPtrArray *vars;
+			AscHint *hint = ASC_HINT (g_ptr_array_index (hints, k));
+			as_yaml_mapping_start (emitter);
+			as_yaml_emit_entry (emitter, "tag", asc_hint_get_tag (hint));
+
+			vars = asc_hint_get_explanation_vars_list (hint);
+			as_yaml_emit_scalar (emitter, "variables");
+			as_yaml_mapping_start (emitter);
+			for (guint l = 0; l < vars->len; l += 2) {
+				as_yaml_emit_entry (emitter,
+						    g_ptr_array_index (vars, l),
+						    g_ptr_array_index (vars, l + 1));
+			}
+			as_yaml_mapping_end (emitter);
+
+			/* end hint mapping */
+			as_yaml_mapping_end (emitter);
+		}
+		as_yaml_sequence_end (emitter);
+		as_yaml_mapping_end (emitter);
+	}
+	as_yaml_sequence_end (emitter);
+	as_yaml_mapping_end (emitter);
+}
+
+/**
+ * asc_compose_render_hints_html:
+ *
+ * Render the hints of a single result as HTML section.
+ */
+static void
+asc_compose_render_hints_html (AscHintsExportTask *htask, const gchar **hints_cids)
+{
+	g_autofree gchar *bundle_hstr = NULL;
+	GString *html = htask->html;
+	AscResult *result = htask->result;
+
+	g_string_append_printf (
+	    html,
+	    "<h1 style=\"font-weight: 100;\">Compose issue hints for \"%s\"</h1>\n",
+	    htask->origin);
+	g_string_append (html, "<div class=\"content\">");
+	bundle_hstr = g_markup_escape_text (asc_result_get_bundle_id (result), -1);
+	g_string_append_printf (html, "<h2>Unit: %s</h2>\n<hr/>\n", bundle_hstr);
+
+	for (guint j = 0; hints_cids[j] != NULL; j++) {
+		g_autofree gchar *cid_hstr = NULL;
+		GPtrArray *hints = asc_result_get_hints (result, hints_cids[j]);
+
+		cid_hstr = g_markup_escape_text (hints_cids[j], -1);
+		g_string_append_printf (html,
+					"<h3 id=\"%s\">%s <a title=\"Permalink\" "
+					"class=\"permalink\" href=\"#%s\">#</a></h3>\n",
+					cid_hstr,
+					cid_hstr,
+					cid_hstr);
+		g_string_append (html, "<ul>\n");
+		for (guint k = 0; k < hints->len; k++) {
+			g_autofree gchar *explanation = NULL;
+			const gchar *label_style;
+			AsIssueSeverity severity;
+			AscHint *hint = ASC_HINT (g_ptr_array_index (hints, k));
+
+			severity = asc_hint_get_severity (hint);
+			switch (severity) {
+			case AS_ISSUE_SEVERITY_ERROR:
+				label_style = "label-error";
+				break;
+			case AS_ISSUE_SEVERITY_WARNING:
+				label_style = "label-warning";
+				break;
+			case AS_ISSUE_SEVERITY_INFO:
+				label_style = "label-info";
+				break;
+			case AS_ISSUE_SEVERITY_PEDANTIC:
+				label_style = "label-neutral";
+				break;
+			default:
+				label_style = "label-neutral";
+			}
+
+			explanation = asc_hint_format_explanation (hint);
+			g_string_append_printf (
+			    html,
+			    "    <li>\n    <strong>%s</strong>&nbsp;<span class=\"label "
+			    "%s\">%s</span>\n",
+			    asc_hint_get_tag (hint),
+			    label_style,
+			    as_issue_severity_to_string (severity));
+			g_string_append_printf (html,
+						"    <p>%s</p>\n    </li>\n",
+						explanation);
+		}
+		g_string_append (html, "</ul>\n");
+	}
+}
+
+/**
+ * asc_compose_render_hints_cb:
+ *
+ * Collect the hints of a single result and render its HTML report section.
+ * This function may be called from any thread.
+ */
+static void
+asc_compose_render_hints_cb (AscHintsExportTask *htask, gpointer user_data)
+{
+	htask->hints_cids = asc_result_get_component_ids_with_hints (htask->result);
+	if (htask->hints_cids == NULL)
+		return;
+
+	asc_compose_render_hints_html (htask, htask->hints_cids);
 }
 
 static gboolean
-asc_compose_export_hints_data_yaml (AscCompose *compose, GError **error)
+asc_compose_export_hints_data_yaml (AscCompose *compose, GPtrArray *htasks, GError **error)
 {
 	AscComposePrivate *priv = GET_PRIVATE (compose);
 	yaml_emitter_t emitter;
@@ -1748,10 +2335,6 @@ asc_compose_export_hints_data_yaml (AscCompose *compose, GError **error)
 	g_autofree gchar *yaml_fname = NULL;
 	g_autoptr(GString) yaml_result = g_string_new ("");
 
-	/* don't export anything if export dir isn't set */
-	if (priv->hints_result_dir == NULL)
-		return TRUE;
-
 	yaml_emitter_initialize (&emitter);
 	yaml_emitter_set_indent (&emitter, 2);
 	yaml_emitter_set_unicode (&emitter, TRUE);
@@ -1805,48 +2388,11 @@ asc_compose_export_hints_data_yaml (AscCompose *compose, GError **error)
 	g_assert (res);
 
 	as_yaml_sequence_start (&emitter);
-	for (guint i = 0; i < priv->results->len; i++) {
-		g_autofree const gchar **hints_cids = NULL;
-		AscResult *result = ASC_RESULT (g_ptr_array_index (priv->results, i));
-
-		hints_cids = asc_result_get_component_ids_with_hints (result);
-		if (hints_cids == NULL)
+	for (guint i = 0; i < htasks->len; i++) {
+		AscHintsExportTask *htask = g_ptr_array_index (htasks, i);
+		if (htask->hints_cids == NULL)
 			continue;
-
-		as_yaml_mapping_start (&emitter);
-		as_yaml_emit_entry (&emitter, "Unit", asc_result_get_bundle_id (result));
-		as_yaml_emit_scalar (&emitter, "Hints");
-		as_yaml_sequence_start (&emitter);
-		for (guint j = 0; hints_cids[j] != NULL; j++) {
-			GPtrArray *hints = asc_result_get_hints (result, hints_cids[j]);
-
-			as_yaml_mapping_start (&emitter);
-			as_yaml_emit_scalar (&emitter, hints_cids[j]);
-			as_yaml_sequence_start (&emitter);
-			for (guint k = 0; k < hints->len; k++) {
-				GPtrArray *vars;
-				AscHint *hint = ASC_HINT (g_ptr_array_index (hints, k));
-				as_yaml_mapping_start (&emitter);
-				as_yaml_emit_entry (&emitter, "tag", asc_hint_get_tag (hint));
-
-				vars = asc_hint_get_explanation_vars_list (hint);
-				as_yaml_emit_scalar (&emitter, "variables");
-				as_yaml_mapping_start (&emitter);
-				for (guint l = 0; l < vars->len; l += 2) {
-					as_yaml_emit_entry (&emitter,
-							    g_ptr_array_index (vars, l),
-							    g_ptr_array_index (vars, l + 1));
-				}
-				as_yaml_mapping_end (&emitter);
-
-				/* end hint mapping */
-				as_yaml_mapping_end (&emitter);
-			}
-			as_yaml_sequence_end (&emitter);
-			as_yaml_mapping_end (&emitter);
-		}
-		as_yaml_sequence_end (&emitter);
-		as_yaml_mapping_end (&emitter);
+		asc_compose_emit_hints_yaml (&emitter, htask);
 	}
 	as_yaml_sequence_end (&emitter);
 
@@ -1869,7 +2415,7 @@ asc_compose_export_hints_data_yaml (AscCompose *compose, GError **error)
 }
 
 static gboolean
-asc_compose_export_hints_data_html (AscCompose *compose, GError **error)
+asc_compose_export_hints_data_html (AscCompose *compose, GPtrArray *htasks, GError **error)
 {
 	AscComposePrivate *priv = GET_PRIVATE (compose);
 	g_autoptr(GString) html = NULL;
@@ -1943,73 +2489,9 @@ asc_compose_export_hints_data_html (AscCompose *compose, GError **error)
 	g_string_append (html, "</head>\n");
 	g_string_append (html, "<body>\n");
 
-	for (guint i = 0; i < priv->results->len; i++) {
-		g_autofree const gchar **hints_cids = NULL;
-		g_autofree gchar *bundle_hstr = NULL;
-		AscResult *result = ASC_RESULT (g_ptr_array_index (priv->results, i));
-
-		hints_cids = asc_result_get_component_ids_with_hints (result);
-		if (hints_cids == NULL)
-			continue;
-
-		g_string_append_printf (
-		    html,
-		    "<h1 style=\"font-weight: 100;\">Compose issue hints for \"%s\"</h1>\n",
-		    priv->origin);
-		g_string_append (html, "<div class=\"content\">");
-		bundle_hstr = g_markup_escape_text (asc_result_get_bundle_id (result), -1);
-		g_string_append_printf (html, "<h2>Unit: %s</h2>\n<hr/>\n", bundle_hstr);
-
-		for (guint j = 0; hints_cids[j] != NULL; j++) {
-			g_autofree gchar *cid_hstr = NULL;
-			GPtrArray *hints = asc_result_get_hints (result, hints_cids[j]);
-
-			cid_hstr = g_markup_escape_text (hints_cids[j], -1);
-			g_string_append_printf (html,
-						"<h3 id=\"%s\">%s <a title=\"Permalink\" "
-						"class=\"permalink\" href=\"#%s\">#</a></h3>\n",
-						cid_hstr,
-						cid_hstr,
-						cid_hstr);
-			g_string_append (html, "<ul>\n");
-			for (guint k = 0; k < hints->len; k++) {
-				g_autofree gchar *explanation = NULL;
-				const gchar *label_style;
-				AsIssueSeverity severity;
-				AscHint *hint = ASC_HINT (g_ptr_array_index (hints, k));
-
-				severity = asc_hint_get_severity (hint);
-				switch (severity) {
-				case AS_ISSUE_SEVERITY_ERROR:
-					label_style = "label-error";
-					break;
-				case AS_ISSUE_SEVERITY_WARNING:
-					label_style = "label-warning";
-					break;
-				case AS_ISSUE_SEVERITY_INFO:
-					label_style = "label-info";
-					break;
-				case AS_ISSUE_SEVERITY_PEDANTIC:
-					label_style = "label-neutral";
-					break;
-				default:
-					label_style = "label-neutral";
-				}
-
-				explanation = asc_hint_format_explanation (hint);
-				g_string_append_printf (
-				    html,
-				    "    <li>\n    <strong>%s</strong>&nbsp;<span class=\"label "
-				    "%s\">%s</span>\n",
-				    asc_hint_get_tag (hint),
-				    label_style,
-				    as_issue_severity_to_string (severity));
-				g_string_append_printf (html,
-							"    <p>%s</p>\n    </li>\n",
-							explanation);
-			}
-			g_string_append (html, "</ul>\n");
-		}
+	for (guint i = 0; i < htasks->len; i++) {
+		AscHintsExportTask *htask = g_ptr_array_index (htasks, i);
+		g_string_append_len (html, htask->html->str, htask->html->len);
 	}
 
 	g_string_append (html, "</div>\n");
@@ -2021,17 +2503,78 @@ asc_compose_export_hints_data_html (AscCompose *compose, GError **error)
 	return g_file_set_contents (html_fname, html->str, html->len, error);
 }
 
+/**
+ * asc_compose_export_hints_data:
+ *
+ * Write YAML and HTML reports for all hints of this run.
+ * The HTML report sections of individual units are rendered in parallel
+ * if threading is enabled and are then written in unit order, while the
+ * YAML report is emitted as a single document in one pass.
+ */
 static gboolean
-asc_compose_save_metadata_result (AscCompose *compose, gboolean *results_not_empty, GError **error)
+asc_compose_export_hints_data (AscCompose *compose, GError **error)
 {
 	AscComposePrivate *priv = GET_PRIVATE (compose);
-	g_autoptr(AsMetadata) mdata = NULL;
-	g_autofree gchar *data_basename = NULL;
-	g_autofree gchar *data_fname = NULL;
+	g_autoptr(GPtrArray) htasks = NULL;
+
+	/* don't export anything if export dir isn't set */
+	if (priv->hints_result_dir == NULL)
+		return TRUE;
+
+	/* ensure the hint tag registry is initialized before any worker reads it */
+	g_strfreev (asc_globals_get_hint_tags ());
+
+	htasks = g_ptr_array_new_full (priv->results->len,
+				       (GDestroyNotify) asc_hints_export_task_free);
+	for (guint i = 0; i < priv->results->len; i++) {
+		AscHintsExportTask *htask = g_new0 (AscHintsExportTask, 1);
+		htask->result = ASC_RESULT (g_ptr_array_index (priv->results, i));
+		htask->origin = priv->origin;
+		htask->html = g_string_new ("");
+		g_ptr_array_add (htasks, htask);
+	}
+
+	if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_USE_THREADS)) {
+		GThreadPool *tpool = NULL;
+		tpool = g_thread_pool_new ((GFunc) asc_compose_render_hints_cb,
+					   NULL,
+					   -1,	  /* max threads */
+					   FALSE, /* exclusive */
+					   error);
+		if (tpool == NULL)
+			return FALSE;
+
+		for (guint i = 0; i < htasks->len; i++)
+			g_thread_pool_push (tpool, g_ptr_array_index (htasks, i), NULL);
+
+		/* shutdown thread pool, wait for all tasks to complete */
+		g_thread_pool_free (tpool, FALSE, TRUE);
+	} else {
+		for (guint i = 0; i < htasks->len; i++)
+			asc_compose_render_hints_cb (g_ptr_array_index (htasks, i), NULL);
+	}
+
+	if (!asc_compose_export_hints_data_yaml (compose, htasks, error))
+		return FALSE;
+	return asc_compose_export_hints_data_html (compose, htasks, error);
+}
+
+/**
+ * asc_compose_new_catalog_metadata:
+ *
+ * Create a new #AsMetadata instance with the settings we use for
+ * all catalog data written by this compose run.
+ */
+static AsMetadata *
+asc_compose_new_catalog_metadata (AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	AsMetadata *mdata;
 
 	mdata = as_metadata_new ();
 	as_metadata_set_format_style (mdata, AS_FORMAT_STYLE_CATALOG);
 	as_metadata_set_format_version (mdata, AS_FORMAT_VERSION_LATEST);
+	as_metadata_set_origin (mdata, priv->origin);
 
 	/* Set baseurl only if one is set and we actually store any screenshot media. If no screenshot media
 	 * is stored, upstream's URLs are used and having a media base URL makes no sense.
@@ -2041,6 +2584,97 @@ asc_compose_save_metadata_result (AscCompose *compose, gboolean *results_not_emp
 	    !as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_NO_PARTIAL_URLS))
 		as_metadata_set_media_baseurl (mdata, priv->media_baseurl);
 
+	return mdata;
+}
+
+/**
+ * asc_compose_catalog_header_new:
+ *
+ * Create the catalog data preceding all components, which is the
+ * root node for XML and the header document for DEP-11 YAML.
+ */
+static GString *
+asc_compose_catalog_header_new (AscCompose *compose, AsMetadata *mdata)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	const gchar *version_str = as_format_version_to_string (
+	    as_metadata_get_format_version (mdata));
+	GString *header = g_string_new ("");
+
+	if (priv->format == AS_FORMAT_KIND_YAML) {
+		yaml_emitter_t emitter;
+		yaml_event_t event;
+		gboolean res;
+
+		yaml_emitter_initialize (&emitter);
+		yaml_emitter_set_indent (&emitter, 2);
+		yaml_emitter_set_unicode (&emitter, TRUE);
+		yaml_emitter_set_width (&emitter, 120);
+		yaml_emitter_set_output (&emitter, as_compose_yaml_write_handler_cb, header);
+
+		yaml_stream_start_event_initialize (&event, YAML_UTF8_ENCODING);
+		res = yaml_emitter_emit (&emitter, &event);
+		g_assert (res);
+		yaml_document_start_event_initialize (&event, NULL, NULL, NULL, FALSE);
+		res = yaml_emitter_emit (&emitter, &event);
+		g_assert (res);
+
+		as_yaml_mapping_start (&emitter);
+		as_yaml_emit_entry (&emitter, "File", "DEP-11");
+		as_yaml_emit_entry (&emitter, "Version", version_str);
+		as_yaml_emit_entry (&emitter, "Origin", priv->origin);
+		as_yaml_emit_entry (&emitter, "MediaBaseUrl", as_metadata_get_media_baseurl (mdata));
+		as_yaml_mapping_end (&emitter);
+
+		yaml_document_end_event_initialize (&event, 1);
+		res = yaml_emitter_emit (&emitter, &event);
+		g_assert (res);
+		yaml_stream_end_event_initialize (&event);
+		res = yaml_emitter_emit (&emitter, &event);
+		g_assert (res);
+
+		yaml_emitter_flush (&emitter);
+		yaml_emitter_delete (&emitter);
+	} else {
+		/* the origin has already been escaped when it was set */
+		g_string_append_printf (header,
+					"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+					"<components version=\"%s\"",
+					version_str);
+		if (priv->origin != NULL)
+			g_string_append_printf (header, " origin=\"%s\"", priv->origin);
+		if (as_metadata_get_media_baseurl (mdata) != NULL) {
+			g_autofree gchar *tmp = g_markup_escape_text (
+			    as_metadata_get_media_baseurl (mdata),
+			    -1);
+			g_string_append_printf (header, " media_baseurl=\"%s\"", tmp);
+		}
+		g_string_append (header, ">\n");
+	}
+
+	return header;
+}
+
+/**
+ * asc_compose_open_catalog_writer:
+ *
+ * Open a new compressed catalog file for streaming metadata to.
+ * Data is written to a partial file first, which is only moved to its
+ * final location once all data was written successfully.
+ */
+static AscCatalogWriter *
+asc_compose_open_catalog_writer (AscCompose *compose, GPtrArray *tasks, GError **error)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	g_autoptr(AscCatalogWriter) cwriter = NULL;
+	g_autoptr(AsMetadata) mdata = NULL;
+	g_autoptr(GFileOutputStream) fos = NULL;
+	g_autoptr(GZlibCompressor) compressor = NULL;
+	g_autoptr(GString) header = NULL;
+	g_autofree gchar *data_basename = NULL;
+	g_autofree gchar *data_fname = NULL;
+	g_autofree gchar *part_fname = NULL;
+
 	if (priv->format == AS_FORMAT_KIND_YAML)
 		data_basename = g_strdup_printf ("%s.yml.gz", priv->origin);
 	else
@@ -2053,26 +2687,243 @@ asc_compose_save_metadata_result (AscCompose *compose, gboolean *results_not_emp
 			     "failed to create %s: %s",
 			     priv->data_result_dir,
 			     strerror (errno));
-		return FALSE;
+		return NULL;
 	}
 
+	data_fname = g_build_filename (priv->data_result_dir, data_basename, NULL);
+	part_fname = g_strconcat (data_fname, ".part", NULL);
+
+	cwriter = g_new0 (AscCatalogWriter, 1);
+	g_mutex_init (&cwriter->mutex);
+	cwriter->tasks = tasks;
+	cwriter->final_file = g_file_new_for_path (data_fname);
+	cwriter->part_file = g_file_new_for_path (part_fname);
+
+	fos = g_file_replace (cwriter->part_file,
+			      NULL,
+			      FALSE,
+			      G_FILE_CREATE_REPLACE_DESTINATION,
+			      NULL,
+			      error);
+	if (fos == NULL)
+		return NULL;
+	compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+	cwriter->out = g_converter_output_stream_new (G_OUTPUT_STREAM (fos),
+						      G_CONVERTER (compressor));
+
+	mdata = asc_compose_new_catalog_metadata (compose);
+	header = asc_compose_catalog_header_new (compose, mdata);
+	if (!g_output_stream_write_all (cwriter->out,
+					header->str,
+					header->len,
+					NULL,
+					NULL,
+					error))
+		return NULL;
+
+	return g_steal_pointer (&cwriter);
+}
+
+/**
+ * asc_compose_spill_task_result:
+ *
+ * Move the components of a finished task to disk, so we do not need to
+ * keep the data of all units in memory until the run is complete.
+ */
+static void
+asc_compose_spill_task_result (AscCompose *compose, AscComposeTask *ctask)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	g_autoptr(GError) tmp_error = NULL;
+	g_autofree gchar *spill_basename = NULL;
+	g_autofree gchar *spill_fname = NULL;
+	gint64 trace_start;
+
+	g_mutex_lock (&priv->mutex);
+	if (priv->spill_dir == NULL) {
+		priv->spill_dir = g_dir_make_tmp ("appstream-compose-spill-XXXXXX", &tmp_error);
+		if (priv->spill_dir == NULL) {
+			g_mutex_unlock (&priv->mutex);
+			g_warning ("Unable to create directory for temporary results: %s",
+				   tmp_error->message);
+			return;
+		}
+	}
+	spill_basename = g_strdup_printf ("%u.gvz", priv->spill_serial++);
+	spill_fname = g_build_filename (priv->spill_dir, spill_basename, NULL);
+	g_mutex_unlock (&priv->mutex);
+
+	trace_start = asc_trace_begin (priv->trace);
+	if (!asc_result_spill_components (ctask->result, spill_fname, &tmp_error))
+		g_warning ("Unable to move results of %s to disk, keeping them in memory: %s",
+			   asc_unit_get_bundle_id (ctask->unit),
+			   tmp_error->message);
+	asc_trace_end (priv->trace,
+		       trace_start,
+		       "spill",
+		       asc_unit_get_bundle_id (ctask->unit),
+		       NULL);
+}
+
+/**
+ * asc_compose_serialize_task_result:
+ *
+ * Serialize the components of a finished task as catalog data.
+ */
+static gchar *
+asc_compose_serialize_task_result (AscCompose *compose, AscComposeTask *ctask, GError **error)
+{
+	g_autoptr(GPtrArray) cpts = NULL;
+	g_autoptr(AsMetadata) mdata = NULL;
+
+	cpts = asc_result_fetch_components (ctask->result);
+	if (cpts->len == 0)
+		return NULL;
+
+	mdata = asc_compose_new_catalog_metadata (compose);
+	as_metadata_set_write_header (mdata, FALSE);
+	for (guint i = 0; i < cpts->len; i++)
+		as_metadata_add_component (mdata, AS_COMPONENT (g_ptr_array_index (cpts, i)));
+	return as_metadata_components_to_catalog (mdata, asc_compose_get_format (compose), error);
+}
+
+/**
+ * asc_compose_catalog_writer_add_task:
+ *
+ * Serialize the components of a finished task and write all data
+ * that is ready to be written in unit order.
+ */
+static void
+asc_compose_catalog_writer_add_task (AscCompose *compose, AscComposeTask *ctask)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	AscCatalogWriter *cwriter = ctask->cwriter;
+	g_autoptr(GError) tmp_error = NULL;
+	g_autoptr(GMutexLocker) locker = NULL;
+	gchar *cdata = NULL;
+
+	/* serialize the data of this unit outside of the lock */
+	cdata = asc_compose_serialize_task_result (compose, ctask, &tmp_error);
+
+	/* the result must not be touched by this thread anymore once the task is marked as finished */
+	if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_SPILL_RESULTS))
+		asc_compose_spill_task_result (compose, ctask);
+
+	locker = g_mutex_locker_new (&cwriter->mutex);
+	ctask->catalog_data = cdata;
+	ctask->finished = TRUE;
+	if (tmp_error != NULL && cwriter->error == NULL)
+		cwriter->error = g_steal_pointer (&tmp_error);
+
+	while (cwriter->next_idx < cwriter->tasks->len) {
+		AscComposeTask *wtask = g_ptr_array_index (cwriter->tasks, cwriter->next_idx);
+		if (!wtask->finished)
+			break;
+
+		/* all earlier units are done, so we know which duplicates this unit lost */
+		if (asc_compose_drop_displaced_components (compose, wtask)) {
+			g_clear_pointer (&wtask->catalog_data, g_free);
+			wtask->catalog_data = asc_compose_serialize_task_result (
+			    compose,
+			    wtask,
+			    cwriter->error == NULL ? &cwriter->error : NULL);
+			if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_SPILL_RESULTS))
+				asc_compose_spill_task_result (compose, wtask);
+		}
+
+		if (cwriter->error == NULL && !as_is_empty (wtask->catalog_data)) {
+			g_output_stream_write_all (cwriter->out,
+						   wtask->catalog_data,
+						   strlen (wtask->catalog_data),
+						   NULL,
+						   NULL,
+						   &cwriter->error);
+			cwriter->have_data = TRUE;
+		}
+		g_clear_pointer (&wtask->catalog_data, g_free);
+		cwriter->next_idx++;
+	}
+}
+
+/**
+ * asc_compose_close_catalog_writer:
+ *
+ * Finish writing the catalog and move it to its final location.
+ */
+static gboolean
+asc_compose_close_catalog_writer (AscCompose *compose,
+				  AscCatalogWriter *cwriter,
+				  gboolean *results_not_empty,
+				  GError **error)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	g_autoptr(GOutputStream) out = NULL;
+
 	if (results_not_empty != NULL)
-		*results_not_empty = FALSE;
+		*results_not_empty = cwriter->have_data;
 
-	for (guint i = 0; i < priv->results->len; i++) {
-		g_autoptr(GPtrArray) cpts = NULL;
-		AscResult *result = ASC_RESULT (g_ptr_array_index (priv->results, i));
-		cpts = asc_result_fetch_components (result);
-		for (guint j = 0; j < cpts->len; j++)
-			as_metadata_add_component (mdata,
-						   AS_COMPONENT (g_ptr_array_index (cpts, j)));
+	if (cwriter->error != NULL) {
+		g_propagate_error (error, g_steal_pointer (&cwriter->error));
+		return FALSE;
+	}
+	if (cwriter->next_idx != cwriter->tasks->len) {
+		g_set_error_literal (error,
+				     ASC_COMPOSE_ERROR,
+				     ASC_COMPOSE_ERROR_FAILED,
+				     "Not all units were written to the catalog.");
+		return FALSE;
+	}
 
-		if (cpts->len > 0 && results_not_empty != NULL)
-			*results_not_empty = TRUE;
+	if (priv->format == AS_FORMAT_KIND_XML) {
+		const gchar *footer = "</components>\n";
+		if (!g_output_stream_write_all (cwriter->out,
+						footer,
+						strlen (footer),
+						NULL,
+						NULL,
+						error))
+			return FALSE;
 	}
 
-	data_fname = g_build_filename (priv->data_result_dir, data_basename, NULL);
-	return as_metadata_save_catalog (mdata, data_fname, priv->format, error);
+	out = g_steal_pointer (&cwriter->out);
+	if (!g_output_stream_close (out, NULL, error)) {
+		g_file_delete (cwriter->part_file, NULL, NULL);
+		return FALSE;
+	}
+
+	return g_file_move (cwriter->part_file,
+			    cwriter->final_file,
+			    G_FILE_COPY_OVERWRITE,
+			    NULL,
+			    NULL,
+			    NULL,
+			    error);
+}
+
+/**
+ * asc_compose_run_task_cb:
+ *
+ * Process a single unit and hand its results over to the catalog writer.
+ */
+static void
+asc_compose_run_task_cb (AscComposeTask *ctask, AscCompose *compose)
+{
+	AscComposePrivate *priv = GET_PRIVATE (compose);
+	AscComposeWorker *worker = asc_compose_acquire_worker (compose);
+
+	asc_compose_process_task_cb (ctask, compose, worker);
+	asc_compose_release_worker (compose, worker);
+	if (ctask->cwriter != NULL) {
+		gint64 trace_start = asc_trace_begin (priv->trace);
+		asc_compose_catalog_writer_add_task (compose, ctask);
+		asc_trace_end (priv->trace,
+			       trace_start,
+			       "catalog-write",
+			       asc_unit_get_bundle_id (ctask->unit),
+			       NULL);
+	} else if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_SPILL_RESULTS)) {
+		asc_compose_spill_task_result (compose, ctask);
+	}
 }
 
 /**
@@ -2124,6 +2975,8 @@ asc_compose_run (AscCompose *compose, GCancellable *cancellable, GError **error)
 {
 	AscComposePrivate *priv = GET_PRIVATE (compose);
 	g_autoptr(GPtrArray) tasks = NULL;
+	g_autoptr(AscCatalogWriter) cwriter = NULL;
+	gint64 trace_start;
 	gboolean temp_dir_created = FALSE;
 	gboolean results_generated = FALSE;
 
@@ -2201,18 +3054,45 @@ asc_compose_run (AscCompose *compose, GCancellable *cancellable, GError **error)
 	/* sanity check to ensure resources can be loaded */
 	as_utils_ensure_resources ();
 
+	/* record a new trace for this run, if requested */
+	g_clear_pointer (&priv->trace, asc_trace_free);
+	if (priv->trace_fname != NULL)
+		priv->trace = asc_trace_new ();
+
 	tasks = g_ptr_array_new_with_free_func ((GDestroyNotify) asc_compose_task_free);
 
 	for (guint i = 0; i < priv->units->len; i++) {
 		AscComposeTask *ctask;
 		AscUnit *unit = g_ptr_array_index (priv->units, i);
-		ctask = asc_compose_task_new (unit);
+		ctask = asc_compose_task_new (unit, i);
 		g_ptr_array_add (tasks, ctask);
 	}
 
+	if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_FAST_GCID_HASH)) {
+		for (guint i = 0; i < tasks->len; i++) {
+			AscComposeTask *ctask = g_ptr_array_index (tasks, i);
+			if (!asc_result_set_gcid_hash_kind (ctask->result, ASC_GCID_HASH_KIND_XXH3)) {
+				g_warning ("Fast global component ID hashing was requested, but this "
+					   "build lacks xxHash support. Using MD5 instead.");
+				break;
+			}
+		}
+	}
+
+	/* open the catalog file, so results can be written as soon as each unit is done */
+	if (priv->data_result_dir != NULL) {
+		cwriter = asc_compose_open_catalog_writer (compose, tasks, error);
+		if (cwriter == NULL)
+			return NULL;
+		for (guint i = 0; i < tasks->len; i++) {
+			AscComposeTask *ctask = g_ptr_array_index (tasks, i);
+			ctask->cwriter = cwriter;
+		}
+	}
+
 	if (as_flags_contains (priv->flags, ASC_COMPOSE_FLAG_USE_THREADS)) {
 		GThreadPool *tpool = NULL;
-		tpool = g_thread_pool_new ((GFunc) asc_compose_process_task_cb,
+		tpool = g_thread_pool_new ((GFunc) asc_compose_run_task_cb,
 					   compose,
 					   -1,	  /* max threads */
 					   FALSE, /* exclusive */
@@ -2229,20 +3109,20 @@ asc_compose_run (AscCompose *compose, GCancellable *cancellable, GError **error)
 	} else {
 		/* run everything in sequence */
 		for (guint i = 0; i < tasks->len; i++)
-			asc_compose_process_task_cb (
-			    (AscComposeTask *) g_ptr_array_index (tasks, i),
-			    compose);
+			asc_compose_run_task_cb ((AscComposeTask *) g_ptr_array_index (tasks, i),
+						 compose);
 	}
 
-	/* collect results */
+	/* collect results, dropping duplicates that were only found after a unit was processed */
 	for (guint i = 0; i < tasks->len; i++) {
 		AscComposeTask *ctask = g_ptr_array_index (tasks, i);
+		asc_compose_drop_displaced_components (compose, ctask);
 		g_ptr_array_add (priv->results, g_object_ref (ctask->result));
 	}
 
-	/* write result */
-	if (priv->data_result_dir != NULL) {
-		if (!asc_compose_save_metadata_result (compose, &results_generated, error))
+	/* finish writing the catalog data */
+	if (cwriter != NULL) {
+		if (!asc_compose_close_catalog_writer (compose, cwriter, &results_generated, error))
 			return NULL;
 	}
 
@@ -2254,10 +3134,14 @@ asc_compose_run (AscCompose *compose, GCancellable *cancellable, GError **error)
 	}
 
 	/* write hints */
-	if (priv->hints_result_dir != NULL) {
-		if (!asc_compose_export_hints_data_yaml (compose, error))
-			return NULL;
-		if (!asc_compose_export_hints_data_html (compose, error))
+	trace_start = asc_trace_begin (priv->trace);
+	if (!asc_compose_export_hints_data (compose, error))
+		return NULL;
+	asc_trace_end (priv->trace, trace_start, "hints-export", NULL, NULL);
+
+	/* write trace */
+	if (priv->trace != NULL) {
+		if (!asc_trace_save_json (priv->trace, priv->trace_fname, error))
 			return NULL;
 	}
 
@@ -60,6 +60,8 @@ struct _AscComposeClass {
  * @ASC_COMPOSE_FLAG_PROPAGATE_ARTIFACTS:	Whether artifact data should be passed through to the generated output.
  * @ASC_COMPOSE_FLAG_NO_FINAL_CHECK:		Disable the automatic finalization check to perform it manually at a later time.
  * @ASC_COMPOSE_FLAG_NO_PARTIAL_URLS:		Do not use `media_baseurl` and always embed complete URLs in generated metadata.
+ * @ASC_COMPOSE_FLAG_FAST_GCID_HASH:		Use the fast XXH3 hash instead of MD5 for global component IDs, if available.
+ * @ASC_COMPOSE_FLAG_SPILL_RESULTS:		Move the components of finished units to disk, and only load them again when accessed.
  *
  * Flags that affect the compose process.
  **/
@@ -78,6 +80,8 @@ typedef enum {
 	ASC_COMPOSE_FLAG_PROPAGATE_ARTIFACTS	  = 1 << 10,
 	ASC_COMPOSE_FLAG_NO_FINAL_CHECK		  = 1 << 11,
 	ASC_COMPOSE_FLAG_NO_PARTIAL_URLS	  = 1 << 12,
+	ASC_COMPOSE_FLAG_FAST_GCID_HASH		  = 1 << 13,
+	ASC_COMPOSE_FLAG_SPILL_RESULTS		  = 1 << 14,
 } AscComposeFlags;
 
 /**
@@ -160,6 +164,11 @@ void		asc_compose_set_media_result_dir (AscCompose *compose, const gchar *dir);
 const gchar    *asc_compose_get_hints_result_dir (AscCompose *compose);
 void		asc_compose_set_hints_result_dir (AscCompose *compose, const gchar *dir);
 
+const gchar    *asc_compose_get_trace_filename (AscCompose *compose);
+void		asc_compose_set_trace_filename (AscCompose *compose, const gchar *fname);
+gchar	       *asc_compose_get_trace_summary (AscCompose *compose);
+gchar	       *asc_compose_get_statistics_summary (AscCompose *compose);
+
 void		asc_compose_remove_custom_allowed (AscCompose *compose, const gchar *key_id);
 void		asc_compose_add_custom_allowed (AscCompose *compose, const gchar *key_id);
 
@@ -28,7 +28,11 @@
 
 AS_BEGIN_PRIVATE_DECLS
 
-extern GMutex fontconfig_mutex;
+AS_INTERNAL_VISIBLE
+void asc_font_init_fontconfig (void);
+
+AS_INTERNAL_VISIBLE
+AscFont *asc_font_new_from_bytes (GBytes *bytes, const gchar *file_basename, GError **error);
 
 AS_INTERNAL_VISIBLE
 FT_Encoding asc_font_get_charset (AscFont *font);
@@ -27,8 +27,8 @@
 #include "config.h"
 #include "asc-font-private.h"
 
-#include <glib/gstdio.h>
 #include <fontconfig/fontconfig.h>
+#include <fontconfig/fcfreetype.h>
 #include FT_SFNT_NAMES_H
 #include FT_TRUETYPE_IDS_H
 #include <pango/pango-language.h>
@@ -37,11 +37,6 @@
 
 #include "asc-globals-private.h"
 
-/* Fontconfig is not threadsafe, so we use this mutex to guard any section
- * using it either directly or indirectly. This variable is exported to
- * other units as well. */
-GMutex fontconfig_mutex;
-
 struct _AscFont {
 	GObject parent_instance;
 };
@@ -49,6 +44,7 @@ struct _AscFont {
 typedef struct {
 	FT_Library library;
 	FT_Face fface;
+	GBytes *fdata;
 
 	GHashTable *languages;
 
@@ -89,12 +85,13 @@ asc_font_finalize (GObject *object)
 {
 	AscFont *font = ASC_FONT (object);
 	AscFontPrivate *priv = GET_PRIVATE (font);
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&fontconfig_mutex);
 
 	if (priv->fface != NULL)
 		FT_Done_Face (priv->fface);
 	if (priv->library != NULL)
 		FT_Done_FreeType (priv->library);
+	if (priv->fdata != NULL)
+		g_bytes_unref (priv->fdata);
 
 	g_hash_table_unref (priv->languages);
 
@@ -183,19 +180,26 @@ asc_font_read_sfnt_data (AscFont *font)
 	}
 }
 
-static void
-asc_font_load_fontconfig_data_from_file (AscFont *font, const gchar *fname)
+static gboolean
+asc_font_load_fontconfig_data (AscFont *font, GError **error)
 {
-	/* open FC font pattern
-	 * the count pointer has to be valid, otherwise FcFreeTypeQuery() crashes. */
-	int c;
 	FcPattern *fpattern;
 	gboolean any_lang_added = FALSE;
 	gboolean match = FALSE;
 	guchar *tmp_val;
 	AscFontPrivate *priv = GET_PRIVATE (font);
 
-	fpattern = FcFreeTypeQuery ((const guchar *) fname, 0, NULL, &c);
+	/* query Fontconfig using the already loaded face, so it never needs to touch the
+	 * font file itself - the filename is only used as a pattern property */
+	fpattern = FcFreeTypeQueryFace (priv->fface, (const FcChar8 *) priv->file_basename, 0, NULL);
+	if (fpattern == NULL) {
+		g_set_error (error,
+			     ASC_FONT_ERROR,
+			     ASC_FONT_ERROR_FAILED,
+			     "Unable to read Fontconfig data for font %s.",
+			     priv->file_basename);
+		return FALSE;
+	}
 
 	/* load information about the font */
 	g_hash_table_remove_all (priv->languages);
@@ -250,6 +254,28 @@ asc_font_load_fontconfig_data_from_file (AscFont *font, const gchar *fname)
 
 	/* cleanup */
 	FcPatternDestroy (fpattern);
+
+	return TRUE;
+}
+
+/**
+ * asc_font_init_fontconfig:
+ *
+ * Load the default Fontconfig configuration once and disable rescanning
+ * it, so the configuration stays immutable and can be shared by all
+ * threads without any additional locking.
+ */
+void
+asc_font_init_fontconfig (void)
+{
+	static gsize fc_initialized = 0;
+
+	if (g_once_init_enter (&fc_initialized)) {
+		if (!FcInit ())
+			g_warning ("Unable to initialize Fontconfig.");
+		FcConfigSetRescanInterval (NULL, 0);
+		g_once_init_leave (&fc_initialized, 1);
+	}
 }
 
 static AscFont *
@@ -257,10 +283,12 @@ asc_font_new (GError **error)
 {
 	AscFontPrivate *priv;
 	FT_Error err;
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&fontconfig_mutex);
 	g_autoptr(AscFont) font = ASC_FONT (g_object_new (ASC_TYPE_FONT, NULL));
 	priv = GET_PRIVATE (font);
+	asc_font_init_fontconfig ();
 
+	/* every font has its own FreeType library instance, so fonts can be loaded
+	 * in parallel without any locking */
 	err = FT_Init_FreeType (&priv->library);
 	if (err != 0) {
 		g_set_error (error,
@@ -284,9 +312,9 @@ asc_font_new (GError **error)
 AscFont *
 asc_font_new_from_file (const gchar *fname, GError **error)
 {
-	AscFont *font;
 	AscFontPrivate *priv;
 	FT_Error err;
+	g_autoptr(AscFont) font = NULL;
 
 	font = asc_font_new (error);
 	if (font == NULL)
@@ -303,11 +331,12 @@ asc_font_new_from_file (const gchar *fname, GError **error)
 		return NULL;
 	}
 
-	asc_font_load_fontconfig_data_from_file (font, fname);
 	g_free (priv->file_basename);
 	priv->file_basename = g_path_get_basename (fname);
+	if (!asc_font_load_fontconfig_data (font, error))
+		return NULL;
 
-	return font;
+	return g_steal_pointer (&font);
 }
 
 /**
@@ -324,27 +353,58 @@ asc_font_new_from_file (const gchar *fname, GError **error)
 AscFont *
 asc_font_new_from_data (const void *data, gssize len, const gchar *file_basename, GError **error)
 {
-	const gchar *tmp_root;
-	gboolean ret;
-	g_autofree gchar *fname = NULL;
-
-	/* we unfortunately need to create a stupid temporary file here, otherwise Fontconfig
-	 * does not work and we can not determine the right demo strings for this font.
-	 * (FreeType itself could load from memory) */
-	tmp_root = asc_globals_get_tmp_dir_create ();
-
-	fname = g_build_filename (tmp_root, file_basename, NULL);
-#if GLIB_CHECK_VERSION(2, 66, 0)
-	ret = g_file_set_contents_full (fname, data, len, G_FILE_SET_CONTENTS_NONE, 0666, error);
-#else
-	ret = g_file_set_contents (fname, data, len, error);
-	if (ret)
-		g_chmod (fname, 0666);
-#endif
-	if (!ret)
+	g_autoptr(GBytes) bytes = NULL;
+
+	g_return_val_if_fail (len >= 0, NULL);
+
+	/* FreeType requires the buffer to stay alive as long as the face exists */
+	bytes = g_bytes_new (data, len);
+	return asc_font_new_from_bytes (bytes, file_basename, error);
+}
+
+/**
+ * asc_font_new_from_bytes:
+ * @bytes: Font data to load.
+ * @file_basename: Font file basename.
+ * @error: A #GError or %NULL
+ *
+ * Creates a new #AscFont from a #GBytes buffer, without
+ * copying the data. A reference to @bytes is held
+ * for the lifetime of the font.
+ **/
+AscFont *
+asc_font_new_from_bytes (GBytes *bytes, const gchar *file_basename, GError **error)
+{
+	AscFontPrivate *priv;
+	FT_Error err;
+	const guint8 *data;
+	gsize len;
+	g_autoptr(AscFont) font = NULL;
+
+	font = asc_font_new (error);
+	if (font == NULL)
+		return NULL;
+	priv = GET_PRIVATE (font);
+
+	priv->fdata = g_bytes_ref (bytes);
+	data = g_bytes_get_data (priv->fdata, &len);
+
+	err = FT_New_Memory_Face (priv->library, data, (FT_Long) len, 0, &priv->fface);
+	if (err != 0) {
+		g_set_error (error,
+			     ASC_FONT_ERROR,
+			     ASC_FONT_ERROR_FAILED,
+			     "Unable to load font face from memory. Error code: %i",
+			     err);
+		return NULL;
+	}
+
+	g_free (priv->file_basename);
+	priv->file_basename = g_strdup (file_basename);
+	if (!asc_font_load_fontconfig_data (font, error))
 		return NULL;
 
-	return asc_font_new_from_file (fname, error);
+	return g_steal_pointer (&font);
 }
 
 /**
@@ -48,7 +48,9 @@ typedef struct {
 	GPtrArray *pangrams_en;
 
 	GMutex hint_tags_mutex;
-	GHashTable *hint_tags;
+	GHashTable *hint_tags;	   /* immutable snapshot, replaced atomically */
+	GPtrArray *hint_tag_store; /* owns all AscHintTag structs */
+	GPtrArray *hint_tags_retired;
 } AscGlobalsPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (AscGlobals, asc_globals, G_TYPE_OBJECT)
@@ -76,9 +78,12 @@ asc_globals_constructor (GType type,
 			 guint n_construct_properties,
 			 GObjectConstructParam *construct_properties)
 {
+	AscGlobals *globals;
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&g_globals_mutex);
-	if (g_globals != NULL)
-		return G_OBJECT (g_globals);
+
+	globals = g_atomic_pointer_get (&g_globals);
+	if (globals != NULL)
+		return G_OBJECT (globals);
 	else
 		return G_OBJECT_CLASS (asc_globals_parent_class)
 		    ->constructor (type, n_construct_properties, construct_properties);
@@ -101,6 +106,8 @@ asc_globals_finalize (GObject *object)
 	g_mutex_clear (&priv->hint_tags_mutex);
 	if (priv->hint_tags != NULL)
 		g_hash_table_unref (priv->hint_tags);
+	g_ptr_array_unref (priv->hint_tags_retired);
+	g_ptr_array_unref (priv->hint_tag_store);
 
 	G_OBJECT_CLASS (asc_globals_parent_class)->finalize (object);
 }
@@ -112,7 +119,6 @@ asc_globals_init (AscGlobals *globals)
 	g_autofree gchar *tmp_str1 = NULL;
 	g_autofree gchar *tmp_str2 = NULL;
 	g_assert (g_globals == NULL);
-	g_globals = globals;
 
 	tmp_str1 = as_random_alnum_string (6);
 	tmp_str2 = g_strconcat ("as-compose_", tmp_str1, NULL);
@@ -126,6 +132,12 @@ asc_globals_init (AscGlobals *globals)
 
 	g_mutex_init (&priv->hint_tags_mutex);
 	g_mutex_init (&priv->pangrams_mutex);
+	priv->hint_tag_store = g_ptr_array_new_with_free_func ((GDestroyNotify) asc_hint_tag_free);
+	priv->hint_tags_retired = g_ptr_array_new_with_free_func (
+	    (GDestroyNotify) g_hash_table_unref);
+
+	/* publish only once fully set up, lock-free readers may pick it up immediately */
+	g_atomic_pointer_set (&g_globals, globals);
 }
 
 static void
@@ -139,6 +151,9 @@ asc_globals_class_init (AscGlobalsClass *klass)
 static AscGlobalsPrivate *
 asc_globals_get_priv (void)
 {
+	AscGlobals *globals = g_atomic_pointer_get (&g_globals);
+	if (G_LIKELY (globals != NULL))
+		return GET_PRIVATE (globals);
 	return GET_PRIVATE (g_object_new (ASC_TYPE_GLOBALS, NULL));
 }
 
@@ -150,12 +165,15 @@ asc_globals_get_priv (void)
 void
 asc_globals_clear (void)
 {
+	AscGlobals *globals;
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&g_globals_mutex);
-	if (g_globals == NULL)
+
+	globals = g_atomic_pointer_get (&g_globals);
+	if (globals == NULL)
 		return;
 
-	g_object_unref (g_globals);
-	g_globals = NULL;
+	g_atomic_pointer_set (&g_globals, NULL);
+	g_object_unref (globals);
 }
 
 /**
@@ -324,6 +342,42 @@ asc_globals_get_pangrams_for (const gchar *lang)
 	return priv->pangrams_en;
 }
 
+/**
+ * asc_globals_new_hint_tag_table:
+ *
+ * Create a new, empty hint tag table. Values are owned by the
+ * hint tag store, so they can be shared between table snapshots.
+ */
+static GHashTable *
+asc_globals_new_hint_tag_table (void)
+{
+	return g_hash_table_new_full (g_str_hash,
+				      g_str_equal,
+				      (GDestroyNotify) as_ref_string_release,
+				      NULL);
+}
+
+/**
+ * asc_globals_hint_tag_table_insert:
+ *
+ * Register a new tag in the given table.
+ * IMPORTANT: This function may only be called while a lock is held
+ * on the hint tag table mutex.
+ */
+static gboolean
+asc_globals_hint_tag_table_insert (GHashTable *table,
+				   const gchar *tag,
+				   AsIssueSeverity severity,
+				   const gchar *explanation)
+{
+	AscGlobalsPrivate *priv = asc_globals_get_priv ();
+	AscHintTag *htag;
+
+	htag = asc_hint_tag_new (tag, severity, explanation);
+	g_ptr_array_add (priv->hint_tag_store, htag);
+	return g_hash_table_insert (table, g_ref_string_new_intern (tag), htag);
+}
+
 /**
  * asc_globals_create_hint_tag_table:
  *
@@ -331,26 +385,16 @@ asc_globals_get_pangrams_for (const gchar *lang)
  * IMPORTANT: This function may only be called while a lock is held
  * on the hint tag table mutex.
  */
-static void
+static GHashTable *
 asc_globals_create_hint_tag_table (void)
 {
-	AscGlobalsPrivate *priv = asc_globals_get_priv ();
-	g_return_if_fail (priv->hint_tags == NULL);
-
-	priv->hint_tags = g_hash_table_new_full (g_str_hash,
-						 g_str_equal,
-						 (GDestroyNotify) as_ref_string_release,
-						 (GDestroyNotify) asc_hint_tag_free);
+	GHashTable *table = asc_globals_new_hint_tag_table ();
 
 	/* add compose issue hint tags */
 	for (guint i = 0; asc_hint_tag_list[i].tag != NULL; i++) {
-		AscHintTag *htag;
 		gboolean r;
 		const AscHintTagStatic s = asc_hint_tag_list[i];
-		htag = asc_hint_tag_new (s.tag, s.severity, s.explanation);
-		r = g_hash_table_insert (priv->hint_tags,
-					 g_ref_string_new_intern (asc_hint_tag_list[i].tag),
-					 htag);
+		r = asc_globals_hint_tag_table_insert (table, s.tag, s.severity, s.explanation);
 		if (G_UNLIKELY (!r))
 			g_critical ("Duplicate compose-hint tag '%s' found in tag list. This is a "
 				    "bug in appstream-compose.",
@@ -359,7 +403,6 @@ asc_globals_create_hint_tag_table (void)
 
 	/* add validator issue hint tags */
 	for (guint i = 0; as_validator_issue_tag_list[i].tag != NULL; i++) {
-		AscHintTag *htag;
 		gboolean r;
 		AsIssueSeverity severity;
 		g_autofree gchar *compose_tag = g_strconcat ("asv-",
@@ -376,15 +419,41 @@ asc_globals_create_hint_tag_table (void)
 		if (severity == AS_ISSUE_SEVERITY_ERROR)
 			severity = AS_ISSUE_SEVERITY_WARNING;
 
-		htag = asc_hint_tag_new (compose_tag, severity, explanation);
-		r = g_hash_table_insert (priv->hint_tags,
-					 g_ref_string_new_intern (compose_tag),
-					 htag);
+		r = asc_globals_hint_tag_table_insert (table, compose_tag, severity, explanation);
 		if (G_UNLIKELY (!r))
 			g_critical ("Duplicate issue-tag '%s' found in tag list. This is a bug in "
 				    "appstream-compose.",
 				    as_validator_issue_tag_list[i].tag);
 	}
+
+	return table;
+}
+
+/**
+ * asc_globals_get_hint_tag_table:
+ *
+ * Get the current hint tag table snapshot, creating it if needed.
+ * The returned table must never be modified. Snapshots that were
+ * replaced by newer ones stay valid until the globals are cleared,
+ * so readers never need to take a lock.
+ */
+static GHashTable *
+asc_globals_get_hint_tag_table (void)
+{
+	AscGlobalsPrivate *priv = asc_globals_get_priv ();
+	GHashTable *table;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	table = g_atomic_pointer_get (&priv->hint_tags);
+	if (G_LIKELY (table != NULL))
+		return table;
+
+	locker = g_mutex_locker_new (&priv->hint_tags_mutex);
+	/* race protection, another thread may have been faster */
+	if (priv->hint_tags == NULL)
+		g_atomic_pointer_set (&priv->hint_tags, asc_globals_create_hint_tag_table ());
+
+	return priv->hint_tags;
 }
 
 /**
@@ -409,15 +478,20 @@ asc_globals_add_hint_tag (const gchar *tag,
 			  gboolean overrideExisting)
 {
 	AscGlobalsPrivate *priv = asc_globals_get_priv ();
-	AscHintTag *htag;
 	AscHintTag *e_htag;
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->hint_tags_mutex);
+	GHashTable *table;
+	GHashTable *new_table;
+	GHashTableIter iter;
+	gpointer key, value;
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_return_val_if_fail (tag != NULL, FALSE);
 
-	if (priv->hint_tags == NULL)
-		asc_globals_create_hint_tag_table ();
+	/* ensure the initial table exists */
+	asc_globals_get_hint_tag_table ();
 
-	e_htag = g_hash_table_lookup (priv->hint_tags, tag);
+	locker = g_mutex_locker_new (&priv->hint_tags_mutex);
+	table = priv->hint_tags;
+	e_htag = g_hash_table_lookup (table, tag);
 	if (e_htag != NULL) {
 		if (overrideExisting) {
 			/* make sure we don't permit lowering severities */
@@ -429,8 +503,16 @@ asc_globals_add_hint_tag (const gchar *tag,
 		}
 	}
 
-	htag = asc_hint_tag_new (tag, severity, explanation);
-	g_hash_table_insert (priv->hint_tags, g_ref_string_new_intern (tag), htag);
+	/* copy the current snapshot, as readers may still be using it */
+	new_table = asc_globals_new_hint_tag_table ();
+	g_hash_table_iter_init (&iter, table);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_hash_table_insert (new_table, g_ref_string_acquire (key), value);
+	asc_globals_hint_tag_table_insert (new_table, tag, severity, explanation);
+
+	g_ptr_array_add (priv->hint_tags_retired, table);
+	g_atomic_pointer_set (&priv->hint_tags, new_table);
+
 	return TRUE;
 }
 
@@ -438,19 +520,15 @@ asc_globals_add_hint_tag (const gchar *tag,
  * asc_globals_get_hint_info:
  *
  * Return details for a given hint tag.
+ * This function does not lock and is safe to call from any thread.
  *
  * Returns: (transfer none): Hint tag details.
  */
 AscHintTag *
 asc_globals_get_hint_tag_details (const gchar *tag)
 {
-	AscGlobalsPrivate *priv = asc_globals_get_priv ();
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->hint_tags_mutex);
 	g_return_val_if_fail (tag != NULL, NULL);
-
-	if (priv->hint_tags == NULL)
-		asc_globals_create_hint_tag_table ();
-	return g_hash_table_lookup (priv->hint_tags, tag);
+	return g_hash_table_lookup (asc_globals_get_hint_tag_table (), tag);
 }
 
 /**
@@ -463,19 +541,15 @@ asc_globals_get_hint_tag_details (const gchar *tag)
 gchar **
 asc_globals_get_hint_tags ()
 {
-	AscGlobalsPrivate *priv = asc_globals_get_priv ();
+	GHashTable *table = asc_globals_get_hint_tag_table ();
 	GHashTableIter iter;
 	gpointer key;
 	gchar **strv;
 	guint i = 0;
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->hint_tags_mutex);
-
-	if (priv->hint_tags == NULL)
-		asc_globals_create_hint_tag_table ();
 
 	/* deep-copy the table keys to a strv */
-	strv = g_new0 (gchar *, g_hash_table_size (priv->hint_tags) + 1);
-	g_hash_table_iter_init (&iter, priv->hint_tags);
+	strv = g_new0 (gchar *, g_hash_table_size (table) + 1);
+	g_hash_table_iter_init (&iter, table);
 	while (g_hash_table_iter_next (&iter, &key, NULL))
 		strv[i++] = g_strdup ((const gchar *) key);
 
@@ -0,0 +1,314 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:asc-media-registry
+ * @short_description: Registry of generated media files, to avoid processing identical data twice.
+ *
+ * Many units ship byte-identical icons and screenshots. This registry maps a hash
+ * of the input data plus a description of the generated variant (e.g. the icon size)
+ * to the first output file generated for it, so other outputs can be hardlinked
+ * to that file instead of being rendered and optimized again.
+ */
+
+#include "config.h"
+#include "asc-media-registry.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "as-utils-private.h"
+
+typedef struct {
+	gchar *fname;
+	guint width;
+	guint height;
+	gint64 usec;
+} AscMediaEntry;
+
+struct _AscMediaRegistry {
+	GMutex mutex;
+	GHashTable *entries;
+	AscMediaRegistryStats stats;
+};
+
+static void
+asc_media_entry_free (AscMediaEntry *entry)
+{
+	g_free (entry->fname);
+	g_free (entry);
+}
+
+/**
+ * asc_media_registry_new:
+ *
+ * Create a new, empty media registry.
+ *
+ * Returns: (transfer full): a new #AscMediaRegistry
+ **/
+AscMediaRegistry *
+asc_media_registry_new (void)
+{
+	AscMediaRegistry *mreg = g_new0 (AscMediaRegistry, 1);
+
+	g_mutex_init (&mreg->mutex);
+	mreg->entries = g_hash_table_new_full (g_str_hash,
+					       g_str_equal,
+					       g_free,
+					       (GDestroyNotify) asc_media_entry_free);
+	return mreg;
+}
+
+/**
+ * asc_media_registry_free:
+ * @mreg: an #AscMediaRegistry
+ *
+ * Free the registry.
+ **/
+void
+asc_media_registry_free (AscMediaRegistry *mreg)
+{
+	if (mreg == NULL)
+		return;
+	g_hash_table_unref (mreg->entries);
+	g_mutex_clear (&mreg->mutex);
+	g_free (mreg);
+}
+
+/**
+ * asc_media_registry_clear:
+ * @mreg: an #AscMediaRegistry
+ *
+ * Forget all registered files and reset the statistics.
+ **/
+void
+asc_media_registry_clear (AscMediaRegistry *mreg)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&mreg->mutex);
+
+	g_hash_table_remove_all (mreg->entries);
+	memset (&mreg->stats, 0, sizeof (mreg->stats));
+}
+
+/**
+ * asc_media_registry_make_key:
+ * @data: The input data.
+ * @variant: Description of the output generated from @data, e.g. its size.
+ *
+ * Create a registry key for an output generated from @data.
+ *
+ * Returns: (transfer full): a new key.
+ **/
+gchar *
+asc_media_registry_make_key (GBytes *data, const gchar *variant)
+{
+	g_autofree gchar *hash = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, data);
+	return g_strconcat (hash, ":", variant, NULL);
+}
+
+/**
+ * asc_media_registry_lookup:
+ * @mreg: an #AscMediaRegistry
+ * @key: The registry key for the output.
+ * @width: (out) (optional): The width registered with the output.
+ * @height: (out) (optional): The height registered with the output.
+ *
+ * Check whether an output was already generated for @key.
+ *
+ * Returns: %TRUE if an output is registered for @key.
+ **/
+gboolean
+asc_media_registry_lookup (AscMediaRegistry *mreg, const gchar *key, guint *width, guint *height)
+{
+	AscMediaEntry *entry;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&mreg->mutex);
+
+	entry = g_hash_table_lookup (mreg->entries, key);
+	if (entry == NULL)
+		return FALSE;
+	if (width != NULL)
+		*width = entry->width;
+	if (height != NULL)
+		*height = entry->height;
+	return TRUE;
+}
+
+/**
+ * asc_media_registry_reuse:
+ * @mreg: an #AscMediaRegistry
+ * @key: The registry key for the output.
+ * @dest_fname: Where the output should be stored.
+ * @width: (out) (optional): The width registered with the output.
+ * @height: (out) (optional): The height registered with the output.
+ *
+ * Try to create @dest_fname from an already generated output for @key,
+ * creating its parent directories as needed.
+ *
+ * If no output is known, any existing file at @dest_fname is removed, so the caller
+ * writes a new file instead of modifying one that may be hardlinked elsewhere.
+ *
+ * Returns: %TRUE if @dest_fname was created from a known output.
+ **/
+gboolean
+asc_media_registry_reuse (AscMediaRegistry *mreg,
+			  const gchar *key,
+			  const gchar *dest_fname,
+			  guint *width,
+			  guint *height)
+{
+	AscMediaEntry *entry;
+	g_autofree gchar *src_fname = NULL;
+	g_autofree gchar *dest_dir = NULL;
+	guint src_width = 0;
+	guint src_height = 0;
+	gint64 src_usec = 0;
+	GStatBuf sbuf;
+
+	g_mutex_lock (&mreg->mutex);
+	entry = g_hash_table_lookup (mreg->entries, key);
+	if (entry != NULL) {
+		src_fname = g_strdup (entry->fname);
+		src_width = entry->width;
+		src_height = entry->height;
+		src_usec = entry->usec;
+	}
+	g_mutex_unlock (&mreg->mutex);
+
+	if (src_fname == NULL || g_strcmp0 (src_fname, dest_fname) == 0) {
+		g_remove (dest_fname);
+		return FALSE;
+	}
+
+	dest_dir = g_path_get_dirname (dest_fname);
+	g_mkdir_with_parents (dest_dir, 0755);
+	if (!asc_link_or_copy_file (src_fname, dest_fname, NULL)) {
+		g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&mreg->mutex);
+
+		/* the original file is gone, so the entry is of no use anymore */
+		entry = g_hash_table_lookup (mreg->entries, key);
+		if (entry != NULL && g_strcmp0 (entry->fname, src_fname) == 0)
+			g_hash_table_remove (mreg->entries, key);
+		g_remove (dest_fname);
+		return FALSE;
+	}
+
+	g_mutex_lock (&mreg->mutex);
+	mreg->stats.n_reused++;
+	mreg->stats.usec_saved += src_usec;
+	if (g_stat (dest_fname, &sbuf) == 0)
+		mreg->stats.bytes_saved += sbuf.st_size;
+	g_mutex_unlock (&mreg->mutex);
+
+	if (width != NULL)
+		*width = src_width;
+	if (height != NULL)
+		*height = src_height;
+	return TRUE;
+}
+
+/**
+ * asc_media_registry_add:
+ * @mreg: an #AscMediaRegistry
+ * @key: The registry key for the output.
+ * @fname: The generated output file.
+ * @width: Width to register with the output.
+ * @height: Height to register with the output.
+ * @usec: Time it took to generate the output, in microseconds.
+ *
+ * Register a newly generated output file. If an output was already registered
+ * for @key, the existing one is kept.
+ **/
+void
+asc_media_registry_add (AscMediaRegistry *mreg,
+			const gchar *key,
+			const gchar *fname,
+			guint width,
+			guint height,
+			gint64 usec)
+{
+	AscMediaEntry *entry;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&mreg->mutex);
+
+	if (g_hash_table_contains (mreg->entries, key))
+		return;
+
+	entry = g_new0 (AscMediaEntry, 1);
+	entry->fname = g_strdup (fname);
+	entry->width = width;
+	entry->height = height;
+	entry->usec = usec;
+	g_hash_table_insert (mreg->entries, g_strdup (key), entry);
+}
+
+/**
+ * asc_media_registry_get_stats:
+ * @mreg: an #AscMediaRegistry
+ * @stats: (out caller-allocates): Location to store the statistics.
+ *
+ * Get statistics on how much work the registry has saved.
+ **/
+void
+asc_media_registry_get_stats (AscMediaRegistry *mreg, AscMediaRegistryStats *stats)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&mreg->mutex);
+	*stats = mreg->stats;
+}
+
+/**
+ * asc_link_or_copy_file:
+ * @src_fname: The file to link to.
+ * @dest_fname: The new file.
+ * @error: A #GError or %NULL
+ *
+ * Create @dest_fname as a hardlink to @src_fname, or as a copy of it if
+ * the files are on different filesystems. An existing @dest_fname is replaced.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+asc_link_or_copy_file (const gchar *src_fname, const gchar *dest_fname, GError **error)
+{
+	/* never write into an existing file, it may itself be a hardlink */
+	if (g_remove (dest_fname) != 0 && errno != ENOENT) {
+		g_set_error (error,
+			     G_FILE_ERROR,
+			     g_file_error_from_errno (errno),
+			     "Could not remove %s: %s",
+			     dest_fname,
+			     g_strerror (errno));
+		return FALSE;
+	}
+
+	if (link (src_fname, dest_fname) == 0)
+		return TRUE;
+	if (errno == ENOENT) {
+		g_set_error (error,
+			     G_FILE_ERROR,
+			     G_FILE_ERROR_NOENT,
+			     "Could not link %s: %s",
+			     src_fname,
+			     g_strerror (errno));
+		return FALSE;
+	}
+
+	return as_copy_file (src_fname, dest_fname, error);
+}
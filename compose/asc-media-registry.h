@@ -0,0 +1,81 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include "as-macros-private.h"
+
+AS_BEGIN_PRIVATE_DECLS
+
+/**
+ * AscMediaRegistryStats:
+ * @n_reused:	Number of output files that were linked or copied from an earlier result.
+ * @bytes_saved: Size of the output files that did not need to be generated again.
+ * @usec_saved:	Processing time that was avoided, in microseconds.
+ *
+ * Statistics of an #AscMediaRegistry.
+ **/
+typedef struct {
+	guint n_reused;
+	guint64 bytes_saved;
+	gint64 usec_saved;
+} AscMediaRegistryStats;
+
+typedef struct _AscMediaRegistry AscMediaRegistry;
+
+AS_INTERNAL_VISIBLE
+AscMediaRegistry *asc_media_registry_new (void);
+AS_INTERNAL_VISIBLE
+void		  asc_media_registry_free (AscMediaRegistry *mreg);
+AS_INTERNAL_VISIBLE
+void		  asc_media_registry_clear (AscMediaRegistry *mreg);
+
+AS_INTERNAL_VISIBLE
+gchar		 *asc_media_registry_make_key (GBytes *data, const gchar *variant);
+
+AS_INTERNAL_VISIBLE
+gboolean	  asc_media_registry_lookup (AscMediaRegistry *mreg,
+					     const gchar      *key,
+					     guint	      *width,
+					     guint	      *height);
+AS_INTERNAL_VISIBLE
+gboolean	  asc_media_registry_reuse (AscMediaRegistry *mreg,
+					    const gchar	     *key,
+					    const gchar	     *dest_fname,
+					    guint	     *width,
+					    guint	     *height);
+AS_INTERNAL_VISIBLE
+void		  asc_media_registry_add (AscMediaRegistry *mreg,
+					  const gchar	   *key,
+					  const gchar	   *fname,
+					  guint		    width,
+					  guint		    height,
+					  gint64	    usec);
+
+AS_INTERNAL_VISIBLE
+void		  asc_media_registry_get_stats (AscMediaRegistry *mreg, AscMediaRegistryStats *stats);
+
+AS_INTERNAL_VISIBLE
+gboolean	  asc_link_or_copy_file (const gchar *src_fname, const gchar *dest_fname, GError **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscMediaRegistry, asc_media_registry_free)
+
+AS_END_PRIVATE_DECLS
@@ -0,0 +1,35 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "asc-result.h"
+#include "as-macros-private.h"
+
+AS_BEGIN_PRIVATE_DECLS
+
+AS_INTERNAL_VISIBLE
+gboolean asc_result_spill_components (AscResult *result, const gchar *fname, GError **error);
+AS_INTERNAL_VISIBLE
+gboolean asc_result_components_spilled (AscResult *result);
+AS_INTERNAL_VISIBLE
+const gchar *asc_result_get_spill_filename (AscResult *result);
+
+AS_END_PRIVATE_DECLS
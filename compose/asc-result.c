@@ -26,8 +26,17 @@
 
 #include "config.h"
 #include "asc-result.h"
+#include "asc-result-private.h"
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#ifdef HAVE_XXHASH
+#include <xxhash.h>
+#endif
 
 #include "as-utils-private.h"
+#include "as-metadata-private.h"
 #include "asc-globals-private.h"
 #include "asc-utils.h"
 #include "asc-hint.h"
@@ -35,11 +44,17 @@
 typedef struct {
 	AsBundleKind bundle_kind;
 	gchar *bundle_id;
+	AscGcidHashKind gcid_hash_kind;
 
 	GHashTable *cpts;	  /* GRefString->AsComponent */
 	GHashTable *mdata_hashes; /* AsComponent->utf8 */
 	GHashTable *hints;	  /* GRefString->GPtrArray */
 	GHashTable *gcids;	  /* GRefString->utf8 (component-id -> global component-id) */
+
+	gchar *spill_fname;
+	gboolean cpts_spilled;
+	guint n_spilled_cpts;
+	GHashTable *spilled_contexts; /* GRefString->AsContext */
 } AscResultPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (AscResult, asc_result, G_TYPE_OBJECT)
@@ -51,6 +66,7 @@ asc_result_init (AscResult *result)
 	AscResultPrivate *priv = GET_PRIVATE (result);
 
 	priv->bundle_kind = AS_BUNDLE_KIND_UNKNOWN;
+	priv->gcid_hash_kind = ASC_GCID_HASH_KIND_MD5;
 
 	priv->cpts = g_hash_table_new_full (g_str_hash,
 					    g_str_equal,
@@ -65,6 +81,10 @@ asc_result_init (AscResult *result)
 					     g_str_equal,
 					     (GDestroyNotify) as_ref_string_release,
 					     g_free);
+	priv->spilled_contexts = g_hash_table_new_full (g_str_hash,
+							g_str_equal,
+							(GDestroyNotify) as_ref_string_release,
+							g_object_unref);
 }
 
 static void
@@ -74,11 +94,16 @@ asc_result_finalize (GObject *object)
 	AscResultPrivate *priv = GET_PRIVATE (result);
 
 	g_free (priv->bundle_id);
+	if (priv->spill_fname != NULL) {
+		g_remove (priv->spill_fname);
+		g_free (priv->spill_fname);
+	}
 
 	g_hash_table_unref (priv->cpts);
 	g_hash_table_unref (priv->mdata_hashes);
 	g_hash_table_unref (priv->hints);
 	g_hash_table_unref (priv->gcids);
+	g_hash_table_unref (priv->spilled_contexts);
 
 	G_OBJECT_CLASS (asc_result_parent_class)->finalize (object);
 }
@@ -90,6 +115,222 @@ asc_result_class_init (AscResultClass *klass)
 	object_class->finalize = asc_result_finalize;
 }
 
+/**
+ * asc_result_load_spilled_components:
+ *
+ * Read components that were moved to disk with asc_result_spill_components() back in.
+ */
+static gboolean
+asc_result_load_spilled_components (AscResult *result, GError **error)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileInputStream) fis = NULL;
+	g_autoptr(GZlibDecompressor) decompressor = NULL;
+	g_autoptr(GInputStream) in = NULL;
+	g_autoptr(GOutputStream) mos = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GVariant) variant = NULL;
+	g_autoptr(GVariant) hashes = NULL;
+	g_autoptr(AsMetadata) mdata = NULL;
+	const gchar *xml_data;
+	GPtrArray *cpts;
+
+	file = g_file_new_for_path (priv->spill_fname);
+	fis = g_file_read (file, NULL, error);
+	if (fis == NULL)
+		return FALSE;
+	decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW);
+	in = g_converter_input_stream_new (G_INPUT_STREAM (fis), G_CONVERTER (decompressor));
+	mos = g_memory_output_stream_new_resizable ();
+	if (g_output_stream_splice (mos,
+				    in,
+				    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+					G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				    NULL,
+				    error) < 0)
+		return FALSE;
+	bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mos));
+
+	variant = g_variant_new_from_bytes (G_VARIANT_TYPE ("(sa{ss})"), bytes, FALSE);
+	g_variant_get (variant, "(&s@a{ss})", &xml_data, &hashes);
+
+	mdata = as_metadata_new ();
+	as_metadata_set_locale (mdata, "ALL");
+	as_metadata_set_format_style (mdata, AS_FORMAT_STYLE_CATALOG);
+	as_metadata_set_internal_mode (mdata, TRUE);
+	if (!as_metadata_parse_data (mdata, xml_data, -1, AS_FORMAT_KIND_XML, error))
+		return FALSE;
+
+	cpts = as_metadata_get_components (mdata);
+	for (guint i = 0; i < cpts->len; i++) {
+		AsComponent *cpt = AS_COMPONENT (g_ptr_array_index (cpts, i));
+		const gchar *cid = as_component_get_id (cpt);
+		const gchar *hash = NULL;
+		AsContext *context;
+
+		/* restore the context the component was created with, setting it
+		 * resets the origin, which we read back explicitly */
+		context = g_hash_table_lookup (priv->spilled_contexts, cid);
+		if (context != NULL) {
+			g_autofree gchar *origin = g_strdup (as_component_get_origin (cpt));
+			as_component_set_context (cpt, context);
+			if (origin != NULL)
+				as_component_set_origin (cpt, origin);
+		}
+
+		g_hash_table_insert (priv->cpts, g_ref_string_new_intern (cid), g_object_ref (cpt));
+		if (g_variant_lookup (hashes, cid, "&s", &hash))
+			g_hash_table_insert (priv->mdata_hashes, cpt, g_strdup (hash));
+	}
+	g_hash_table_remove_all (priv->spilled_contexts);
+
+	return TRUE;
+}
+
+/**
+ * asc_result_ensure_components:
+ *
+ * Make sure all components of this result are in memory.
+ */
+static void
+asc_result_ensure_components (AscResult *result)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+	g_autoptr(GError) error = NULL;
+
+	if (!priv->cpts_spilled)
+		return;
+	priv->cpts_spilled = FALSE;
+
+	if (!asc_result_load_spilled_components (result, &error))
+		g_critical ("Unable to load components of %s back from disk: %s",
+			    priv->bundle_id,
+			    error->message);
+	g_remove (priv->spill_fname);
+}
+
+/**
+ * asc_result_spill_components:
+ * @result: an #AscResult instance.
+ * @fname: File to store the components in.
+ * @error: A #GError or %NULL
+ *
+ * Move the components of this result to a compressed file on disk, to free memory
+ * once they are no longer needed for processing. They are read back in
+ * automatically as soon as they are accessed again.
+ * Hints and global component IDs always remain in memory.
+ *
+ * Components are stored as catalog XML including internal data like their
+ * origin, scope and branch, and their #AsContext is kept in memory. Anything
+ * else that catalog data can not represent is lost when they are read back.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+asc_result_spill_components (AscResult *result, const gchar *fname, GError **error)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+	g_autoptr(AsMetadata) mdata = NULL;
+	g_autofree gchar *xml_data = NULL;
+	g_autoptr(GVariant) variant = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileOutputStream) fos = NULL;
+	g_autoptr(GZlibCompressor) compressor = NULL;
+	g_autoptr(GOutputStream) out = NULL;
+	GVariantBuilder hashes_builder;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	if (priv->cpts_spilled || g_hash_table_size (priv->cpts) == 0)
+		return TRUE;
+
+	mdata = as_metadata_new ();
+	as_metadata_set_locale (mdata, "ALL");
+	as_metadata_set_format_style (mdata, AS_FORMAT_STYLE_CATALOG);
+	as_metadata_set_format_version (mdata, AS_FORMAT_VERSION_LATEST);
+	as_metadata_set_internal_mode (mdata, TRUE);
+	g_hash_table_iter_init (&iter, priv->cpts);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		as_metadata_add_component (mdata, AS_COMPONENT (value));
+	xml_data = as_metadata_components_to_catalog (mdata, AS_FORMAT_KIND_XML, error);
+	if (xml_data == NULL)
+		return FALSE;
+
+	g_variant_builder_init (&hashes_builder, G_VARIANT_TYPE ("a{ss}"));
+	g_hash_table_iter_init (&iter, priv->mdata_hashes);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_variant_builder_add (&hashes_builder,
+				       "{ss}",
+				       as_component_get_id (AS_COMPONENT (key)),
+				       (const gchar *) value);
+	variant = g_variant_ref_sink (g_variant_new ("(sa{ss})", xml_data, &hashes_builder));
+
+	/* the data compresses well, and we want to keep the disk footprint low as well */
+	file = g_file_new_for_path (fname);
+	fos = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, NULL, error);
+	if (fos == NULL)
+		return FALSE;
+	compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, 1);
+	out = g_converter_output_stream_new (G_OUTPUT_STREAM (fos), G_CONVERTER (compressor));
+	if (!g_output_stream_write_all (out,
+					g_variant_get_data (variant),
+					g_variant_get_size (variant),
+					NULL,
+					NULL,
+					error))
+		return FALSE;
+	if (!g_output_stream_close (out, NULL, error))
+		return FALSE;
+
+	g_hash_table_iter_init (&iter, priv->cpts);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		AsContext *context = as_component_get_context (AS_COMPONENT (value));
+		if (context != NULL)
+			g_hash_table_insert (priv->spilled_contexts,
+					     g_ref_string_acquire (key),
+					     g_object_ref (context));
+	}
+
+	g_free (priv->spill_fname);
+	priv->spill_fname = g_strdup (fname);
+	priv->n_spilled_cpts = g_hash_table_size (priv->cpts);
+	priv->cpts_spilled = TRUE;
+	g_hash_table_remove_all (priv->mdata_hashes);
+	g_hash_table_remove_all (priv->cpts);
+
+	return TRUE;
+}
+
+/**
+ * asc_result_components_spilled:
+ * @result: an #AscResult instance.
+ *
+ * Returns: %TRUE if the components of this result are currently stored on disk.
+ **/
+gboolean
+asc_result_components_spilled (AscResult *result)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+	return priv->cpts_spilled;
+}
+
+/**
+ * asc_result_get_spill_filename:
+ * @result: an #AscResult instance.
+ *
+ * Returns: The file the components of this result are stored in,
+ *	    or %NULL if they are in memory.
+ **/
+const gchar *
+asc_result_get_spill_filename (AscResult *result)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+	if (!priv->cpts_spilled)
+		return NULL;
+	return priv->spill_fname;
+}
+
 /**
  * asc_result_unit_ignored:
  * @result: an #AscResult instance.
@@ -100,7 +341,8 @@ gboolean
 asc_result_unit_ignored (AscResult *result)
 {
 	AscResultPrivate *priv = GET_PRIVATE (result);
-	return (g_hash_table_size (priv->cpts) == 0) && (g_hash_table_size (priv->hints) == 0);
+	return (asc_result_components_count (result) == 0) &&
+	       (g_hash_table_size (priv->hints) == 0);
 }
 
 /**
@@ -113,6 +355,8 @@ guint
 asc_result_components_count (AscResult *result)
 {
 	AscResultPrivate *priv = GET_PRIVATE (result);
+	if (priv->cpts_spilled)
+		return priv->n_spilled_cpts;
 	return g_hash_table_size (priv->cpts);
 }
 
@@ -150,6 +394,7 @@ gboolean
 asc_result_is_ignored (AscResult *result, AsComponent *cpt)
 {
 	AscResultPrivate *priv = GET_PRIVATE (result);
+	asc_result_ensure_components (result);
 	return !g_hash_table_contains (priv->cpts, as_component_get_id (cpt));
 }
 
@@ -221,6 +466,7 @@ AsComponent *
 asc_result_get_component (AscResult *result, const gchar *cid)
 {
 	AscResultPrivate *priv = GET_PRIVATE (result);
+	asc_result_ensure_components (result);
 	return g_hash_table_lookup (priv->cpts, cid);
 }
 
@@ -240,6 +486,7 @@ asc_result_fetch_components (AscResult *result)
 	GHashTableIter iter;
 	gpointer value;
 
+	asc_result_ensure_components (result);
 	res = g_ptr_array_new_full (g_hash_table_size (priv->cpts), g_object_unref);
 
 	g_hash_table_iter_init (&iter, priv->cpts);
@@ -307,6 +554,88 @@ asc_result_get_component_ids_with_hints (AscResult *result)
 	return (const gchar **) g_hash_table_get_keys_as_array (priv->hints, NULL);
 }
 
+/**
+ * asc_result_get_gcid_hash_kind:
+ * @result: an #AscResult instance.
+ *
+ * Get the hash function used to build global component IDs.
+ *
+ * Returns: The #AscGcidHashKind in use.
+ **/
+AscGcidHashKind
+asc_result_get_gcid_hash_kind (AscResult *result)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+	return priv->gcid_hash_kind;
+}
+
+/**
+ * asc_result_set_gcid_hash_kind:
+ * @result: an #AscResult instance.
+ * @kind: The #AscGcidHashKind to use.
+ *
+ * Set the hash function used to build global component IDs.
+ * This must be set before any component is added, as changing it
+ * does not update existing global component IDs.
+ *
+ * Returns: %TRUE if the hash function is supported and was set.
+ **/
+gboolean
+asc_result_set_gcid_hash_kind (AscResult *result, AscGcidHashKind kind)
+{
+	AscResultPrivate *priv = GET_PRIVATE (result);
+
+	g_return_val_if_fail (kind < ASC_GCID_HASH_KIND_LAST, FALSE);
+#ifndef HAVE_XXHASH
+	if (kind == ASC_GCID_HASH_KIND_XXH3)
+		return FALSE;
+#endif
+
+	priv->gcid_hash_kind = kind;
+	return TRUE;
+}
+
+/**
+ * asc_result_compute_gcid_hash:
+ *
+ * Hash @data, chained to the previous hash of the component if there is one.
+ * The result is equal to hashing the concatenation of @prev_hash and @data,
+ * without ever copying @data.
+ */
+static gchar *
+asc_result_compute_gcid_hash (AscGcidHashKind kind,
+			      const gchar *prev_hash,
+			      const guint8 *data,
+			      gsize data_len)
+{
+	g_autoptr(GChecksum) cs = NULL;
+
+#ifdef HAVE_XXHASH
+	if (kind == ASC_GCID_HASH_KIND_XXH3) {
+		XXH3_state_t *state;
+		XXH128_hash_t hash;
+
+		state = XXH3_createState ();
+		XXH3_128bits_reset (state);
+		if (prev_hash != NULL)
+			XXH3_128bits_update (state, prev_hash, strlen (prev_hash));
+		XXH3_128bits_update (state, data, data_len);
+		hash = XXH3_128bits_digest (state);
+		XXH3_freeState (state);
+
+		return g_strdup_printf ("%016" G_GINT64_MODIFIER "x%016" G_GINT64_MODIFIER "x",
+					(guint64) hash.high64,
+					(guint64) hash.low64);
+	}
+#endif
+
+	cs = g_checksum_new (G_CHECKSUM_MD5);
+	if (prev_hash != NULL)
+		g_checksum_update (cs, (const guchar *) prev_hash, strlen (prev_hash));
+	g_checksum_update (cs, data, data_len);
+	return g_strdup (g_checksum_get_string (cs));
+}
+
 /**
  * asc_result_update_component_gcid:
  * @result: an #AscResult instance.
@@ -323,17 +652,13 @@ asc_result_update_component_gcid (AscResult *result, AsComponent *cpt, GBytes *b
 	AscResultPrivate *priv = GET_PRIVATE (result);
 	g_autofree gchar *gcid = NULL;
 	gchar *hash = NULL;
-	const gchar *data;
-	gsize data_len;
-	const gchar *old_hash;
+	const guint8 *data = NULL;
+	gsize data_len = 0;
 	const gchar *cid = as_component_get_id (cpt);
 
-	if (bytes == NULL) {
-		data = "";
-		data_len = strlen (data);
-	} else {
+	if (bytes != NULL)
 		data = g_bytes_get_data (bytes, &data_len);
-	}
+	asc_result_ensure_components (result);
 
 	if (as_is_empty (cid)) {
 		gcid = asc_build_component_global_id (cid, NULL);
@@ -345,20 +670,10 @@ asc_result_update_component_gcid (AscResult *result, AsComponent *cpt, GBytes *b
 	if (!g_hash_table_contains (priv->cpts, cid))
 		return FALSE;
 
-	old_hash = g_hash_table_lookup (priv->mdata_hashes, cpt);
-	if (old_hash == NULL) {
-		hash = g_compute_checksum_for_string (G_CHECKSUM_MD5, data, data_len);
-	} else {
-		gsize old_hash_len;
-		g_autofree gchar *tmp = NULL;
-
-		old_hash_len = strlen (old_hash);
-		tmp = g_malloc (old_hash_len + data_len);
-		memcpy (tmp, old_hash, old_hash_len);
-		memcpy (tmp + old_hash_len, data, data_len);
-
-		hash = g_compute_checksum_for_string (G_CHECKSUM_MD5, tmp, old_hash_len + data_len);
-	}
+	hash = asc_result_compute_gcid_hash (priv->gcid_hash_kind,
+					     g_hash_table_lookup (priv->mdata_hashes, cpt),
+					     data,
+					     data_len);
 
 	g_hash_table_insert (priv->mdata_hashes, cpt, hash);
 	gcid = asc_build_component_global_id (cid, hash);
@@ -460,6 +775,7 @@ asc_result_add_component (AscResult *result, AsComponent *cpt, GBytes *bytes, GE
 	AsComponentKind ckind;
 	const gchar *cid = as_component_get_id (cpt);
 
+	asc_result_ensure_components (result);
 	if (as_is_empty (cid)) {
 		g_set_error_literal (error,
 				     ASC_COMPOSE_ERROR,
@@ -527,6 +843,7 @@ asc_result_remove_component_full (AscResult *result, AsComponent *cpt, gboolean
 	AscResultPrivate *priv = GET_PRIVATE (result);
 	gboolean ret;
 
+	asc_result_ensure_components (result);
 	ret = g_hash_table_remove (priv->cpts, as_component_get_id (cpt));
 	if (remove_gcid)
 		g_hash_table_remove (priv->gcids, as_component_get_id (cpt));
@@ -608,6 +925,7 @@ asc_result_remove_component_by_id (AscResult *result, const gchar *cid)
 	AscResultPrivate *priv = GET_PRIVATE (result);
 	AsComponent *cpt;
 
+	asc_result_ensure_components (result);
 	cpt = g_hash_table_lookup (priv->cpts, cid);
 	if (cpt == NULL)
 		return FALSE;
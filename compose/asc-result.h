@@ -31,6 +31,21 @@ G_BEGIN_DECLS
 #define ASC_TYPE_RESULT (asc_result_get_type ())
 G_DECLARE_DERIVABLE_TYPE (AscResult, asc_result, ASC, RESULT, GObject)
 
+/**
+ * AscGcidHashKind:
+ * @ASC_GCID_HASH_KIND_MD5:	MD5 checksums, the default.
+ * @ASC_GCID_HASH_KIND_XXH3:	128-bit XXH3 hashes, a lot faster for large data. Only available if
+ *				AppStream was built with libxxhash.
+ *
+ * Hash function used to build the global component ID from component data.
+ **/
+typedef enum {
+	ASC_GCID_HASH_KIND_MD5,
+	ASC_GCID_HASH_KIND_XXH3,
+	/*< private >*/
+	ASC_GCID_HASH_KIND_LAST
+} AscGcidHashKind;
+
 struct _AscResultClass {
 	GObjectClass parent_class;
 	/*< private >*/
@@ -59,6 +74,9 @@ GPtrArray    *asc_result_get_hints (AscResult *result, const gchar *cid);
 GPtrArray    *asc_result_fetch_hints_all (AscResult *result);
 const gchar **asc_result_get_component_ids_with_hints (AscResult *result);
 
+AscGcidHashKind asc_result_get_gcid_hash_kind (AscResult *result);
+gboolean      asc_result_set_gcid_hash_kind (AscResult *result, AscGcidHashKind kind);
+
 gboolean      asc_result_update_component_gcid (AscResult *result, AsComponent *cpt, GBytes *bytes);
 gboolean      asc_result_update_component_gcid_with_string (AscResult	*result,
 							    AsComponent *cpt,
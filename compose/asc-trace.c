@@ -0,0 +1,339 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:asc-trace
+ * @short_description: Record how long individual compose stages take.
+ *
+ * Collects timed spans of the processing stages of a compose run, so slow units
+ * and stages can be found. The spans can be exported in the Chrome trace-event
+ * format, which can be viewed with Perfetto or chrome://tracing.
+ *
+ * All functions accept a %NULL trace and do nothing in that case, so tracing
+ * costs nothing when it is disabled.
+ */
+
+#include "config.h"
+#include "asc-trace.h"
+
+#include <unistd.h>
+
+typedef struct {
+	const gchar *stage; /* static string */
+	gchar *unit_name;
+	gchar *cid;
+	guint tid;
+	gint64 start_time;
+	gint64 duration;
+} AscTraceEvent;
+
+struct _AscTrace {
+	GMutex mutex;
+	GArray *events;
+	gint64 start_time;
+};
+
+static gint asc_trace_thread_count = 0;
+static GPrivate asc_trace_thread_id;
+
+static void
+asc_trace_event_clear (AscTraceEvent *event)
+{
+	g_free (event->unit_name);
+	g_free (event->cid);
+}
+
+/**
+ * asc_trace_get_thread_id:
+ *
+ * Get a small, stable number identifying the calling thread.
+ */
+static guint
+asc_trace_get_thread_id (void)
+{
+	guint tid = GPOINTER_TO_UINT (g_private_get (&asc_trace_thread_id));
+	if (tid == 0) {
+		tid = (guint) g_atomic_int_add (&asc_trace_thread_count, 1) + 1;
+		g_private_set (&asc_trace_thread_id, GUINT_TO_POINTER (tid));
+	}
+	return tid;
+}
+
+/**
+ * asc_trace_new:
+ *
+ * Create a new, empty trace.
+ *
+ * Returns: (transfer full): a new #AscTrace
+ **/
+AscTrace *
+asc_trace_new (void)
+{
+	AscTrace *trace = g_new0 (AscTrace, 1);
+
+	g_mutex_init (&trace->mutex);
+	trace->events = g_array_new (FALSE, FALSE, sizeof (AscTraceEvent));
+	g_array_set_clear_func (trace->events, (GDestroyNotify) asc_trace_event_clear);
+	trace->start_time = g_get_monotonic_time ();
+	return trace;
+}
+
+/**
+ * asc_trace_free:
+ * @trace: an #AscTrace
+ *
+ * Free the trace and all recorded spans.
+ **/
+void
+asc_trace_free (AscTrace *trace)
+{
+	if (trace == NULL)
+		return;
+	g_array_unref (trace->events);
+	g_mutex_clear (&trace->mutex);
+	g_free (trace);
+}
+
+/**
+ * asc_trace_begin:
+ * @trace: (nullable): an #AscTrace
+ *
+ * Start a span. Pass the returned value to asc_trace_end() once the
+ * stage has finished.
+ *
+ * Returns: The start time of the span.
+ **/
+gint64
+asc_trace_begin (AscTrace *trace)
+{
+	if (trace == NULL)
+		return 0;
+	return g_get_monotonic_time ();
+}
+
+/**
+ * asc_trace_end:
+ * @trace: (nullable): an #AscTrace
+ * @start_time: The value returned by asc_trace_begin()
+ * @stage: Static name of the stage, e.g. "validate"
+ * @unit_name: (nullable): Name of the unit that was processed.
+ * @cid: (nullable): ID of the component that was processed.
+ *
+ * Finish a span and record it.
+ **/
+void
+asc_trace_end (AscTrace *trace,
+	       gint64 start_time,
+	       const gchar *stage,
+	       const gchar *unit_name,
+	       const gchar *cid)
+{
+	AscTraceEvent event;
+
+	if (trace == NULL)
+		return;
+
+	event.stage = stage;
+	event.unit_name = g_strdup (unit_name);
+	event.cid = g_strdup (cid);
+	event.tid = asc_trace_get_thread_id ();
+	event.start_time = start_time;
+	event.duration = g_get_monotonic_time () - start_time;
+
+	g_mutex_lock (&trace->mutex);
+	g_array_append_val (trace->events, event);
+	g_mutex_unlock (&trace->mutex);
+}
+
+/**
+ * asc_trace_get_events_count:
+ * @trace: an #AscTrace
+ *
+ * Returns: The number of recorded spans.
+ **/
+guint
+asc_trace_get_events_count (AscTrace *trace)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&trace->mutex);
+	return trace->events->len;
+}
+
+static void
+asc_trace_append_json_string (GString *str, const gchar *value)
+{
+	g_string_append_c (str, '"');
+	for (const gchar *p = value; *p != '\0'; p++) {
+		guchar c = (guchar) *p;
+		if (c == '"' || c == '\\')
+			g_string_append_printf (str, "\\%c", c);
+		else if (c < 0x20)
+			g_string_append_printf (str, "\\u%04x", c);
+		else
+			g_string_append_c (str, c);
+	}
+	g_string_append_c (str, '"');
+}
+
+/**
+ * asc_trace_to_json:
+ * @trace: an #AscTrace
+ *
+ * Serialize all recorded spans as Chrome trace-event JSON.
+ *
+ * Returns: (transfer full): The JSON document.
+ **/
+gchar *
+asc_trace_to_json (AscTrace *trace)
+{
+	GString *str = g_string_new ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&trace->mutex);
+	guint pid = (guint) getpid ();
+
+	for (guint i = 0; i < trace->events->len; i++) {
+		AscTraceEvent *event = &g_array_index (trace->events, AscTraceEvent, i);
+
+		if (i > 0)
+			g_string_append_c (str, ',');
+		g_string_append (str, "\n{\"name\":");
+		asc_trace_append_json_string (str, event->stage);
+		g_string_append_printf (str,
+					",\"cat\":\"compose\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,"
+					"\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT
+					",\"args\":{",
+					pid,
+					event->tid,
+					event->start_time - trace->start_time,
+					event->duration);
+		if (event->unit_name != NULL) {
+			g_string_append (str, "\"unit\":");
+			asc_trace_append_json_string (str, event->unit_name);
+		}
+		if (event->cid != NULL) {
+			if (event->unit_name != NULL)
+				g_string_append_c (str, ',');
+			g_string_append (str, "\"component\":");
+			asc_trace_append_json_string (str, event->cid);
+		}
+		g_string_append (str, "}}");
+	}
+	g_string_append (str, "\n]}\n");
+
+	return g_string_free (str, FALSE);
+}
+
+/**
+ * asc_trace_save_json:
+ * @trace: an #AscTrace
+ * @fname: File to write to.
+ * @error: A #GError or %NULL
+ *
+ * Save all recorded spans as Chrome trace-event JSON file.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+asc_trace_save_json (AscTrace *trace, const gchar *fname, GError **error)
+{
+	g_autofree gchar *json = asc_trace_to_json (trace);
+	return g_file_set_contents (fname, json, -1, error);
+}
+
+typedef struct {
+	const gchar *stage;
+	guint count;
+	gint64 total;
+	gint64 max;
+} AscTraceStageStats;
+
+static gint
+asc_trace_stage_stats_cmp (gconstpointer a, gconstpointer b)
+{
+	const AscTraceStageStats *sa = *((const AscTraceStageStats **) a);
+	const AscTraceStageStats *sb = *((const AscTraceStageStats **) b);
+
+	if (sa->total > sb->total)
+		return -1;
+	if (sa->total < sb->total)
+		return 1;
+	return g_strcmp0 (sa->stage, sb->stage);
+}
+
+/**
+ * asc_trace_get_summary:
+ * @trace: an #AscTrace
+ *
+ * Aggregate the recorded spans per stage, ordered by the total time
+ * spent in each stage. Nested stages are counted in their parent stage as well.
+ *
+ * Returns: (transfer full): A human-readable table.
+ **/
+gchar *
+asc_trace_get_summary (AscTrace *trace)
+{
+	GString *str = g_string_new (NULL);
+	g_autoptr(GHashTable) stats_map = g_hash_table_new_full (g_str_hash,
+								 g_str_equal,
+								 NULL,
+								 g_free);
+	g_autoptr(GPtrArray) stats_list = g_ptr_array_new ();
+	GHashTableIter iter;
+	gpointer value;
+
+	g_mutex_lock (&trace->mutex);
+	for (guint i = 0; i < trace->events->len; i++) {
+		AscTraceEvent *event = &g_array_index (trace->events, AscTraceEvent, i);
+		AscTraceStageStats *stats = g_hash_table_lookup (stats_map, event->stage);
+
+		if (stats == NULL) {
+			stats = g_new0 (AscTraceStageStats, 1);
+			stats->stage = event->stage;
+			g_hash_table_insert (stats_map, (gpointer) event->stage, stats);
+		}
+		stats->count++;
+		stats->total += event->duration;
+		stats->max = MAX (stats->max, event->duration);
+	}
+	g_mutex_unlock (&trace->mutex);
+
+	g_hash_table_iter_init (&iter, stats_map);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		g_ptr_array_add (stats_list, value);
+	g_ptr_array_sort (stats_list, asc_trace_stage_stats_cmp);
+
+	g_string_append_printf (str,
+				"%-20s %8s %12s %10s %10s\n",
+				"Stage",
+				"Count",
+				"Total (ms)",
+				"Mean (ms)",
+				"Max (ms)");
+	for (guint i = 0; i < stats_list->len; i++) {
+		AscTraceStageStats *stats = g_ptr_array_index (stats_list, i);
+		g_string_append_printf (str,
+					"%-20s %8u %12.1f %10.2f %10.1f\n",
+					stats->stage,
+					stats->count,
+					stats->total / 1000.0,
+					stats->total / 1000.0 / stats->count,
+					stats->max / 1000.0);
+	}
+
+	return g_string_free (str, FALSE);
+}
@@ -0,0 +1,55 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2016-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include "as-macros-private.h"
+
+AS_BEGIN_PRIVATE_DECLS
+
+typedef struct _AscTrace AscTrace;
+
+AS_INTERNAL_VISIBLE
+AscTrace *asc_trace_new (void);
+AS_INTERNAL_VISIBLE
+void	  asc_trace_free (AscTrace *trace);
+
+AS_INTERNAL_VISIBLE
+gint64	  asc_trace_begin (AscTrace *trace);
+AS_INTERNAL_VISIBLE
+void	  asc_trace_end (AscTrace    *trace,
+			 gint64	      start_time,
+			 const gchar *stage,
+			 const gchar *unit_name,
+			 const gchar *cid);
+
+AS_INTERNAL_VISIBLE
+guint	  asc_trace_get_events_count (AscTrace *trace);
+AS_INTERNAL_VISIBLE
+gchar	 *asc_trace_to_json (AscTrace *trace);
+AS_INTERNAL_VISIBLE
+gboolean  asc_trace_save_json (AscTrace *trace, const gchar *fname, GError **error);
+AS_INTERNAL_VISIBLE
+gchar	 *asc_trace_get_summary (AscTrace *trace);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscTrace, asc_trace_free)
+
+AS_END_PRIVATE_DECLS
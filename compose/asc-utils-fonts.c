@@ -29,7 +29,7 @@
 
 #include "as-utils-private.h"
 #include "asc-globals.h"
-#include "asc-font.h"
+#include "asc-font-private.h"
 #include "asc-canvas.h"
 #include "asc-canvas-private.h"
 
@@ -586,8 +586,6 @@ asc_process_fonts (AscResult *cres,
 	contents = asc_unit_get_contents (unit);
 	for (guint i = 0; i < contents->len; i++) {
 		g_autoptr(GBytes) font_bytes = NULL;
-		const void *data;
-		gsize data_len;
 		g_autoptr(GError) tmp_error = NULL;
 		g_autoptr(AscFont) font = NULL;
 		g_autofree gchar *basename = NULL;
@@ -611,9 +609,8 @@ asc_process_fonts (AscResult *cres,
 					     NULL);
 			continue;
 		}
-		data = g_bytes_get_data (font_bytes, &data_len);
 
-		font = asc_font_new_from_data (data, data_len, basename, &tmp_error);
+		font = asc_font_new_from_bytes (font_bytes, basename, &tmp_error);
 		if (font == NULL) {
 			asc_result_add_hint (cres,
 					     NULL,
@@ -93,6 +93,84 @@ asc_locale_entry_sort_cb (gconstpointer a, gconstpointer b)
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscLocaleContext, asc_locale_ctx_free)
 
+/**
+ * AscLocaleIndex:
+ *
+ * Index of all potential translation files of a unit, so we only
+ * need to walk the unit contents once, no matter how many components
+ * and translation domains we have.
+ */
+typedef struct {
+	GHashTable *lcmsg_files; /* domain file basename -> files in LC_MESSAGES below ${prefix}/share/locale* */
+	GPtrArray *qm_files;	 /* all .qm files in ${prefix}/share */
+} AscLocaleIndex;
+
+static void
+asc_locale_index_free (AscLocaleIndex *index)
+{
+	g_hash_table_unref (index->lcmsg_files);
+	g_ptr_array_unref (index->qm_files);
+	g_free (index);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (AscLocaleIndex, asc_locale_index_free)
+
+/**
+ * asc_locale_index_new:
+ *
+ * Create a new locale file index for the contents of @unit.
+ * The index does not copy any filenames, so it must not outlive
+ * the unit contents.
+ */
+static AscLocaleIndex *
+asc_locale_index_new (AscUnit *unit, const gchar *prefix)
+{
+	AscLocaleIndex *index;
+	GPtrArray *contents = asc_unit_get_contents (unit);
+	g_autofree gchar *share_root = g_build_filename (prefix, "share", NULL);
+	g_autofree gchar *locale_root = g_build_filename (prefix, "share", "locale", NULL);
+	const gchar *lcmsg_dir = G_DIR_SEPARATOR_S "LC_MESSAGES";
+	const gsize lcmsg_dir_len = strlen (lcmsg_dir);
+	const gsize locale_root_len = strlen (locale_root);
+
+	index = g_new0 (AscLocaleIndex, 1);
+	index->lcmsg_files = g_hash_table_new_full (g_str_hash,
+						    g_str_equal,
+						    NULL,
+						    (GDestroyNotify) g_ptr_array_unref);
+	index->qm_files = g_ptr_array_new ();
+
+	for (guint i = 0; i < contents->len; i++) {
+		const gchar *fname = g_ptr_array_index (contents, i);
+		const gchar *basename;
+		GPtrArray *files;
+
+		if (!g_str_has_prefix (fname, share_root))
+			continue;
+		if (g_str_has_suffix (fname, ".qm"))
+			g_ptr_array_add (index->qm_files, (gpointer) fname);
+
+		/* we are looking for LC_MESSAGES/${domain_file} files in any ${prefix}/share/locale* directory */
+		if (!g_str_has_prefix (fname, locale_root))
+			continue;
+		basename = strrchr (fname, G_DIR_SEPARATOR);
+		if (basename == NULL || (gsize) (basename - fname) < locale_root_len + lcmsg_dir_len)
+			continue;
+		if (strncmp (basename - lcmsg_dir_len, lcmsg_dir, lcmsg_dir_len) != 0)
+			continue;
+		basename++;
+
+		files = g_hash_table_lookup (index->lcmsg_files, basename);
+		if (files == NULL) {
+			files = g_ptr_array_new ();
+			g_hash_table_insert (index->lcmsg_files, (gpointer) basename, files);
+		}
+		g_ptr_array_add (files, (gpointer) fname);
+	}
+
+	return index;
+}
+
 typedef struct {
 	guint32 magic;
 	guint32 revision;
@@ -119,15 +197,23 @@ asc_l10n_parse_file_gettext (AscLocaleContext *ctx,
 	AscLocaleGettextHeader h;
 	g_autoptr(GBytes) bytes = NULL;
 	const gchar *data = NULL;
+	gsize len;
 	gboolean swapped;
 
-	/* read data */
+	/* read data - this maps the file for directory units, so we don't copy anything */
 	bytes = asc_unit_read_data (unit, filename, error);
 	if (bytes == NULL)
 		return FALSE;
-	data = g_bytes_get_data (bytes, NULL);
+	data = g_bytes_get_data (bytes, &len);
 
 	/* we only strictly need the header */
+	if (len < sizeof (AscLocaleGettextHeader)) {
+		g_set_error_literal (error,
+				     ASC_COMPOSE_ERROR,
+				     ASC_COMPOSE_ERROR_FAILED,
+				     "Gettext file is invalid, header is truncated");
+		return FALSE;
+	}
 	memcpy (&h, data, sizeof (AscLocaleGettextHeader));
 	if (h.magic == 0x950412de)
 		swapped = FALSE;
@@ -153,31 +239,30 @@ asc_l10n_parse_file_gettext (AscLocaleContext *ctx,
 static gboolean
 asc_l10n_search_translations_gettext (AscLocaleContext *ctx,
 				      AscUnit *unit,
+				      AscLocaleIndex *index,
 				      const gchar *prefix,
 				      GError **error)
 {
-	GPtrArray *contents = NULL;
 	const gsize prefix_len = strlen (prefix) + 1;
 
-	contents = asc_unit_get_contents (unit);
 	for (guint i = 0; i < ctx->translations->len; i++) {
 		AsTranslation *t = g_ptr_array_index (ctx->translations, i);
 		g_autofree gchar *fn = NULL;
-		g_autofree gchar *match_path = NULL;
+		GPtrArray *files;
 		if (as_translation_get_kind (t) != AS_TRANSLATION_KIND_GETTEXT &&
 		    as_translation_get_kind (t) != AS_TRANSLATION_KIND_UNKNOWN)
 			continue;
 
-		/* construct expected translation file name pattern */
+		/* find all LC_MESSAGES/${id}.mo files in ${prefix}/share/locale* */
 		fn = g_strdup_printf ("%s.mo", as_translation_get_id (t));
-		match_path = g_build_filename (prefix, "share", "locale*", "LC_MESSAGES", fn, NULL);
+		files = g_hash_table_lookup (index->lcmsg_files, fn);
+		if (files == NULL)
+			continue;
 
 		/* try to find locale data */
-		for (guint j = 0; j < contents->len; j++) {
-			const gchar *fname = g_ptr_array_index (contents, j);
+		for (guint j = 0; j < files->len; j++) {
+			const gchar *fname = g_ptr_array_index (files, j);
 			g_auto(GStrv) segments = NULL;
-			if (!g_pattern_match_simple (match_path, fname))
-				continue;
 
 			/* fetch locale name from path */
 			segments = g_strsplit (fname + prefix_len, G_DIR_SEPARATOR_S, 4);
@@ -247,9 +332,19 @@ asc_l10n_parse_data_qt (AscLocaleContext *ctx, const gchar *locale, const guint8
 		case ASC_LOCALE_QM_TAG_SOURCE_TEXT:
 		case ASC_LOCALE_QM_TAG_CONTEXT:
 		case ASC_LOCALE_QM_TAG_COMMENT:
+			/* never read beyond the end of the messages section */
+			if (len - m < 4) {
+				m = G_MAXUINT32;
+				break;
+			}
 			tag_len = _read_uint32 (data, &m);
-			if (tag_len < 0xffffffff)
+			if (tag_len < 0xffffffff) {
+				if (tag_len > len - m) {
+					m = G_MAXUINT32;
+					break;
+				}
 				m += tag_len;
+			}
 			if (tag == ASC_LOCALE_QM_TAG_TRANSLATION)
 				nstrings++;
 			break;
@@ -280,11 +375,18 @@ asc_l10n_parse_file_qt (AscLocaleContext *ctx,
 	const guint8 qm_magic[] = { 0x3c, 0xb8, 0x64, 0x18, 0xca, 0xef, 0x9c, 0x95,
 				    0xcd, 0x21, 0x1c, 0xbf, 0x60, 0xa1, 0xbd, 0xdd };
 
-	/* read data */
+	/* read data - this maps the file for directory units, so we don't copy anything */
 	bytes = asc_unit_read_data (unit, filename, error);
 	if (bytes == NULL)
 		return FALSE;
 	data = g_bytes_get_data (bytes, &len);
+	if (len > G_MAXUINT32) {
+		g_set_error_literal (error,
+				     ASC_COMPOSE_ERROR,
+				     ASC_COMPOSE_ERROR_FAILED,
+				     "QM translation file is too large");
+		return FALSE;
+	}
 
 	/* check header */
 	if (len < sizeof (qm_magic) || memcmp (data, qm_magic, sizeof (qm_magic)) != 0) {
@@ -298,8 +400,18 @@ asc_l10n_parse_file_qt (AscLocaleContext *ctx,
 
 	/* parse each section */
 	while (m < len) {
-		AscLocaleQmSection section = _read_uint8 (data, &m);
-		guint32 section_len = _read_uint32 (data, &m);
+		AscLocaleQmSection section;
+		guint32 section_len;
+
+		if (len - m < 5) {
+			g_set_error_literal (error,
+					     ASC_COMPOSE_ERROR,
+					     ASC_COMPOSE_ERROR_FAILED,
+					     "QM file is invalid, section header is truncated");
+			return FALSE;
+		}
+		section = _read_uint8 (data, &m);
+		section_len = _read_uint32 (data, &m);
 		if (section_len > len - m) {
 			g_set_error_literal (error,
 					     ASC_COMPOSE_ERROR,
@@ -319,10 +431,10 @@ asc_l10n_parse_file_qt (AscLocaleContext *ctx,
 static gboolean
 asc_l10n_search_translations_qt (AscLocaleContext *ctx,
 				 AscUnit *unit,
+				 AscLocaleIndex *index,
 				 const gchar *prefix,
 				 GError **error)
 {
-	GPtrArray *contents = asc_unit_get_contents (unit);
 	const gsize prefix_len = strlen (prefix) + 1;
 
 	/* search for each translation ID */
@@ -338,24 +450,17 @@ asc_l10n_search_translations_qt (AscLocaleContext *ctx,
 
 		location_hint = as_translation_get_id (t);
 		if (g_strstr_len (location_hint, -1, "/") == NULL) {
-			/* look in ${prefix}/share/locale/${locale}/LC_MESSAGES/${hint}.mo */
+			/* look in ${prefix}/share/locale/${locale}/LC_MESSAGES/${hint}.qm */
 			g_autofree gchar *fn = NULL;
-			g_autofree gchar *match_path = NULL;
+			GPtrArray *files;
 
 			fn = g_strdup_printf ("%s.qm", location_hint);
-			match_path = g_build_filename (prefix,
-						       "share",
-						       "locale*",
-						       "LC_MESSAGES",
-						       fn,
-						       NULL);
-			for (guint j = 0; j < contents->len; j++) {
+			files = g_hash_table_lookup (index->lcmsg_files, fn);
+			if (files == NULL)
+				continue;
+			for (guint j = 0; j < files->len; j++) {
 				g_auto(GStrv) segments = NULL;
-				const gchar *fname = g_ptr_array_index (contents, j);
-				if (!g_str_has_suffix (fname, ".qm"))
-					continue;
-				if (!g_pattern_match_simple (match_path, fname))
-					continue;
+				const gchar *fname = g_ptr_array_index (files, j);
 
 				segments = g_strsplit (fname + prefix_len, G_DIR_SEPARATOR_S, 4);
 				if (!asc_l10n_parse_file_qt (ctx, unit, segments[2], fname, error))
@@ -367,14 +472,12 @@ asc_l10n_search_translations_qt (AscLocaleContext *ctx,
 
 			g_autofree gchar *qm_root = NULL;
 			qm_root = g_build_filename (prefix, "share", location_hint, NULL);
-			for (guint j = 0; j < contents->len; j++) {
+			for (guint j = 0; j < index->qm_files->len; j++) {
 				g_autofree gchar *locale = NULL;
 				gchar *tmp;
-				const gchar *fname = g_ptr_array_index (contents, j);
+				const gchar *fname = g_ptr_array_index (index->qm_files, j);
 				if (!g_str_has_prefix (fname, qm_root))
 					continue;
-				if (!g_str_has_suffix (fname, ".qm"))
-					continue;
 				locale = g_strdup (fname + strlen (qm_root) + 1);
 				g_strdelimit (locale, ".", '\0');
 				/* tmp == NULL means we have the ${hint}/${locale}.qm form */
@@ -418,6 +521,7 @@ asc_read_translation_status (AscResult *cres,
 			     guint min_percentage)
 {
 	g_autoptr(GPtrArray) cpts = NULL;
+	g_autoptr(AscLocaleIndex) index = NULL;
 
 	cpts = asc_result_fetch_components (cres);
 	for (guint i = 0; i < cpts->len; i++) {
@@ -434,8 +538,12 @@ asc_read_translation_status (AscResult *cres,
 		if (ctx->translations->len == 0)
 			continue;
 
+		/* index the unit contents once for all components */
+		if (index == NULL)
+			index = asc_locale_index_new (unit, prefix);
+
 		/* search for Qt .qm files */
-		if (!asc_l10n_search_translations_qt (ctx, unit, prefix, &error)) {
+		if (!asc_l10n_search_translations_qt (ctx, unit, index, prefix, &error)) {
 			asc_result_add_hint (cres,
 					     cpt,
 					     "translation-status-error",
@@ -446,7 +554,7 @@ asc_read_translation_status (AscResult *cres,
 		}
 
 		/* search for gettext .mo files */
-		if (!asc_l10n_search_translations_gettext (ctx, unit, prefix, &error)) {
+		if (!asc_l10n_search_translations_gettext (ctx, unit, index, prefix, &error)) {
 			asc_result_add_hint (cres,
 					     cpt,
 					     "translation-status-error",
@@ -410,6 +410,19 @@ asc_process_screenshot_videos (AscResult *cres,
 	return g_object_ref (scr);
 }
 
+/**
+ * asc_screenshot_thumbnail_name:
+ *
+ * Build the file name of a screenshot thumbnail.
+ */
+static gchar *
+asc_screenshot_thumbnail_name (guint scr_no, guint width, guint height, const gchar *locale)
+{
+	if (g_strcmp0 (locale, "C") == 0)
+		return g_strdup_printf ("image-%i_%ix%i.png", scr_no, width, height);
+	return g_strdup_printf ("image-%i_%ix%i_%s.png", scr_no, width, height, locale);
+}
+
 /**
  * asc_process_screenshot_images_lang:
  *
@@ -424,6 +437,7 @@ asc_process_screenshot_images_lang (AscResult *cres,
 				    AsImage *orig_img,
 				    const gchar *locale,
 				    AsCurl *acurl,
+				    AscMediaRegistry *mreg,
 				    const gchar *scr_export_dir,
 				    const gchar *scr_base_url,
 				    const gssize max_size_bytes,
@@ -500,6 +514,7 @@ asc_process_screenshot_images_lang (AscResult *cres,
 
 	{
 		g_autoptr(AscImage) src_image = NULL;
+		g_autofree gchar *src_key = NULL;
 		g_autofree gchar *src_img_name = NULL;
 		g_autofree gchar *src_img_path = NULL;
 		g_autofree gchar *src_img_url = NULL;
@@ -512,54 +527,72 @@ asc_process_screenshot_images_lang (AscResult *cres,
 		src_img_path = g_build_filename (scr_export_dir, src_img_name, NULL);
 		src_img_url = g_build_filename (scr_base_url, src_img_name, NULL);
 
-		/* save the source screenshot as PNG image */
-		src_image = asc_image_new_from_data (img_data,
-						     img_data_len,
-						     0,	    /* destination size */
-						     FALSE, /* compressed */
-						     ASC_IMAGE_LOAD_FLAG_NONE,
-						     &error);
-		if (error != NULL) {
-			g_autofree gchar *msg = g_strdup_printf (
-			    "Could not load source screenshot for storing: %s",
-			    error->message);
-			asc_result_add_hint (cres,
-					     cpt,
-					     "screenshot-save-error",
-					     "url",
-					     orig_img_url,
-					     "error",
-					     msg,
-					     NULL);
-			return FALSE;
-		}
+		src_key = asc_media_registry_make_key (img_bytes, "screenshot-source");
+		if (store_screenshots && asc_media_registry_reuse (mreg,
+								   src_key,
+								   src_img_path,
+								   &source_scr_width,
+								   &source_scr_height)) {
+			g_debug ("Reusing screenshot: %s", src_img_path);
+		} else {
+			gint64 start_time = g_get_monotonic_time ();
+
+			/* save the source screenshot as PNG image */
+			src_image = asc_image_new_from_data (img_data,
+							     img_data_len,
+							     0,	    /* destination size */
+							     FALSE, /* compressed */
+							     ASC_IMAGE_LOAD_FLAG_NONE,
+							     &error);
+			if (error != NULL) {
+				g_autofree gchar *msg = g_strdup_printf (
+				    "Could not load source screenshot for storing: %s",
+				    error->message);
+				asc_result_add_hint (cres,
+						     cpt,
+						     "screenshot-save-error",
+						     "url",
+						     orig_img_url,
+						     "error",
+						     msg,
+						     NULL);
+				return FALSE;
+			}
 
-		if (!asc_image_save_filename (src_image,
-					      src_img_path,
-					      0,
-					      0,
-					      ASC_IMAGE_SAVE_FLAG_OPTIMIZE,
-					      &error)) {
-			g_autofree gchar *msg = g_strdup_printf (
-			    "Can not store source screenshot: %s",
-			    error->message);
-			asc_result_add_hint (cres,
-					     cpt,
-					     "screenshot-save-error",
-					     "url",
-					     orig_img_url,
-					     "error",
-					     msg,
-					     NULL);
-			return FALSE;
+			if (!asc_image_save_filename (src_image,
+						      src_img_path,
+						      0,
+						      0,
+						      ASC_IMAGE_SAVE_FLAG_OPTIMIZE,
+						      &error)) {
+				g_autofree gchar *msg = g_strdup_printf (
+				    "Can not store source screenshot: %s",
+				    error->message);
+				asc_result_add_hint (cres,
+						     cpt,
+						     "screenshot-save-error",
+						     "url",
+						     orig_img_url,
+						     "error",
+						     msg,
+						     NULL);
+				return FALSE;
+			}
+
+			source_scr_width = asc_image_get_width (src_image);
+			source_scr_height = asc_image_get_height (src_image);
+			if (store_screenshots)
+				asc_media_registry_add (mreg,
+							src_key,
+							src_img_path,
+							source_scr_width,
+							source_scr_height,
+							g_get_monotonic_time () - start_time);
 		}
 
 		simg = as_image_new ();
 		as_image_set_kind (simg, AS_IMAGE_KIND_SOURCE);
 		as_image_set_locale (simg, locale);
-
-		source_scr_width = asc_image_get_width (src_image);
-		source_scr_height = asc_image_get_height (src_image);
 		as_image_set_width (simg, source_scr_width);
 		as_image_set_height (simg, source_scr_height);
 
@@ -584,9 +617,15 @@ asc_process_screenshot_images_lang (AscResult *cres,
 	for (guint i = 0; target_screenshot_sizes[i].width != 0; i++) {
 		g_autoptr(AscImage) thumb = NULL;
 		g_autoptr(AsImage) img = NULL;
+		g_autofree gchar *thumb_key = NULL;
+		g_autofree gchar *thumb_variant = NULL;
 		g_autofree gchar *thumb_img_name = NULL;
 		g_autofree gchar *thumb_img_path = NULL;
 		g_autofree gchar *thumb_img_url = NULL;
+		guint thumb_width = 0;
+		guint thumb_height = 0;
+		gboolean reused = FALSE;
+		gint64 start_time;
 
 		guint target_width = target_screenshot_sizes[i].width;
 		guint target_height = target_screenshot_sizes[i].height;
@@ -597,76 +636,102 @@ asc_process_screenshot_images_lang (AscResult *cres,
 		if (target_height > source_scr_height)
 			continue;
 
-		thumb = asc_image_new_from_data (img_data,
-						 img_data_len,
-						 0,	/* destination size */
-						 FALSE, /* compressed */
-						 ASC_IMAGE_LOAD_FLAG_NONE,
-						 &error);
-		if (error != NULL) {
-			g_autofree gchar *msg = g_strdup_printf (
-			    "Could not load source screenshot for thumbnailing: %s",
-			    error->message);
-			asc_result_add_hint (cres,
-					     cpt,
-					     "screenshot-save-error",
-					     "url",
-					     orig_img_url,
-					     "error",
-					     msg,
-					     NULL);
-			g_error_free (g_steal_pointer (&error));
-			continue;
+		/* check if we already generated this thumbnail for identical image data */
+		thumb_variant = g_strdup_printf ("screenshot-thumbnail-%ux%u",
+						 target_width,
+						 target_height);
+		thumb_key = asc_media_registry_make_key (img_bytes, thumb_variant);
+		if (asc_media_registry_lookup (mreg, thumb_key, &thumb_width, &thumb_height)) {
+			thumb_img_name = asc_screenshot_thumbnail_name (scr_no,
+									thumb_width,
+									thumb_height,
+									locale);
+			thumb_img_path = g_build_filename (scr_export_dir, thumb_img_name, NULL);
+			reused = asc_media_registry_reuse (mreg, thumb_key, thumb_img_path, NULL, NULL);
+			if (!reused) {
+				g_clear_pointer (&thumb_img_name, g_free);
+				g_clear_pointer (&thumb_img_path, g_free);
+			}
 		}
 
-		if (target_width > target_height)
-			asc_image_scale_to_width (thumb, target_width);
-		else
-			asc_image_scale_to_height (thumb, target_height);
+		if (reused) {
+			g_debug ("Reusing thumbnail: %s", thumb_img_path);
+		} else {
+			start_time = g_get_monotonic_time ();
+			thumb = asc_image_new_from_data (img_data,
+							 img_data_len,
+							 0,	/* destination size */
+							 FALSE, /* compressed */
+							 ASC_IMAGE_LOAD_FLAG_NONE,
+							 &error);
+			if (error != NULL) {
+				g_autofree gchar *msg = g_strdup_printf (
+				    "Could not load source screenshot for thumbnailing: %s",
+				    error->message);
+				asc_result_add_hint (cres,
+						     cpt,
+						     "screenshot-save-error",
+						     "url",
+						     orig_img_url,
+						     "error",
+						     msg,
+						     NULL);
+				g_error_free (g_steal_pointer (&error));
+				continue;
+			}
 
-		/* create thumbnail storage path and URL component*/
-		if (g_strcmp0 (locale, "C") == 0)
-			thumb_img_name = g_strdup_printf ("image-%i_%ix%i.png",
-							  scr_no,
-							  asc_image_get_width (thumb),
-							  asc_image_get_height (thumb));
-		else
-			thumb_img_name = g_strdup_printf ("image-%i_%ix%i_%s.png",
-							  scr_no,
-							  asc_image_get_width (thumb),
-							  asc_image_get_height (thumb),
-							  locale);
-		thumb_img_path = g_build_filename (scr_export_dir, thumb_img_name, NULL);
-		thumb_img_url = g_build_filename (scr_base_url, thumb_img_name, NULL);
+			if (target_width > target_height)
+				asc_image_scale_to_width (thumb, target_width);
+			else
+				asc_image_scale_to_height (thumb, target_height);
+			thumb_width = asc_image_get_width (thumb);
+			thumb_height = asc_image_get_height (thumb);
+
+			/* create thumbnail storage path */
+			thumb_img_name = asc_screenshot_thumbnail_name (scr_no,
+									thumb_width,
+									thumb_height,
+									locale);
+			thumb_img_path = g_build_filename (scr_export_dir, thumb_img_name, NULL);
+
+			/* store the thumbnail image on disk, never writing into a possibly linked file */
+			g_remove (thumb_img_path);
+			if (!asc_image_save_filename (thumb,
+						      thumb_img_path,
+						      0,
+						      0,
+						      ASC_IMAGE_SAVE_FLAG_OPTIMIZE,
+						      &error)) {
+				g_autofree gchar *msg = g_strdup_printf (
+				    "Can not store thumbnail image: %s",
+				    error->message);
+				asc_result_add_hint (cres,
+						     cpt,
+						     "screenshot-save-error",
+						     "url",
+						     orig_img_url,
+						     "error",
+						     msg,
+						     NULL);
+				g_error_free (g_steal_pointer (&error));
+				continue;
+			}
 
-		/* store the thumbnail image on disk */
-		if (!asc_image_save_filename (thumb,
-					      thumb_img_path,
-					      0,
-					      0,
-					      ASC_IMAGE_SAVE_FLAG_OPTIMIZE,
-					      &error)) {
-			g_autofree gchar *msg = g_strdup_printf (
-			    "Can not store thumbnail image: %s",
-			    error->message);
-			asc_result_add_hint (cres,
-					     cpt,
-					     "screenshot-save-error",
-					     "url",
-					     orig_img_url,
-					     "error",
-					     msg,
-					     NULL);
-			g_error_free (g_steal_pointer (&error));
-			continue;
+			asc_media_registry_add (mreg,
+						thumb_key,
+						thumb_img_path,
+						thumb_width,
+						thumb_height,
+						g_get_monotonic_time () - start_time);
 		}
+		thumb_img_url = g_build_filename (scr_base_url, thumb_img_name, NULL);
 
 		/* finally prepare the thumbnail definition and add it to the metadata */
 		img = as_image_new ();
 		as_image_set_locale (img, locale);
 		as_image_set_kind (img, AS_IMAGE_KIND_THUMBNAIL);
-		as_image_set_width (img, asc_image_get_width (thumb));
-		as_image_set_height (img, asc_image_get_height (thumb));
+		as_image_set_width (img, thumb_width);
+		as_image_set_height (img, thumb_height);
 		as_image_set_url (img, thumb_img_url);
 		as_screenshot_add_image (scr, img);
 
@@ -694,6 +759,7 @@ asc_process_screenshot_images (AscResult *cres,
 			       AsComponent *cpt,
 			       AsScreenshot *scr,
 			       AsCurl *acurl,
+			       AscMediaRegistry *mreg,
 			       const gchar *scr_export_dir,
 			       const gchar *scr_base_url,
 			       const gssize max_size_bytes,
@@ -742,6 +808,7 @@ asc_process_screenshot_images (AscResult *cres,
 							 AS_IMAGE (ht_value),
 							 (const gchar *) ht_key,
 							 acurl,
+							 mreg,
 							 scr_export_dir,
 							 scr_base_url,
 							 max_size_bytes,
@@ -761,6 +828,7 @@ void
 asc_process_screenshots (AscResult *cres,
 			 AsComponent *cpt,
 			 AsCurl *acurl,
+			 AscMediaRegistry *mreg,
 			 const gchar *media_export_root,
 			 const gchar *media_url_prefix,
 			 const gssize max_size_bytes,
@@ -831,6 +899,7 @@ asc_process_screenshots (AscResult *cres,
 								 cpt,
 								 scr,
 								 acurl,
+								 mreg,
 								 scr_export_dir,
 								 scr_base_url,
 								 max_size_bytes,
@@ -26,6 +26,7 @@
 #include "as-curl.h"
 
 #include "asc-result.h"
+#include "asc-media-registry.h"
 
 AS_BEGIN_PRIVATE_DECLS
 
@@ -51,13 +52,14 @@ AscVideoInfo *asc_extract_video_info (AscResult *cres, AsComponent *cpt, const g
 AS_INTERNAL_VISIBLE
 void asc_video_info_free (AscVideoInfo *vinfo);
 
-void asc_process_screenshots (AscResult	  *cres,
-			      AsComponent *cpt,
-			      AsCurl	  *acurl,
-			      const gchar *media_export_root,
-			      const gchar *media_url_prefix,
-			      const gssize max_size_bytes,
-			      gboolean	   process_videos,
-			      gboolean	   store_screenshots);
+void asc_process_screenshots (AscResult	       *cres,
+			      AsComponent      *cpt,
+			      AsCurl	       *acurl,
+			      AscMediaRegistry *mreg,
+			      const gchar      *media_export_root,
+			      const gchar      *media_url_prefix,
+			      const gssize      max_size_bytes,
+			      gboolean		process_videos,
+			      gboolean		store_screenshots);
 
 AS_END_PRIVATE_DECLS
@@ -21,6 +21,7 @@
 #define APPSTREAMQT_CHELPERS_H
 
 #include <glib.h>
+#include <QByteArray>
 #include <QStringList>
 
 namespace AppStream
@@ -31,6 +32,45 @@ inline QString valueWrap(const gchar *cstr)
     return QString::fromUtf8(cstr);
 }
 
+/**
+ * A QString converted from a string owned by a C object.
+ *
+ * The C string may be replaced at any time, e.g. by a setter on the C side
+ * or by switching the active locale, and a new string can end up at the
+ * address of the old one. We therefore keep a copy of the UTF-8 data the
+ * value was converted from, comparing it is much cheaper than decoding.
+ */
+struct CachedString {
+    bool valid = false;
+    bool sourceIsNull = true;
+    QByteArray source;
+    QString value;
+
+    void clear()
+    {
+        valid = false;
+        sourceIsNull = true;
+        source.clear();
+        value.clear();
+    }
+};
+
+inline QString valueWrap(CachedString &cache, const gchar *cstr)
+{
+    if (cache.valid) {
+        if (cstr == nullptr && cache.sourceIsNull)
+            return cache.value;
+        if (cstr != nullptr && !cache.sourceIsNull && qstrcmp(cache.source.constData(), cstr) == 0)
+            return cache.value;
+    }
+
+    cache.valid = true;
+    cache.sourceIsNull = cstr == nullptr;
+    cache.source = QByteArray(cstr);
+    cache.value = QString::fromUtf8(cstr);
+    return cache.value;
+}
+
 inline QStringList valueWrap(gchar **strv)
 {
     QStringList res;
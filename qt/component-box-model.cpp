@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "appstream.h"
+#include "component-box-model.h"
+
+#include <utility>
+#include <QPointer>
+#include "chelpers.h"
+#include "pool.h"
+
+using namespace AppStream;
+
+class AppStream::ComponentBoxModelPrivate
+{
+public:
+    ComponentBoxModelPrivate(const ComponentBox &cbox)
+        : cbox(cbox)
+    {
+    }
+
+    AsComponent *componentAt(int row) const
+    {
+        if (row < 0)
+            return nullptr;
+        return as_component_box_index_safe(cbox.asComponentBox(), row);
+    }
+
+    ComponentBox cbox;
+    QPointer<Pool> pool;
+    ComponentBoxModel::PoolQuery query;
+    QList<QMetaObject::Connection> poolConnections;
+};
+
+static QString componentStockIconName(AsComponent *cpt)
+{
+    GPtrArray *icons = as_component_get_icons(cpt);
+    for (uint i = 0; i < icons->len; i++) {
+        AsIcon *icon = AS_ICON(g_ptr_array_index(icons, i));
+        if (as_icon_get_kind(icon) == AS_ICON_KIND_STOCK)
+            return valueWrap(as_icon_get_name(icon));
+    }
+
+    return QString();
+}
+
+ComponentBoxModel::ComponentBoxModel(QObject *parent)
+    : ComponentBoxModel(ComponentBox(ComponentBox::FlagNoChecks), parent)
+{
+}
+
+ComponentBoxModel::ComponentBoxModel(const ComponentBox &cbox, QObject *parent)
+    : QAbstractListModel(parent)
+    , d(new ComponentBoxModelPrivate(cbox))
+{
+}
+
+ComponentBoxModel::~ComponentBoxModel()
+{
+    // empty. needed for the scoped pointer for the private pointer
+}
+
+ComponentBox ComponentBoxModel::componentBox() const
+{
+    return d->cbox;
+}
+
+void ComponentBoxModel::setComponentBox(const ComponentBox &cbox)
+{
+    for (const auto &connection : std::as_const(d->poolConnections))
+        disconnect(connection);
+    d->poolConnections.clear();
+    d->pool.clear();
+    d->query = nullptr;
+
+    const int oldCount = count();
+    beginResetModel();
+    d->cbox = cbox;
+    endResetModel();
+    if (count() != oldCount)
+        Q_EMIT countChanged();
+}
+
+void ComponentBoxModel::setPoolQuery(Pool *pool, const PoolQuery &query)
+{
+    setComponentBox(ComponentBox(ComponentBox::FlagNoChecks));
+    if (pool == nullptr || !query)
+        return;
+
+    d->pool = pool;
+    d->query = query;
+
+    // the pool may announce changes from a background thread after an automatic reload
+    d->poolConnections.append(
+        connect(pool, &Pool::changed, this, &ComponentBoxModel::refresh, Qt::QueuedConnection));
+    d->poolConnections.append(connect(pool,
+                                      &Pool::loadFinished,
+                                      this,
+                                      &ComponentBoxModel::refresh,
+                                      Qt::QueuedConnection));
+    refresh();
+}
+
+void ComponentBoxModel::refresh()
+{
+    if (d->pool.isNull() || !d->query)
+        return;
+
+    const int oldCount = count();
+    ComponentBox result = d->query(*d->pool);
+
+    beginResetModel();
+    d->cbox = result;
+    endResetModel();
+    if (count() != oldCount)
+        Q_EMIT countChanged();
+}
+
+Component ComponentBoxModel::componentAt(int row) const
+{
+    AsComponent *cpt = d->componentAt(row);
+    if (cpt == nullptr)
+        return Component();
+    return Component(cpt);
+}
+
+int ComponentBoxModel::count() const
+{
+    return static_cast<int>(d->cbox.size());
+}
+
+int ComponentBoxModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return count();
+}
+
+QVariant ComponentBoxModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid))
+        return QVariant();
+
+    AsComponent *cpt = d->componentAt(index.row());
+    if (cpt == nullptr)
+        return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return valueWrap(as_component_get_name(cpt));
+    case Qt::ToolTipRole:
+    case SummaryRole:
+        return valueWrap(as_component_get_summary(cpt));
+    case IdRole:
+        return valueWrap(as_component_get_id(cpt));
+    case DataIdRole:
+        return valueWrap(as_component_get_data_id(cpt));
+    case KindRole:
+        return QVariant::fromValue(static_cast<Component::Kind>(as_component_get_kind(cpt)));
+    case PackageNamesRole:
+        return valueWrap(as_component_get_pkgnames(cpt));
+    case IconNameRole:
+        return componentStockIconName(cpt);
+    case ComponentRole:
+        return QVariant::fromValue(Component(cpt));
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> ComponentBoxModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = QAbstractListModel::roleNames();
+    roles.insert(IdRole, QByteArrayLiteral("id"));
+    roles.insert(DataIdRole, QByteArrayLiteral("dataId"));
+    roles.insert(KindRole, QByteArrayLiteral("kind"));
+    roles.insert(NameRole, QByteArrayLiteral("name"));
+    roles.insert(SummaryRole, QByteArrayLiteral("summary"));
+    roles.insert(PackageNamesRole, QByteArrayLiteral("packageNames"));
+    roles.insert(IconNameRole, QByteArrayLiteral("iconName"));
+    roles.insert(ComponentRole, QByteArrayLiteral("component"));
+    return roles;
+}
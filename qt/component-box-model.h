@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <QAbstractListModel>
+#include <QScopedPointer>
+#include "appstreamqt_export.h"
+
+#include "component-box.h"
+
+namespace AppStream
+{
+
+class Pool;
+class ComponentBoxModelPrivate;
+
+/**
+ * A list model backed directly by a ComponentBox.
+ *
+ * Unlike ComponentBox::toList(), no Component wrappers are created up front:
+ * values are read from the underlying component only for the rows and roles
+ * a view actually requests.
+ *
+ * The model can either display a fixed ComponentBox, or the result of a
+ * query on a Pool. In the latter case the query is run again and the model
+ * is reset whenever the pool changes or finished loading.
+ */
+class APPSTREAMQT_EXPORT ComponentBoxModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Role {
+        IdRole = Qt::UserRole + 1,
+        DataIdRole,
+        KindRole,
+        NameRole,
+        SummaryRole,
+        PackageNamesRole,
+        IconNameRole,
+        ComponentRole,
+    };
+    Q_ENUM(Role)
+
+    /**
+     * A query to run on a Pool, e.g. a call to Pool::componentsByCategories().
+     */
+    using PoolQuery = std::function<ComponentBox(const Pool &pool)>;
+
+    explicit ComponentBoxModel(QObject *parent = nullptr);
+    explicit ComponentBoxModel(const ComponentBox &cbox, QObject *parent = nullptr);
+    ~ComponentBoxModel() override;
+
+    /**
+     * \returns the components currently shown by this model.
+     */
+    ComponentBox componentBox() const;
+
+    /**
+     * Show the components of \p cbox, and stop following any pool query.
+     */
+    void setComponentBox(const ComponentBox &cbox);
+
+    /**
+     * Show the result of \p query on \p pool, and run it again whenever
+     * the pool changes.
+     */
+    void setPoolQuery(Pool *pool, const PoolQuery &query);
+
+    /**
+     * Run the current pool query again. Does nothing if the model
+     * is not following a pool query.
+     */
+    Q_INVOKABLE void refresh();
+
+    /**
+     * \returns the component in \p row, or an invalid component if the row does not exist.
+     */
+    Q_INVOKABLE AppStream::Component componentAt(int row) const;
+
+    int count() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+Q_SIGNALS:
+    void countChanged();
+
+private:
+    Q_DISABLE_COPY(ComponentBoxModel);
+    QScopedPointer<ComponentBoxModelPrivate> d;
+};
+
+}
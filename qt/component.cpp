@@ -25,6 +25,7 @@
 #include <QUrl>
 #include <QMap>
 #include <QMultiHash>
+#include <QMutex>
 #include "chelpers.h"
 #include "icon.h"
 #include "screenshot.h"
@@ -85,6 +86,14 @@ public:
             g_object_ref(cpt);
     }
 
+    ComponentData(const ComponentData &other)
+        : QSharedData(other)
+        , cpt(other.cpt)
+        , lastError(other.lastError)
+    {
+        g_object_ref(cpt);
+    }
+
     ~ComponentData()
     {
         g_object_unref(cpt);
@@ -100,8 +109,28 @@ public:
         return cpt;
     }
 
+    QString cachedValue(CachedString &cache, const gchar *cstr) const
+    {
+        QMutexLocker locker(&stringCacheLock);
+        return valueWrap(cache, cstr);
+    }
+
+    void invalidateCache(CachedString &cache)
+    {
+        QMutexLocker locker(&stringCacheLock);
+        cache.clear();
+    }
+
     AsComponent *cpt;
     QString lastError;
+
+    // views call the string getters very often, so we keep their conversions around
+    mutable QMutex stringCacheLock;
+    mutable CachedString idCache;
+    mutable CachedString nameCache;
+    mutable CachedString summaryCache;
+    mutable CachedString descriptionCache;
+    mutable CachedString developerNameCache;
 };
 
 Component::Component()
@@ -168,12 +197,13 @@ void AppStream::Component::setOrigin(const QString &origin)
 
 QString Component::id() const
 {
-    return valueWrap(as_component_get_id(d->cpt));
+    return d->cachedValue(d->idCache, as_component_get_id(d->cpt));
 }
 
 void Component::setId(const QString &id)
 {
     as_component_set_id(d->cpt, qPrintable(id));
+    d->invalidateCache(d->idCache);
 }
 
 QString Component::dataId() const
@@ -220,27 +250,29 @@ void AppStream::Component::setSourcePackageName(const QString &sourcePkg)
 
 QString Component::name() const
 {
-    return valueWrap(as_component_get_name(d->cpt));
+    return d->cachedValue(d->nameCache, as_component_get_name(d->cpt));
 }
 
 void Component::setName(const QString &name, const QString &lang)
 {
     as_component_set_name(d->cpt, qPrintable(name), lang.isEmpty() ? NULL : qPrintable(lang));
+    d->invalidateCache(d->nameCache);
 }
 
 QString Component::summary() const
 {
-    return valueWrap(as_component_get_summary(d->cpt));
+    return d->cachedValue(d->summaryCache, as_component_get_summary(d->cpt));
 }
 
 void Component::setSummary(const QString &summary, const QString &lang)
 {
     as_component_set_summary(d->cpt, qPrintable(summary), lang.isEmpty() ? NULL : qPrintable(lang));
+    d->invalidateCache(d->summaryCache);
 }
 
 QString Component::description() const
 {
-    return valueWrap(as_component_get_description(d->cpt));
+    return d->cachedValue(d->descriptionCache, as_component_get_description(d->cpt));
 }
 
 void Component::setDescription(const QString &description, const QString &lang)
@@ -248,6 +280,7 @@ void Component::setDescription(const QString &description, const QString &lang)
     as_component_set_description(d->cpt,
                                  qPrintable(description),
                                  lang.isEmpty() ? NULL : qPrintable(lang));
+    d->invalidateCache(d->descriptionCache);
 }
 
 AppStream::Launchable AppStream::Component::launchable(AppStream::Launchable::Kind kind) const
@@ -295,7 +328,7 @@ void Component::setProjectGroup(const QString &group)
 
 QString Component::developerName() const
 {
-    return valueWrap(as_component_get_developer_name(d->cpt));
+    return d->cachedValue(d->developerNameCache, as_component_get_developer_name(d->cpt));
 }
 
 void Component::setDeveloperName(const QString &developerName, const QString &lang)
@@ -303,6 +336,7 @@ void Component::setDeveloperName(const QString &developerName, const QString &la
     as_component_set_developer_name(d->cpt,
                                     qPrintable(developerName),
                                     lang.isEmpty() ? NULL : qPrintable(lang));
+    d->invalidateCache(d->developerNameCache);
 }
 
 QStringList Component::compulsoryForDesktops() const
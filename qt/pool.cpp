@@ -22,9 +22,14 @@
 #include "as-pool-private.h"
 #include "pool.h"
 
+#include <functional>
 #include <QStringList>
 #include <QUrl>
 #include <QLoggingCategory>
+#include <QFutureInterface>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThreadPool>
 #include "chelpers.h"
 
 Q_DECLARE_LOGGING_CATEGORY(APPSTREAMQT_POOL)
@@ -32,6 +37,13 @@ Q_LOGGING_CATEGORY(APPSTREAMQT_POOL, "appstreamqt.pool")
 
 using namespace AppStream;
 
+static inline ComponentBox absorbResultToCBox(AsComponentBox *cbox)
+{
+    ComponentBox res(cbox);
+    g_object_unref(cbox);
+    return res;
+}
+
 class AppStream::PoolPrivate
 {
 public:
@@ -39,6 +51,11 @@ public:
     AsPool *pool;
     QString lastError;
 
+    QThreadPool queryThreadPool;
+    QAtomicInt shuttingDown;
+    QMutex searchLock;
+    QFuture<ComponentBox> lastSearch;
+
     PoolPrivate(Pool *q)
         : q(q)
     {
@@ -47,16 +64,37 @@ public:
 
     ~PoolPrivate()
     {
+        // queries that did not start yet are canceled instead of run, but every
+        // runnable still has to finish its future, so we must not drop them
+        shuttingDown.storeRelease(1);
+        queryThreadPool.waitForDone();
         g_object_unref(pool);
     }
-};
 
-static inline ComponentBox absorbResultToCBox(AsComponentBox *cbox)
-{
-    ComponentBox res(cbox);
-    g_object_unref(cbox);
-    return res;
-}
+    QFuture<ComponentBox> runQueryAsync(const std::function<AsComponentBox *(AsPool *)> &query)
+    {
+        QFutureInterface<ComponentBox> iface;
+        iface.reportStarted();
+        QFuture<ComponentBox> future = iface.future();
+
+        AsPool *cpool = AS_POOL(g_object_ref(pool));
+        queryThreadPool.start([this, iface, cpool, query]() mutable {
+            // the query may have been superseded while it was waiting for a thread,
+            // or the pool may be going away
+            if (shuttingDown.loadAcquire())
+                iface.reportCanceled();
+            if (!iface.isCanceled()) {
+                ComponentBox result = absorbResultToCBox(query(cpool));
+                if (!iface.isCanceled())
+                    iface.reportResult(result);
+            }
+            iface.reportFinished();
+            g_object_unref(cpool);
+        });
+
+        return future;
+    }
+};
 
 static void pool_changed_cb(AsPool *cpool, AppStream::Pool *qpool)
 {
@@ -200,6 +238,99 @@ ComponentBox Pool::search(const QString &term) const
     return absorbResultToCBox(as_pool_search(d->pool, qPrintable(term)));
 }
 
+QFuture<ComponentBox> Pool::componentsAsync() const
+{
+    return d->runQueryAsync([](AsPool *pool) {
+        return as_pool_get_components(pool);
+    });
+}
+
+QFuture<ComponentBox> Pool::componentsByIdAsync(const QString &cid) const
+{
+    const QByteArray cidUtf8 = cid.toUtf8();
+    return d->runQueryAsync([cidUtf8](AsPool *pool) {
+        return as_pool_get_components_by_id(pool, cidUtf8.constData());
+    });
+}
+
+QFuture<ComponentBox> Pool::componentsByProvidedAsync(Provided::Kind kind, const QString &item) const
+{
+    const QByteArray itemUtf8 = item.toUtf8();
+    return d->runQueryAsync([kind, itemUtf8](AsPool *pool) {
+        return as_pool_get_components_by_provided_item(pool,
+                                                       static_cast<AsProvidedKind>(kind),
+                                                       itemUtf8.constData());
+    });
+}
+
+QFuture<ComponentBox> Pool::componentsByKindAsync(Component::Kind kind) const
+{
+    return d->runQueryAsync([kind](AsPool *pool) {
+        return as_pool_get_components_by_kind(pool, static_cast<AsComponentKind>(kind));
+    });
+}
+
+QFuture<ComponentBox> Pool::componentsByCategoriesAsync(const QStringList &categories) const
+{
+    QVector<QByteArray> utf8Categories;
+    utf8Categories.reserve(categories.size());
+    for (const QString &category : categories)
+        utf8Categories += category.toUtf8();
+
+    return d->runQueryAsync([utf8Categories](AsPool *pool) {
+        g_autofree gchar **cats_strv = g_new0(gchar *, utf8Categories.size() + 1);
+        for (int i = 0; i < utf8Categories.size(); ++i)
+            cats_strv[i] = (gchar *) utf8Categories[i].constData();
+
+        return as_pool_get_components_by_categories(pool, cats_strv);
+    });
+}
+
+QFuture<ComponentBox> Pool::componentsByLaunchableAsync(Launchable::Kind kind,
+                                                        const QString &value) const
+{
+    const QByteArray valueUtf8 = value.toUtf8();
+    return d->runQueryAsync([kind, valueUtf8](AsPool *pool) {
+        return as_pool_get_components_by_launchable(pool,
+                                                    static_cast<AsLaunchableKind>(kind),
+                                                    valueUtf8.constData());
+    });
+}
+
+QFuture<ComponentBox> Pool::componentsByExtendsAsync(const QString &extendedId) const
+{
+    const QByteArray extendedIdUtf8 = extendedId.toUtf8();
+    return d->runQueryAsync([extendedIdUtf8](AsPool *pool) {
+        return as_pool_get_components_by_extends(pool, extendedIdUtf8.constData());
+    });
+}
+
+QFuture<ComponentBox>
+Pool::componentsByBundleIdAsync(Bundle::Kind kind, const QString &bundleId, bool matchPrefix) const
+{
+    const QByteArray bundleIdUtf8 = bundleId.toUtf8();
+    return d->runQueryAsync([kind, bundleIdUtf8, matchPrefix](AsPool *pool) {
+        return as_pool_get_components_by_bundle_id(pool,
+                                                   static_cast<AsBundleKind>(kind),
+                                                   bundleIdUtf8.constData(),
+                                                   matchPrefix);
+    });
+}
+
+QFuture<ComponentBox> Pool::searchAsync(const QString &term) const
+{
+    const QByteArray termUtf8 = term.toUtf8();
+    QMutexLocker locker(&d->searchLock);
+
+    // a new search term supersedes the previous one
+    d->lastSearch.cancel();
+    d->lastSearch = d->runQueryAsync([termUtf8](AsPool *pool) {
+        return as_pool_search(pool, termUtf8.constData());
+    });
+
+    return d->lastSearch;
+}
+
 void Pool::setLocale(const QString &locale)
 {
     as_pool_set_locale(d->pool, qPrintable(locale));
@@ -25,6 +25,7 @@
 #include <QString>
 #include <QList>
 #include <QStringList>
+#include <QFuture>
 #include "component-box.h"
 #include "metadata.h"
 
@@ -127,6 +128,29 @@ public:
 
     ComponentBox search(const QString &term) const;
 
+    /**
+     * Asynchronous variants of the query functions above.
+     *
+     * The queries run on a thread pool owned by this Pool, and the returned
+     * future delivers a ComponentBox that is ready to use on any thread.
+     * Cancelling a future before its query has started skips the query, and
+     * cancelling it later discards its result.
+     *
+     * A new call to searchAsync() cancels any previous search that has not
+     * finished yet, so only the result for the latest search term is delivered.
+     */
+    QFuture<ComponentBox> componentsAsync() const;
+    QFuture<ComponentBox> componentsByIdAsync(const QString &cid) const;
+    QFuture<ComponentBox> componentsByProvidedAsync(Provided::Kind kind, const QString &item) const;
+    QFuture<ComponentBox> componentsByKindAsync(Component::Kind kind) const;
+    QFuture<ComponentBox> componentsByCategoriesAsync(const QStringList &categories) const;
+    QFuture<ComponentBox> componentsByLaunchableAsync(Launchable::Kind kind,
+                                                      const QString &value) const;
+    QFuture<ComponentBox> componentsByExtendsAsync(const QString &extendedId) const;
+    QFuture<ComponentBox>
+    componentsByBundleIdAsync(Bundle::Kind kind, const QString &bundleId, bool matchPrefix) const;
+    QFuture<ComponentBox> searchAsync(const QString &term) const;
+
     void setLocale(const QString &locale);
 
     Pool::Flags flags() const;
@@ -21,7 +21,9 @@
 #include <QtTest>
 #include <QObject>
 #include <QTemporaryFile>
+#include "appstream.h"
 #include "pool.h"
+#include "component-box-model.h"
 #include "testpaths.h"
 
 class PoolReadTest : public QObject
@@ -30,6 +32,11 @@ class PoolReadTest : public QObject
 private Q_SLOTS:
     void testRead01();
     void testLoadAsync();
+    void testComponentBoxModel();
+    void testQueryAsync();
+    void testComponentStringCache();
+    void benchmarkComponentStrings_data();
+    void benchmarkComponentStrings();
 };
 
 using namespace AppStream;
@@ -114,6 +121,176 @@ void PoolReadTest::testLoadAsync()
     QCOMPARE(cpt.name(), QLatin1String("Neverball"));
 }
 
+void PoolReadTest::testComponentBoxModel()
+{
+    auto pool = createPool();
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    pool->overrideCacheLocations(cacheDir.path(), nullptr);
+
+    ComponentBoxModel model;
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy countSpy(&model, &ComponentBoxModel::countChanged);
+
+    // the query result follows the pool
+    model.setPoolQuery(pool.get(), [](const Pool &p) {
+        return p.components();
+    });
+    QCOMPARE(model.rowCount(), 0);
+
+    QSignalSpy loadedSpy(pool.get(), &Pool::loadFinished);
+    pool->loadAsync();
+    QVERIFY(loadedSpy.wait());
+    QTRY_COMPARE(model.rowCount(), 20);
+    QVERIFY(resetSpy.count() >= 1);
+    QVERIFY(countSpy.count() >= 1);
+
+    const auto roles = model.roleNames();
+    QCOMPARE(roles.value(ComponentBoxModel::NameRole), QByteArray("name"));
+    QCOMPARE(roles.value(ComponentBoxModel::IdRole), QByteArray("id"));
+
+    int neverballRow = -1;
+    for (int i = 0; i < model.rowCount(); i++) {
+        const auto index = model.index(i, 0);
+        if (index.data(ComponentBoxModel::IdRole).toString() == QLatin1String("org.neverball.Neverball"))
+            neverballRow = i;
+    }
+    QVERIFY(neverballRow >= 0);
+
+    const auto index = model.index(neverballRow, 0);
+    QCOMPARE(index.data(Qt::DisplayRole).toString(), QLatin1String("Neverball"));
+    QCOMPARE(index.data(ComponentBoxModel::NameRole).toString(), QLatin1String("Neverball"));
+    QCOMPARE(index.data(ComponentBoxModel::KindRole).value<Component::Kind>(), Component::KindDesktopApp);
+    QCOMPARE(model.componentAt(neverballRow).id(), QLatin1String("org.neverball.Neverball"));
+    QVERIFY(!model.data(model.index(model.rowCount(), 0), ComponentBoxModel::NameRole).isValid());
+
+    // a fixed component box stops following the pool
+    model.setComponentBox(pool->componentsById("org.neverball.Neverball"));
+    QCOMPARE(model.rowCount(), 1);
+    resetSpy.clear();
+    Q_EMIT pool->changed();
+    QCoreApplication::processEvents();
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(model.rowCount(), 1);
+}
+
+void PoolReadTest::testQueryAsync()
+{
+    auto pool = createPool();
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    pool->overrideCacheLocations(cacheDir.path(), nullptr);
+    QVERIFY(pool->load());
+
+    auto future = pool->componentsByIdAsync("org.neverball.Neverball");
+    future.waitForFinished();
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(future.resultCount(), 1);
+    auto cpts = future.result().toList();
+    QCOMPARE(cpts.size(), 1);
+    QCOMPARE(cpts[0].name(), QLatin1String("Neverball"));
+
+    auto kindFuture = pool->componentsByKindAsync(Component::KindDesktopApp);
+    auto allFuture = pool->componentsAsync();
+    QCOMPARE(allFuture.result().size(), 20);
+    QCOMPARE(kindFuture.result().size(), pool->componentsByKind(Component::KindDesktopApp).size());
+
+    // a new search supersedes the previous one
+    auto staleSearch = pool->searchAsync("kig");
+    auto search = pool->searchAsync("neverball");
+    QVERIFY(staleSearch.isCanceled());
+    staleSearch.waitForFinished();
+
+    search.waitForFinished();
+    QVERIFY(!search.isCanceled());
+    QCOMPARE(search.resultCount(), 1);
+    cpts = search.result().toList();
+    QCOMPARE(cpts.size(), 1);
+    QCOMPARE(cpts[0].id(), QLatin1String("org.neverball.Neverball"));
+
+    // results are delivered to watchers as well
+    QFutureWatcher<ComponentBox> watcher;
+    QSignalSpy finishedSpy(&watcher, &QFutureWatcher<ComponentBox>::finished);
+    watcher.setFuture(pool->componentsByCategoriesAsync({QStringLiteral("Game")}));
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(watcher.result().size(), pool->componentsByCategories({QStringLiteral("Game")}).size());
+
+    // destroying the pool must finish all pending futures, including queued ones
+    QList<QFuture<ComponentBox>> pending;
+    for (int i = 0; i < 64; i++)
+        pending.append(pool->componentsAsync());
+    pool.reset();
+    for (auto &f : pending) {
+        f.waitForFinished();
+        QVERIFY(f.isFinished());
+    }
+}
+
+void PoolReadTest::testComponentStringCache()
+{
+    Component cpt;
+    cpt.setId(QStringLiteral("org.example.CacheTest"));
+    cpt.setName(QStringLiteral("Name 0"));
+    const Component other(cpt.asComponent());
+    QCOMPARE(cpt.name(), QStringLiteral("Name 0"));
+    QCOMPARE(other.name(), QStringLiteral("Name 0"));
+
+    // Values set on the C side must be visible through all wrappers, even if
+    // the allocator places the new string at the address of the old one,
+    // which is likely for strings of the same length.
+    for (int i = 1; i < 8; i++) {
+        const QString name = QStringLiteral("Name %1").arg(i);
+        as_component_set_name(cpt.asComponent(), name.toUtf8().constData(), nullptr);
+        QCOMPARE(cpt.name(), name);
+        QCOMPARE(other.name(), name);
+    }
+
+    as_component_set_summary(cpt.asComponent(), "A summary", nullptr);
+    QCOMPARE(other.summary(), QStringLiteral("A summary"));
+    as_component_set_summary(cpt.asComponent(), "B summary", nullptr);
+    QCOMPARE(other.summary(), QStringLiteral("B summary"));
+}
+
+void PoolReadTest::benchmarkComponentStrings_data()
+{
+    QTest::addColumn<bool>("reuseWrapper");
+
+    QTest::newRow("fresh wrapper per access") << false;
+    QTest::newRow("reused wrapper") << true;
+}
+
+void PoolReadTest::benchmarkComponentStrings()
+{
+    QFETCH(bool, reuseWrapper);
+
+    auto pool = createPool();
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    pool->overrideCacheLocations(cacheDir.path(), nullptr);
+    QVERIFY(pool->load());
+
+    // emulate a view repainting its delegates while scrolling
+    const auto cpts = pool->components().toList();
+    QCOMPARE(cpts.size(), 20);
+    qsizetype chars = 0;
+    QBENCHMARK {
+        for (const auto &listCpt : cpts) {
+            const Component cpt = reuseWrapper ? listCpt : Component(listCpt.asComponent());
+            chars += cpt.id().size() + cpt.name().size() + cpt.summary().size()
+                + cpt.description().size();
+        }
+    }
+    QVERIFY(chars > 0);
+
+    // the cached strings follow changes made through the wrapper
+    Component cpt = cpts.first();
+    const QString oldName = cpt.name();
+    cpt.setName(oldName + QStringLiteral(" (renamed)"));
+    QCOMPARE(cpt.name(), oldName + QStringLiteral(" (renamed)"));
+}
+
 QTEST_MAIN(PoolReadTest)
 
 #include "asqt-pool-test.moc"
@@ -38,6 +38,7 @@
 
 #include "as-macros.h"
 #include "as-utils-private.h"
+#include "as-component-private.h"
 
 typedef struct {
 	AsComponentBoxFlags flags;
@@ -351,3 +352,46 @@ as_component_box_sort_by_score (AsComponentBox *cbox)
 {
 	as_sort_components_by_score (cbox->cpts);
 }
+
+/**
+ * as_component_box_get_system_compatibility_scores:
+ * @cbox: An instance of #AsComponentBox.
+ * @sysinfo: (nullable): an #AsSystemInfo to use for system information.
+ * @is_template: if %TRUE, treat system info as neutral template, ignoring any peripheral devices or kernel relations.
+ *
+ * Compute the system compatibility score of every component in this box,
+ * the same way as_component_get_system_compatibility_score() does.
+ * All components are checked against the same system information, and relations
+ * that several components share are only evaluated once.
+ *
+ * Returns: (transfer full) (element-type gint): the scores, in the order of the components in @cbox.
+ *
+ * Since: 1.0.0
+ */
+GArray *
+as_component_box_get_system_compatibility_scores (AsComponentBox *cbox,
+						  AsSystemInfo *sysinfo,
+						  gboolean is_template)
+{
+	g_autoptr(AsSystemInfo) shared_sysinfo = NULL;
+	g_autoptr(GHashTable) rcr_cache = NULL;
+	GArray *scores;
+	g_return_val_if_fail (G_TYPE_CHECK_INSTANCE_TYPE (cbox, AS_TYPE_COMPONENT_BOX), NULL);
+	g_return_val_if_fail (sysinfo == NULL || AS_IS_SYSTEM_INFO (sysinfo), NULL);
+
+	shared_sysinfo = (sysinfo == NULL) ? as_system_info_new () : g_object_ref (sysinfo);
+	rcr_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+	scores = g_array_sized_new (FALSE, FALSE, sizeof (gint), cbox->cpts->len);
+	for (guint i = 0; i < cbox->cpts->len; i++) {
+		gint score = as_component_get_system_compatibility_score_cached (
+		    AS_COMPONENT (g_ptr_array_index (cbox->cpts, i)),
+		    shared_sysinfo,
+		    is_template,
+		    rcr_cache,
+		    NULL);
+		g_array_append_val (scores, score);
+	}
+
+	return scores;
+}
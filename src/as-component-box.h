@@ -87,4 +87,8 @@ gboolean	    as_component_box_add (AsComponentBox *cbox, AsComponent *cpt, GErro
 void		    as_component_box_sort (AsComponentBox *cbox);
 void		    as_component_box_sort_by_score (AsComponentBox *cbox);
 
+GArray *as_component_box_get_system_compatibility_scores (AsComponentBox *cbox,
+							  AsSystemInfo	 *sysinfo,
+							  gboolean	  is_template);
+
 G_END_DECLS
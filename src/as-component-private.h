@@ -95,6 +95,12 @@ GPtrArray   *as_component_generate_tokens_for (AsComponent *cpt, AsSearchTokenMa
 
 void	     as_component_set_ignored (AsComponent *cpt, gboolean ignore);
 
+gint	     as_component_get_system_compatibility_score_cached (AsComponent  *cpt,
+								 AsSystemInfo *sysinfo,
+								 gboolean      is_template,
+								 GHashTable   *rcr_cache,
+								 GPtrArray   **results);
+
 AsOriginKind as_component_get_origin_kind (AsComponent *cpt);
 void	     as_component_set_origin_kind (AsComponent *cpt, AsOriginKind okind);
 
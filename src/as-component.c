@@ -3718,8 +3718,30 @@ as_component_make_implicit_relations_explicit (AsComponent *cpt)
 	g_clear_pointer (&rel, g_object_unref);
 }
 
+/**
+ * as_component_copy_relation_check_result:
+ *
+ * Create a copy of a cached check result for an equivalent relation.
+ */
+static AsRelationCheckResult *
+as_component_copy_relation_check_result (AsRelationCheckResult *rcr, AsRelation *relation)
+{
+	AsRelationCheckResult *copy = as_relation_check_result_new ();
+	const gchar *message = as_relation_check_result_get_message (rcr);
+
+	as_relation_check_result_set_relation (copy, relation);
+	as_relation_check_result_set_status (copy, as_relation_check_result_get_status (rcr));
+	as_relation_check_result_set_error_code (copy,
+						 as_relation_check_result_get_error_code (rcr));
+	if (message != NULL)
+		as_relation_check_result_set_message (copy, "%s", message);
+
+	return copy;
+}
+
 /**
  * as_component_check_relations_internal:
+ * @rcr_cache: (nullable): results of earlier checks, keyed by relation cache key.
  */
 static void
 as_component_check_relations_internal (AsComponent *cpt,
@@ -3727,12 +3749,14 @@ as_component_check_relations_internal (AsComponent *cpt,
 				       AsPool *pool,
 				       GPtrArray *relations,
 				       gboolean is_template,
+				       GHashTable *rcr_cache,
 				       GPtrArray *result)
 {
 	for (guint i = 0; i < relations->len; i++) {
 		AsRelation *relation = AS_RELATION (g_ptr_array_index (relations, i));
 		g_autoptr(AsRelationCheckResult) rcr = NULL;
 		g_autoptr(GError) tmp_error = NULL;
+		g_autofree gchar *cache_key = NULL;
 
 		if (is_template) {
 			/* we ignore anything that isn't in a template system info */
@@ -3747,6 +3771,19 @@ as_component_check_relations_internal (AsComponent *cpt,
 				continue;
 		}
 
+		if (rcr_cache != NULL) {
+			AsRelationCheckResult *cached_rcr;
+
+			cache_key = as_relation_get_cache_key (relation);
+			cached_rcr = g_hash_table_lookup (rcr_cache, cache_key);
+			if (cached_rcr != NULL) {
+				g_ptr_array_add (result,
+						 as_component_copy_relation_check_result (cached_rcr,
+											  relation));
+				continue;
+			}
+		}
+
 		rcr = as_relation_is_satisfied (relation, sysinfo, pool, &tmp_error);
 		if (rcr == NULL) {
 			rcr = as_relation_check_result_new ();
@@ -3757,6 +3794,8 @@ as_component_check_relations_internal (AsComponent *cpt,
 			as_relation_check_result_set_message (rcr, "%s", tmp_error->message);
 		}
 
+		if (rcr_cache != NULL)
+			g_hash_table_insert (rcr_cache, g_steal_pointer (&cache_key), g_object_ref (rcr));
 		g_ptr_array_add (result, g_steal_pointer (&rcr));
 	}
 }
@@ -3793,6 +3832,7 @@ as_component_check_relations (AsComponent *cpt,
 						       pool,
 						       priv->requires,
 						       FALSE,
+						       NULL,
 						       result);
 	else if (rel_kind == AS_RELATION_KIND_RECOMMENDS)
 		as_component_check_relations_internal (cpt,
@@ -3800,6 +3840,7 @@ as_component_check_relations (AsComponent *cpt,
 						       pool,
 						       priv->recommends,
 						       FALSE,
+						       NULL,
 						       result);
 	else if (rel_kind == AS_RELATION_KIND_SUPPORTS)
 		as_component_check_relations_internal (cpt,
@@ -3807,6 +3848,7 @@ as_component_check_relations (AsComponent *cpt,
 						       pool,
 						       priv->supports,
 						       FALSE,
+						       NULL,
 						       result);
 
 	return result;
@@ -3831,13 +3873,40 @@ as_component_get_system_compatibility_score (AsComponent *cpt,
 					     AsSystemInfo *sysinfo,
 					     gboolean is_template,
 					     GPtrArray **results)
+{
+	g_return_val_if_fail (sysinfo != NULL, 0);
+	return as_component_get_system_compatibility_score_cached (cpt,
+								   sysinfo,
+								   is_template,
+								   NULL,
+								   results);
+}
+
+/**
+ * as_component_get_system_compatibility_score_cached:
+ * @cpt: a #AsComponent instance.
+ * @sysinfo: an #AsSystemInfo to use for system information.
+ * @is_template: if %TRUE, treat system info as neutral template.
+ * @rcr_cache: (nullable): a table to share check results of identical relations in.
+ * @results: (out callee-allocates) (optional): Receive the resulting check results
+ *
+ * Same as as_component_get_system_compatibility_score(), but reuses the results
+ * of relations that were already checked for other components with the same @rcr_cache.
+ * The cache must only be shared between checks against the same @sysinfo and @is_template.
+ *
+ * Returns: a compatibility score between 0 and 100
+ */
+gint
+as_component_get_system_compatibility_score_cached (AsComponent *cpt,
+						    AsSystemInfo *sysinfo,
+						    gboolean is_template,
+						    GHashTable *rcr_cache,
+						    GPtrArray **results)
 {
 	AsComponentPrivate *priv = GET_PRIVATE (cpt);
 	gint score = 0;
 	g_autoptr(GPtrArray) rc_results = g_ptr_array_new_with_free_func (g_object_unref);
 
-	g_return_val_if_fail (sysinfo != NULL, 0);
-
 	/* compatibility for older metadata */
 	as_component_make_implicit_relations_explicit (cpt);
 
@@ -3846,18 +3915,21 @@ as_component_get_system_compatibility_score (AsComponent *cpt,
 					       NULL,
 					       priv->requires,
 					       is_template,
+					       rcr_cache,
 					       rc_results);
 	as_component_check_relations_internal (cpt,
 					       sysinfo,
 					       NULL,
 					       priv->recommends,
 					       is_template,
+					       rcr_cache,
 					       rc_results);
 	as_component_check_relations_internal (cpt,
 					       sysinfo,
 					       NULL,
 					       priv->supports,
 					       is_template,
+					       rcr_cache,
 					       rc_results);
 
 	score = as_relation_check_results_get_compatibility_score (rc_results);
@@ -4710,7 +4782,9 @@ as_component_load_from_xml (AsComponent *cpt, AsContext *ctx, xmlNode *node, GEr
 				value = as_xml_get_node_value (sn);
 				as_component_add_tag (cpt, ns, value);
 			}
-		} else if (as_context_get_internal_mode (ctx)) {
+		} else if (as_context_get_internal_mode (ctx) &&
+			   (tag_id == AS_TAG_INTERNAL_SCOPE || tag_id == AS_TAG_INTERNAL_ORIGIN ||
+			    tag_id == AS_TAG_INTERNAL_BRANCH)) {
 			g_autofree gchar *content = as_xml_get_node_value (iter);
 			/* internal information */
 
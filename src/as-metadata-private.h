@@ -0,0 +1,47 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2012-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AS_METADATA_PRIVATE_H
+#define __AS_METADATA_PRIVATE_H
+
+#include <gio/gio.h>
+#include "as-metadata.h"
+#include "as-macros-private.h"
+
+AS_BEGIN_PRIVATE_DECLS
+
+AS_INTERNAL_VISIBLE
+gboolean as_metadata_convert_catalog_stream (AsMetadata	*metad,
+					     GInputStream  *istream,
+					     AsFormatKind   in_format,
+					     const gchar   *filename,
+					     GOutputStream *ostream,
+					     AsFormatKind   out_format,
+					     guint	    n_threads,
+					     GError	  **error);
+
+AS_INTERNAL_VISIBLE
+gboolean as_metadata_get_internal_mode (AsMetadata *metad);
+AS_INTERNAL_VISIBLE
+void	 as_metadata_set_internal_mode (AsMetadata *metad, gboolean enabled);
+
+AS_END_PRIVATE_DECLS
+
+#endif /* __AS_METADATA_PRIVATE_H */
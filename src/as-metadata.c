@@ -35,8 +35,10 @@
 #include <config.h>
 #include <glib.h>
 #include <string.h>
+#include <libxml/xmlreader.h>
 
 #include "as-metadata.h"
+#include "as-metadata-private.h"
 
 #include "as-utils.h"
 #include "as-utils-private.h"
@@ -60,6 +62,7 @@ typedef struct {
 
 	gboolean update_existing;
 	gboolean write_header;
+	gboolean internal_mode;
 	AsParseFlags parse_flags;
 
 	GPtrArray *cpts;     /* of AsComponent */
@@ -169,6 +172,7 @@ as_metadata_new_context (AsMetadata *metad, AsFormatStyle style, const gchar *fn
 
 	as_context_set_style (context, style);
 	as_context_set_filename (context, fname);
+	as_context_set_internal_mode (context, priv->internal_mode);
 
 	return context;
 }
@@ -187,17 +191,14 @@ as_metadata_clear_components (AsMetadata *metad)
 }
 
 /**
- * as_metadata_xml_parse_components_node:
+ * as_metadata_xml_parse_catalog_root_props:
+ *
+ * Read the catalog-wide properties from the root node of a catalog XML file.
  */
 static void
-as_metadata_xml_parse_components_node (AsMetadata *metad,
-				       AsContext *context,
-				       xmlNode *node,
-				       GError **error)
+as_metadata_xml_parse_catalog_root_props (AsMetadata *metad, AsContext *context, xmlNode *node)
 {
 	AsMetadataPrivate *priv = GET_PRIVATE (metad);
-	xmlNode *iter;
-	GError *tmp_error = NULL;
 	gchar *priority_str;
 	gchar *tmp;
 
@@ -229,6 +230,22 @@ as_metadata_xml_parse_components_node (AsMetadata *metad,
 		as_context_set_priority (context, priority);
 	}
 	g_free (priority_str);
+}
+
+/**
+ * as_metadata_xml_parse_components_node:
+ */
+static void
+as_metadata_xml_parse_components_node (AsMetadata *metad,
+				       AsContext *context,
+				       xmlNode *node,
+				       GError **error)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (metad);
+	xmlNode *iter;
+	GError *tmp_error = NULL;
+
+	as_metadata_xml_parse_catalog_root_props (metad, context, node);
 
 	for (iter = node->children; iter != NULL; iter = iter->next) {
 		g_autoptr(AsComponent) cpt = NULL;
@@ -250,6 +267,90 @@ as_metadata_xml_parse_components_node (AsMetadata *metad,
 	}
 }
 
+/**
+ * as_metadata_yaml_parse_header:
+ * @metad: an instance of #AsMetadata.
+ * @context: an #AsContext
+ * @root: the first YAML document of a catalog file
+ * @header_found: (out): Set to %TRUE if @root is a DEP-11 header
+ * @error: a #GError
+ *
+ * Read the catalog-wide properties from a DEP-11 header document.
+ *
+ * Returns: %FALSE if the header was invalid.
+ */
+static gboolean
+as_metadata_yaml_parse_header (AsMetadata *metad,
+			       AsContext *context,
+			       GNode *root,
+			       gboolean *header_found,
+			       GError **error)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (metad);
+
+	*header_found = FALSE;
+	for (GNode *n = root->children; n != NULL; n = n->next) {
+		const gchar *key;
+		const gchar *value;
+
+		if ((n->data == NULL) || (n->children == NULL)) {
+			g_set_error_literal (error,
+					     AS_METADATA_ERROR,
+					     AS_METADATA_ERROR_FAILED,
+					     "Invalid DEP-11 file found: Header invalid");
+			return FALSE;
+		}
+
+		key = as_yaml_node_get_key (n);
+		value = as_yaml_node_get_value (n);
+
+		if (g_strcmp0 (key, "File") == 0) {
+			if (g_strcmp0 (value, "DEP-11") != 0) {
+				g_set_error_literal (error,
+						     AS_METADATA_ERROR,
+						     AS_METADATA_ERROR_FAILED,
+						     "Invalid DEP-11 file found: Header invalid");
+				return FALSE;
+			}
+			*header_found = TRUE;
+		}
+
+		if (!*header_found)
+			break;
+
+		if (g_strcmp0 (key, "Origin") == 0) {
+			if (value == NULL) {
+				g_set_error_literal (error,
+						     AS_METADATA_ERROR,
+						     AS_METADATA_ERROR_FAILED,
+						     "Invalid DEP-11 file found: No origin set in header.");
+				return FALSE;
+			}
+			as_context_set_origin (context, value);
+			as_metadata_set_origin (metad, value);
+		} else if (g_strcmp0 (key, "Priority") == 0) {
+			if (value != NULL) {
+				gint priority = g_ascii_strtoll (value, NULL, 10);
+				as_context_set_priority (context, priority);
+			}
+		} else if (g_strcmp0 (key, "MediaBaseUrl") == 0) {
+			if (value != NULL &&
+			    !as_flags_contains (priv->parse_flags,
+						AS_PARSE_FLAG_IGNORE_MEDIABASEURL)) {
+				as_context_set_media_baseurl (context, value);
+				as_metadata_set_media_baseurl (metad, value);
+			}
+		} else if (g_strcmp0 (key, "Architecture") == 0) {
+			if (value != NULL) {
+				as_context_set_architecture (context, value);
+				as_metadata_set_architecture (metad, value);
+			}
+		}
+	}
+
+	return TRUE;
+}
+
 /**
  * as_metadata_yaml_parse_catalog_doc:
  * @metad: an instance of #AsMetadata.
@@ -303,7 +404,6 @@ as_metadata_yaml_parse_catalog_doc (AsMetadata *metad,
 		}
 
 		if (event.type == YAML_DOCUMENT_START_EVENT) {
-			GNode *n;
 			gboolean header_found = FALSE;
 			GError *tmp_error = NULL;
 			g_autoptr(GNode) root = NULL;
@@ -321,84 +421,19 @@ as_metadata_yaml_parse_catalog_doc (AsMetadata *metad,
 			}
 
 			if (header) {
-				for (n = root->children; n != NULL; n = n->next) {
-					const gchar *key;
-					const gchar *value;
-
-					if ((n->data == NULL) || (n->children == NULL)) {
-						parse = FALSE;
-						ret = FALSE;
-						g_set_error_literal (
-						    error,
-						    AS_METADATA_ERROR,
-						    AS_METADATA_ERROR_FAILED,
-						    "Invalid DEP-11 file found: Header invalid");
-						break;
-					}
-
-					key = as_yaml_node_get_key (n);
-					value = as_yaml_node_get_value (n);
-
-					if (g_strcmp0 (key, "File") == 0) {
-						if (g_strcmp0 (value, "DEP-11") != 0) {
-							parse = FALSE;
-							ret = FALSE;
-							g_set_error_literal (
-							    error,
-							    AS_METADATA_ERROR,
-							    AS_METADATA_ERROR_FAILED,
-							    "Invalid DEP-11 file found: Header "
-							    "invalid");
-						}
-						header_found = TRUE;
-					}
-
-					if (!header_found)
-						break;
-
-					if (g_strcmp0 (key, "Origin") == 0) {
-						if (value != NULL) {
-							as_context_set_origin (context, value);
-							as_metadata_set_origin (metad, value);
-						} else {
-							parse = FALSE;
-							ret = FALSE;
-							g_set_error_literal (
-							    error,
-							    AS_METADATA_ERROR,
-							    AS_METADATA_ERROR_FAILED,
-							    "Invalid DEP-11 file found: No origin "
-							    "set in header.");
-						}
-					} else if (g_strcmp0 (key, "Priority") == 0) {
-						if (value != NULL) {
-							gint priority = g_ascii_strtoll (value,
-											 NULL,
-											 10);
-							as_context_set_priority (context, priority);
-						}
-					} else if (g_strcmp0 (key, "MediaBaseUrl") == 0) {
-						if (value != NULL &&
-						    !as_flags_contains (
-							priv->parse_flags,
-							AS_PARSE_FLAG_IGNORE_MEDIABASEURL)) {
-							as_context_set_media_baseurl (context,
-										      value);
-							as_metadata_set_media_baseurl (metad,
-										       value);
-						}
-					} else if (g_strcmp0 (key, "Architecture") == 0) {
-						if (value != NULL) {
-							as_context_set_architecture (context,
-										     value);
-							as_metadata_set_architecture (metad, value);
-						}
-					}
+				if (!as_metadata_yaml_parse_header (metad,
+								    context,
+								    root,
+								    &header_found,
+								    &tmp_error)) {
+					g_propagate_error (error, tmp_error);
+					parse = FALSE;
+					ret = FALSE;
 				}
 			}
 			header = FALSE;
 
-			if (!header_found) {
+			if (ret && !header_found) {
 				AsComponent *cpt = as_component_new ();
 				if (as_component_load_from_yaml (cpt, context, root, NULL)) {
 					/* add found component to the results set */
@@ -1166,14 +1201,12 @@ as_metadata_component_to_metainfo (AsMetadata *metad, AsFormatKind format, GErro
 }
 
 /**
- * as_metadata_xml_serialize_to_catalog_with_rootnode:
+ * as_metadata_xml_new_catalog_root:
  *
- * Returns: Valid catalog XML metadata.
+ * Returns: The root node of a catalog XML document, without any components.
  */
-static gchar *
-as_metadata_xml_serialize_to_catalog_with_rootnode (AsMetadata *metad,
-						    AsContext *context,
-						    GPtrArray *cpts)
+static xmlNode *
+as_metadata_xml_new_catalog_root (AsMetadata *metad, AsContext *context)
 {
 	AsMetadataPrivate *priv = GET_PRIVATE (metad);
 	xmlNode *root;
@@ -1189,6 +1222,22 @@ as_metadata_xml_serialize_to_catalog_with_rootnode (AsMetadata *metad,
 				      "media_baseurl",
 				      as_context_get_media_baseurl (context));
 
+	return root;
+}
+
+/**
+ * as_metadata_xml_serialize_to_catalog_with_rootnode:
+ *
+ * Returns: Valid catalog XML metadata.
+ */
+static gchar *
+as_metadata_xml_serialize_to_catalog_with_rootnode (AsMetadata *metad,
+						    AsContext *context,
+						    GPtrArray *cpts)
+{
+	xmlNode *root;
+
+	root = as_metadata_xml_new_catalog_root (metad, context);
 	for (guint i = 0; i < cpts->len; i++) {
 		xmlNode *node;
 		AsComponent *cpt = AS_COMPONENT (g_ptr_array_index (cpts, i));
@@ -1300,6 +1349,21 @@ as_yamldata_write_handler (void *ptr, unsigned char *buffer, size_t size)
 	return 1;
 }
 
+/**
+ * as_yamldata_emitter_init:
+ *
+ * Set up a YAML emitter for catalog data that writes to @out_data.
+ */
+static void
+as_yamldata_emitter_init (yaml_emitter_t *emitter, GString *out_data)
+{
+	yaml_emitter_initialize (emitter);
+	yaml_emitter_set_indent (emitter, 2);
+	yaml_emitter_set_unicode (emitter, TRUE);
+	yaml_emitter_set_width (emitter, 120);
+	yaml_emitter_set_output (emitter, as_yamldata_write_handler, out_data);
+}
+
 /**
  * as_metadata_yaml_serialize_to_catalog:
  */
@@ -1320,14 +1384,9 @@ as_metadata_yaml_serialize_to_catalog (AsMetadata *metad,
 	if (cpts->len == 0)
 		return NULL;
 
-	yaml_emitter_initialize (&emitter);
-	yaml_emitter_set_indent (&emitter, 2);
-	yaml_emitter_set_unicode (&emitter, TRUE);
-	yaml_emitter_set_width (&emitter, 120);
-
 	/* create a GString to receive the output the emitter generates */
 	out_data = g_string_new ("");
-	yaml_emitter_set_output (&emitter, as_yamldata_write_handler, out_data);
+	as_yamldata_emitter_init (&emitter, out_data);
 
 	/* emit start event */
 	yaml_stream_start_event_initialize (&event, YAML_UTF8_ENCODING);
@@ -1422,6 +1481,652 @@ as_metadata_components_to_catalog (AsMetadata *metad, AsFormatKind format, GErro
 	}
 }
 
+/* number of components that are handed to the worker threads at once */
+#define AS_CATALOG_STREAM_BATCH_SIZE 64
+
+typedef struct _AsCatalogStreamBatch AsCatalogStreamBatch;
+
+typedef struct {
+	AsCatalogStreamBatch *batch;
+	xmlDoc *xml_doc;
+	GNode *yaml_root;
+
+	gboolean loaded;
+	gchar *data;
+	GError *error;
+} AsCatalogStreamItem;
+
+struct _AsCatalogStreamBatch {
+	GPtrArray *items; /* of AsCatalogStreamItem */
+	guint n_pending;
+	GMutex mutex;
+	GCond cond;
+};
+
+typedef struct {
+	AsMetadata *metad;
+	AsFormatKind out_format;
+	AsContext *parse_ctx;
+	AsContext *ser_ctx;
+	GThreadPool *pool;
+	GInputStream *istream;
+	GOutputStream *ostream;
+	GError *read_error;
+
+	gboolean have_cpts;
+	gboolean root_open;
+	AsCatalogStreamBatch *batch;   /* being filled by the reader */
+	AsCatalogStreamBatch *running; /* being processed by the workers */
+} AsCatalogStream;
+
+static void
+as_catalog_stream_yaml_node_free (GNode *root)
+{
+	g_node_traverse (root, G_IN_ORDER, G_TRAVERSE_ALL, -1, as_yaml_free_node, NULL);
+	g_node_destroy (root);
+}
+
+static void
+as_catalog_stream_item_free (AsCatalogStreamItem *item)
+{
+	if (item->xml_doc != NULL)
+		xmlFreeDoc (item->xml_doc);
+	if (item->yaml_root != NULL)
+		as_catalog_stream_yaml_node_free (item->yaml_root);
+	g_free (item->data);
+	g_clear_error (&item->error);
+	g_free (item);
+}
+
+static AsCatalogStreamBatch *
+as_catalog_stream_batch_new (void)
+{
+	AsCatalogStreamBatch *batch = g_new0 (AsCatalogStreamBatch, 1);
+
+	batch->items = g_ptr_array_new_with_free_func ((GDestroyNotify) as_catalog_stream_item_free);
+	g_mutex_init (&batch->mutex);
+	g_cond_init (&batch->cond);
+	return batch;
+}
+
+static void
+as_catalog_stream_batch_free (AsCatalogStreamBatch *batch)
+{
+	if (batch == NULL)
+		return;
+	g_ptr_array_unref (batch->items);
+	g_mutex_clear (&batch->mutex);
+	g_cond_clear (&batch->cond);
+	g_free (batch);
+}
+
+/**
+ * as_catalog_stream_xml_serialize:
+ *
+ * Serialize a component the same way a complete catalog XML document
+ * would contain it.
+ */
+static gchar *
+as_catalog_stream_xml_serialize (AsCatalogStream *cs, AsComponent *cpt)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (cs->metad);
+	xmlNode *node;
+	xmlDoc *doc;
+	xmlBufferPtr buf;
+	gchar *data;
+
+	node = as_component_to_xml_node (cpt, cs->ser_ctx, NULL);
+	if (node == NULL)
+		return NULL;
+
+	doc = xmlNewDoc ((xmlChar *) NULL);
+	xmlDocSetRootElement (doc, node);
+	buf = xmlBufferCreate ();
+	if (priv->write_header) {
+		/* serialize at the nesting level of the root node's children, and
+		 * with the encoding of a complete document, so non-ASCII attribute
+		 * values are not turned into character references */
+		doc->encoding = xmlStrdup ((const xmlChar *) "utf-8");
+		xmlNodeDump (buf, doc, node, 1, 1);
+		data = g_strconcat ("  ", (const gchar *) xmlBufferContent (buf), "\n", NULL);
+	} else {
+		xmlSaveCtxtPtr sctx;
+
+		sctx = xmlSaveToBuffer (buf, "utf-8", XML_SAVE_FORMAT | XML_SAVE_NO_DECL);
+		xmlSaveDoc (sctx, doc);
+		xmlSaveClose (sctx);
+		data = g_strdup ((const gchar *) xmlBufferContent (buf));
+	}
+
+	xmlBufferFree (buf);
+	xmlFreeDoc (doc);
+	return data;
+}
+
+/**
+ * as_catalog_stream_xml_root_start:
+ *
+ * Returns: The XML declaration and start tag of the catalog root node.
+ */
+static gchar *
+as_catalog_stream_xml_root_start (xmlNode *root)
+{
+	xmlDoc *doc;
+	xmlBufferPtr buf;
+	gchar *data;
+
+	doc = xmlNewDoc ((xmlChar *) NULL);
+	doc->encoding = xmlStrdup ((const xmlChar *) "utf-8");
+	buf = xmlBufferCreate ();
+	xmlBufferWriteChar (buf, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<");
+	xmlBufferWriteCHAR (buf, root->name);
+	for (xmlAttr *attr = root->properties; attr != NULL; attr = attr->next) {
+		xmlChar *value = xmlNodeGetContent ((xmlNode *) attr);
+
+		xmlBufferWriteChar (buf, " ");
+		xmlBufferWriteCHAR (buf, attr->name);
+		xmlBufferWriteChar (buf, "=\"");
+		xmlAttrSerializeTxtContent (buf, doc, attr, value);
+		xmlBufferWriteChar (buf, "\"");
+		xmlFree (value);
+	}
+	xmlBufferWriteChar (buf, ">\n");
+
+	data = g_strdup ((const gchar *) xmlBufferContent (buf));
+	xmlBufferFree (buf);
+	xmlFreeDoc (doc);
+	return data;
+}
+
+/**
+ * as_catalog_stream_yaml_serialize:
+ * @cpt: (nullable): The component to serialize, or %NULL to serialize the DEP-11 header.
+ *
+ * Serialize a single YAML document. The documents of a catalog YAML file are
+ * independent of each other, so their concatenation equals the output of a
+ * single emitter.
+ */
+static gchar *
+as_catalog_stream_yaml_serialize (AsCatalogStream *cs, AsComponent *cpt)
+{
+	yaml_emitter_t emitter;
+	yaml_event_t event;
+	GString *out_data = g_string_new ("");
+
+	as_yamldata_emitter_init (&emitter, out_data);
+	yaml_stream_start_event_initialize (&event, YAML_UTF8_ENCODING);
+	yaml_emitter_emit (&emitter, &event);
+
+	if (cpt == NULL)
+		as_yamldata_write_header (cs->ser_ctx, &emitter);
+	else
+		as_component_emit_yaml (cpt, cs->ser_ctx, &emitter);
+
+	yaml_stream_end_event_initialize (&event);
+	yaml_emitter_emit (&emitter, &event);
+	yaml_emitter_flush (&emitter);
+	yaml_emitter_delete (&emitter);
+
+	return g_string_free (out_data, FALSE);
+}
+
+/**
+ * as_catalog_stream_process_item:
+ *
+ * Load a component from its parsed document and serialize it in the output format.
+ * This function may be called from multiple threads at once.
+ */
+static void
+as_catalog_stream_process_item (AsCatalogStreamItem *item, AsCatalogStream *cs)
+{
+	g_autoptr(AsComponent) cpt = as_component_new ();
+
+	if (item->xml_doc != NULL) {
+		item->loaded = as_component_load_from_xml (cpt,
+							   cs->parse_ctx,
+							   xmlDocGetRootElement (item->xml_doc),
+							   &item->error);
+		xmlFreeDoc (g_steal_pointer (&item->xml_doc));
+	} else {
+		item->loaded = as_component_load_from_yaml (cpt,
+							    cs->parse_ctx,
+							    item->yaml_root,
+							    NULL);
+		if (!item->loaded)
+			g_set_error_literal (&item->error,
+					     AS_METADATA_ERROR,
+					     AS_METADATA_ERROR_PARSE,
+					     "Invalid DEP-11 file found: Could not read data for "
+					     "component.");
+		as_catalog_stream_yaml_node_free (g_steal_pointer (&item->yaml_root));
+	}
+	if (!item->loaded)
+		return;
+
+	as_component_set_origin_kind (cpt, AS_ORIGIN_KIND_CATALOG);
+	if (cs->out_format == AS_FORMAT_KIND_XML)
+		item->data = as_catalog_stream_xml_serialize (cs, cpt);
+	else
+		item->data = as_catalog_stream_yaml_serialize (cs, cpt);
+}
+
+static void
+as_catalog_stream_worker_cb (gpointer data, gpointer user_data)
+{
+	AsCatalogStreamItem *item = (AsCatalogStreamItem *) data;
+	AsCatalogStreamBatch *batch = item->batch;
+
+	as_catalog_stream_process_item (item, (AsCatalogStream *) user_data);
+
+	g_mutex_lock (&batch->mutex);
+	batch->n_pending--;
+	if (batch->n_pending == 0)
+		g_cond_signal (&batch->cond);
+	g_mutex_unlock (&batch->mutex);
+}
+
+static gboolean
+as_catalog_stream_write (AsCatalogStream *cs, const gchar *data, GError **error)
+{
+	return g_output_stream_write_all (cs->ostream, data, strlen (data), NULL, NULL, error);
+}
+
+/**
+ * as_catalog_stream_write_batch:
+ *
+ * Wait for a batch to be processed, and write its components in input order.
+ */
+static gboolean
+as_catalog_stream_write_batch (AsCatalogStream *cs, AsCatalogStreamBatch *batch, GError **error)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (cs->metad);
+
+	g_mutex_lock (&batch->mutex);
+	while (batch->n_pending > 0)
+		g_cond_wait (&batch->cond, &batch->mutex);
+	g_mutex_unlock (&batch->mutex);
+
+	for (guint i = 0; i < batch->items->len; i++) {
+		AsCatalogStreamItem *item = g_ptr_array_index (batch->items, i);
+
+		if (item->error != NULL) {
+			g_propagate_error (error, g_steal_pointer (&item->error));
+			return FALSE;
+		}
+		if (!item->loaded)
+			continue;
+
+		if (!cs->have_cpts) {
+			cs->have_cpts = TRUE;
+			if (cs->out_format == AS_FORMAT_KIND_YAML && priv->write_header) {
+				g_autofree gchar *header = as_catalog_stream_yaml_serialize (cs, NULL);
+				if (!as_catalog_stream_write (cs, header, error))
+					return FALSE;
+			}
+		}
+		if (item->data == NULL)
+			continue;
+
+		if (cs->out_format == AS_FORMAT_KIND_XML && priv->write_header && !cs->root_open) {
+			g_autofree gchar *root_start = NULL;
+			xmlNode *root = as_metadata_xml_new_catalog_root (cs->metad, cs->ser_ctx);
+
+			root_start = as_catalog_stream_xml_root_start (root);
+			xmlFreeNode (root);
+			if (!as_catalog_stream_write (cs, root_start, error))
+				return FALSE;
+			cs->root_open = TRUE;
+		}
+		if (!as_catalog_stream_write (cs, item->data, error))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * as_catalog_stream_dispatch:
+ *
+ * Hand the batch that is currently filled to the workers, and write
+ * the batch that was dispatched before it.
+ */
+static gboolean
+as_catalog_stream_dispatch (AsCatalogStream *cs, GError **error)
+{
+	AsCatalogStreamBatch *batch = g_steal_pointer (&cs->batch);
+	gboolean ret = TRUE;
+
+	/* all catalog-wide properties are known once the first component was read */
+	if (cs->ser_ctx == NULL)
+		cs->ser_ctx = as_metadata_new_context (cs->metad, AS_FORMAT_STYLE_CATALOG, NULL);
+
+	if (batch != NULL) {
+		batch->n_pending = batch->items->len;
+		for (guint i = 0; i < batch->items->len; i++) {
+			AsCatalogStreamItem *item = g_ptr_array_index (batch->items, i);
+			if (cs->pool == NULL)
+				as_catalog_stream_worker_cb (item, cs);
+			else
+				g_thread_pool_push (cs->pool, item, NULL);
+		}
+	}
+
+	/* keep one batch in flight while the reader continues */
+	if (cs->running != NULL) {
+		ret = as_catalog_stream_write_batch (cs, cs->running, error);
+		as_catalog_stream_batch_free (g_steal_pointer (&cs->running));
+	}
+	cs->running = batch;
+
+	return ret;
+}
+
+static gboolean
+as_catalog_stream_add_item (AsCatalogStream *cs, AsCatalogStreamItem *item, GError **error)
+{
+	if (cs->batch == NULL)
+		cs->batch = as_catalog_stream_batch_new ();
+	item->batch = cs->batch;
+	g_ptr_array_add (cs->batch->items, item);
+
+	if (cs->batch->items->len < AS_CATALOG_STREAM_BATCH_SIZE)
+		return TRUE;
+	return as_catalog_stream_dispatch (cs, error);
+}
+
+static int
+as_catalog_stream_xml_read_cb (void *context, char *buffer, int len)
+{
+	AsCatalogStream *cs = (AsCatalogStream *) context;
+	gssize res;
+
+	res = g_input_stream_read (cs->istream, buffer, len, NULL, &cs->read_error);
+	return res < 0 ? -1 : (int) res;
+}
+
+static void
+as_catalog_stream_xml_error_cb (void *arg,
+				const char *msg,
+				xmlParserSeverities severity,
+				xmlTextReaderLocatorPtr locator)
+{
+	gchar **error_msg = (gchar **) arg;
+
+	if (severity != XML_PARSER_SEVERITY_ERROR || *error_msg != NULL)
+		return;
+	*error_msg = g_strstrip (g_strdup (msg));
+}
+
+/**
+ * as_catalog_stream_read_xml:
+ *
+ * Read the components of a catalog XML document one by one.
+ */
+static gboolean
+as_catalog_stream_read_xml (AsCatalogStream *cs, const gchar *filename, GError **error)
+{
+	xmlTextReaderPtr reader;
+	g_autofree gchar *error_msg = NULL;
+	gint res;
+
+	reader = xmlReaderForIO (as_catalog_stream_xml_read_cb,
+				 NULL,
+				 cs,
+				 filename,
+				 "utf-8",
+				 XML_PARSE_NOBLANKS | XML_PARSE_NONET | XML_PARSE_BIG_LINES);
+	if (reader == NULL) {
+		g_set_error_literal (error,
+				     AS_METADATA_ERROR,
+				     AS_METADATA_ERROR_PARSE,
+				     "Could not parse XML data (no details received)");
+		return FALSE;
+	}
+	xmlTextReaderSetErrorHandler (reader, as_catalog_stream_xml_error_cb, &error_msg);
+
+	res = xmlTextReaderRead (reader);
+	while (res == 1) {
+		AsCatalogStreamItem *item;
+		xmlNode *node;
+		gint depth = xmlTextReaderDepth (reader);
+
+		if (xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT || depth > 1) {
+			res = xmlTextReaderRead (reader);
+			continue;
+		}
+
+		node = xmlTextReaderCurrentNode (reader);
+		if (depth == 0) {
+			if (g_strcmp0 ((const gchar *) node->name, "components") == 0) {
+				/* the root's attributes are available before its children are read */
+				as_metadata_xml_parse_catalog_root_props (cs->metad, cs->parse_ctx, node);
+				res = xmlTextReaderRead (reader);
+				continue;
+			}
+			if (g_strcmp0 ((const gchar *) node->name, "component") != 0) {
+				xmlFreeTextReader (reader);
+				g_set_error_literal (error,
+						     AS_METADATA_ERROR,
+						     AS_METADATA_ERROR_FAILED,
+						     "XML file does not contain valid AppStream data!");
+				return FALSE;
+			}
+			/* a single component is allowed as well, like in as_metadata_parse_raw() */
+		}
+
+		/* take a copy of just this component, so the reader can discard it */
+		node = xmlTextReaderExpand (reader);
+		if (node == NULL) {
+			res = -1;
+			break;
+		}
+		item = g_new0 (AsCatalogStreamItem, 1);
+		item->xml_doc = xmlNewDoc ((xmlChar *) NULL);
+		xmlDocSetRootElement (item->xml_doc, xmlDocCopyNode (node, item->xml_doc, 1));
+		if (!as_catalog_stream_add_item (cs, item, error)) {
+			xmlFreeTextReader (reader);
+			return FALSE;
+		}
+
+		res = xmlTextReaderNext (reader);
+	}
+	xmlFreeTextReader (reader);
+
+	if (res < 0) {
+		if (cs->read_error != NULL)
+			g_propagate_error (error, g_steal_pointer (&cs->read_error));
+		else if (error_msg != NULL)
+			g_set_error (error,
+				     AS_METADATA_ERROR,
+				     AS_METADATA_ERROR_PARSE,
+				     "Could not parse XML data: %s",
+				     error_msg);
+		else
+			g_set_error_literal (error,
+					     AS_METADATA_ERROR,
+					     AS_METADATA_ERROR_PARSE,
+					     "Could not parse XML data (no details received)");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static int
+as_catalog_stream_yaml_read_cb (void *data, unsigned char *buffer, size_t size, size_t *size_read)
+{
+	AsCatalogStream *cs = (AsCatalogStream *) data;
+	gssize res;
+
+	res = g_input_stream_read (cs->istream, buffer, size, NULL, &cs->read_error);
+	if (res < 0)
+		return 0;
+	*size_read = res;
+	return 1;
+}
+
+/**
+ * as_catalog_stream_read_yaml:
+ *
+ * Read the components of a DEP-11 YAML catalog document by document.
+ */
+static gboolean
+as_catalog_stream_read_yaml (AsCatalogStream *cs, GError **error)
+{
+	yaml_parser_t parser;
+	yaml_event_t event;
+	gboolean header = TRUE;
+	gboolean ret = TRUE;
+
+	yaml_parser_initialize (&parser);
+	yaml_parser_set_input (&parser, as_catalog_stream_yaml_read_cb, cs);
+
+	while (ret) {
+		gboolean stream_end;
+
+		if (!yaml_parser_parse (&parser, &event)) {
+			if (cs->read_error != NULL)
+				g_propagate_error (error, g_steal_pointer (&cs->read_error));
+			else
+				g_set_error (error,
+					     AS_METADATA_ERROR,
+					     AS_METADATA_ERROR_PARSE,
+					     "Invalid DEP-11 file found. Could not parse YAML: %s",
+					     parser.problem);
+			ret = FALSE;
+			break;
+		}
+
+		if (event.type == YAML_DOCUMENT_START_EVENT) {
+			gboolean header_found = FALSE;
+			GError *tmp_error = NULL;
+			GNode *root = g_node_new (g_strdup (""));
+
+			as_yaml_parse_layer (&parser, root, &tmp_error);
+			if (tmp_error == NULL && header)
+				as_metadata_yaml_parse_header (cs->metad,
+							       cs->parse_ctx,
+							       root,
+							       &header_found,
+							       &tmp_error);
+			header = FALSE;
+
+			if (tmp_error != NULL) {
+				g_propagate_error (error, tmp_error);
+				as_catalog_stream_yaml_node_free (root);
+				ret = FALSE;
+			} else if (header_found) {
+				as_catalog_stream_yaml_node_free (root);
+			} else {
+				AsCatalogStreamItem *item = g_new0 (AsCatalogStreamItem, 1);
+				item->yaml_root = root;
+				ret = as_catalog_stream_add_item (cs, item, error);
+			}
+		}
+
+		stream_end = event.type == YAML_STREAM_END_EVENT;
+		yaml_event_delete (&event);
+		if (stream_end)
+			break;
+	}
+
+	yaml_parser_delete (&parser);
+	return ret;
+}
+
+/**
+ * as_metadata_convert_catalog_stream:
+ * @metad: An instance of #AsMetadata.
+ * @istream: Catalog metadata to read.
+ * @in_format: The format of @istream, XML or YAML.
+ * @filename: (nullable): The name of the input file, for messages.
+ * @ostream: Stream to write the converted catalog metadata to.
+ * @out_format: The format to convert to, XML or YAML.
+ * @n_threads: Number of threads for loading and serializing components, or 0 to use one per CPU.
+ * @error: A #GError or %NULL.
+ *
+ * Convert catalog metadata from one format to another, while holding only a
+ * limited number of components in memory.
+ *
+ * The input is read sequentially, while loading components and serializing them
+ * happens on @n_threads worker threads. Components are always written in input
+ * order, and the result is identical to parsing the complete input with
+ * as_metadata_parse_data() and serializing it with as_metadata_components_to_catalog().
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+as_metadata_convert_catalog_stream (AsMetadata *metad,
+				    GInputStream *istream,
+				    AsFormatKind in_format,
+				    const gchar *filename,
+				    GOutputStream *ostream,
+				    AsFormatKind out_format,
+				    guint n_threads,
+				    GError **error)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (metad);
+	AsCatalogStream cs = { 0 };
+	gboolean ret;
+
+	g_return_val_if_fail (in_format == AS_FORMAT_KIND_XML || in_format == AS_FORMAT_KIND_YAML,
+			      FALSE);
+	g_return_val_if_fail (out_format == AS_FORMAT_KIND_XML ||
+				  out_format == AS_FORMAT_KIND_YAML,
+			      FALSE);
+
+	cs.metad = metad;
+	cs.out_format = out_format;
+	cs.istream = istream;
+	cs.ostream = ostream;
+	cs.parse_ctx = as_metadata_new_context (metad, AS_FORMAT_STYLE_CATALOG, filename);
+
+	if (n_threads == 0)
+		n_threads = g_get_num_processors ();
+	if (n_threads > 1)
+		cs.pool = g_thread_pool_new (as_catalog_stream_worker_cb,
+					     &cs,
+					     n_threads,
+					     FALSE,
+					     NULL);
+
+	if (in_format == AS_FORMAT_KIND_XML)
+		ret = as_catalog_stream_read_xml (&cs, filename, error);
+	else
+		ret = as_catalog_stream_read_yaml (&cs, error);
+
+	/* process the last partial batch, then write it */
+	if (ret)
+		ret = as_catalog_stream_dispatch (&cs, error);
+	if (ret)
+		ret = as_catalog_stream_dispatch (&cs, error);
+
+	if (ret && out_format == AS_FORMAT_KIND_XML && priv->write_header) {
+		if (cs.root_open) {
+			ret = as_catalog_stream_write (&cs, "</components>\n", error);
+		} else if (cs.have_cpts) {
+			/* no component could be serialized, so the root node has no children */
+			g_autofree gchar *data = NULL;
+
+			data = as_xml_node_free_to_str (as_metadata_xml_new_catalog_root (metad,
+											  cs.ser_ctx),
+							NULL);
+			ret = as_catalog_stream_write (&cs, data, error);
+		}
+	}
+
+	/* the workers must be done before their batches are freed */
+	if (cs.pool != NULL)
+		g_thread_pool_free (cs.pool, FALSE, TRUE);
+	as_catalog_stream_batch_free (cs.batch);
+	as_catalog_stream_batch_free (cs.running);
+	g_clear_object (&cs.parse_ctx);
+	g_clear_object (&cs.ser_ctx);
+	g_clear_error (&cs.read_error);
+
+	return ret;
+}
+
 /**
  * as_metadata_add_component:
  *
@@ -1736,6 +2441,35 @@ as_metadata_set_parse_flags (AsMetadata *metad, AsParseFlags flags)
 	priv->parse_flags = flags;
 }
 
+/**
+ * as_metadata_get_internal_mode:
+ * @metad: a #AsMetadata instance.
+ *
+ * Returns: %TRUE if internal data is read and written.
+ **/
+gboolean
+as_metadata_get_internal_mode (AsMetadata *metad)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (metad);
+	return priv->internal_mode;
+}
+
+/**
+ * as_metadata_set_internal_mode:
+ * @metad: a #AsMetadata instance.
+ * @enabled: %TRUE to enable internal mode.
+ *
+ * Read and write internal component data, like the origin, scope and branch
+ * of a component, that is normally only stored in the cache. This is used to
+ * pass components between processes without losing information.
+ **/
+void
+as_metadata_set_internal_mode (AsMetadata *metad, gboolean enabled)
+{
+	AsMetadataPrivate *priv = GET_PRIVATE (metad);
+	priv->internal_mode = enabled;
+}
+
 /**
  * as_metadata_class_init:
  **/
@@ -29,11 +29,45 @@ AS_BEGIN_PRIVATE_DECLS
 
 time_t as_pool_get_os_metadata_cache_age (AsPool *pool);
 
+/**
+ * AsPoolSectionState:
+ * @AS_POOL_SECTION_STATE_STARTED:	Processing of the section has started.
+ * @AS_POOL_SECTION_STATE_UPDATED:	The cache section was rebuilt from its source data.
+ * @AS_POOL_SECTION_STATE_UNCHANGED:	The cache section was up to date.
+ * @AS_POOL_SECTION_STATE_FAILED:	The cache section could not be rebuilt.
+ *
+ * State of a cache section while the cache is refreshed.
+ **/
+typedef enum {
+	AS_POOL_SECTION_STATE_STARTED,
+	AS_POOL_SECTION_STATE_UPDATED,
+	AS_POOL_SECTION_STATE_UNCHANGED,
+	AS_POOL_SECTION_STATE_FAILED,
+} AsPoolSectionState;
+
+/**
+ * AsPoolRefreshProgressFn:
+ * @section: The key of the cache section, e.g. "os-catalog".
+ * @state: The new state of the section.
+ * @duration_usec: Time it took to process the section, or 0 if it has just started.
+ * @user_data: The user data passed to as_pool_refresh_system_cache().
+ *
+ * Reports the progress of a cache refresh. It is always called on the
+ * thread that started the refresh.
+ */
+typedef void (*AsPoolRefreshProgressFn) (const gchar	   *section,
+					 AsPoolSectionState state,
+					 gint64		    duration_usec,
+					 gpointer	    user_data);
+
 AS_INTERNAL_VISIBLE
-gboolean as_pool_refresh_system_cache (AsPool	*pool,
-				       gboolean	 force,
-				       gboolean *caches_updated,
-				       GError  **error);
+gboolean as_pool_refresh_system_cache (AsPool		      *pool,
+				       gboolean		       force,
+				       guint		       n_jobs,
+				       AsPoolRefreshProgressFn progress_fn,
+				       gpointer		       user_data,
+				       gboolean		      *caches_updated,
+				       GError		     **error);
 
 AS_INTERNAL_VISIBLE
 void as_pool_override_cache_locations (AsPool *pool, const gchar *dir_sys, const gchar *dir_user);
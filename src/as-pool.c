@@ -1589,6 +1589,139 @@ as_pool_loader_process_group (AsPool *pool,
 	return TRUE;
 }
 
+typedef struct {
+	AsPool *pool;
+	AsLocationGroup *lgroup;
+	gboolean force_cache_refresh;
+
+	gboolean caches_updated;
+	gint64 duration_usec;
+	GError *error;
+} AsPoolLoaderJob;
+
+static void
+as_pool_loader_job_free (AsPoolLoaderJob *job)
+{
+	g_clear_error (&job->error);
+	g_free (job);
+}
+
+/**
+ * as_pool_loader_job_run_cb:
+ *
+ * Process the location group of a loader job and hand the finished
+ * job back to the thread that dispatched it.
+ */
+static void
+as_pool_loader_job_run_cb (gpointer data, gpointer user_data)
+{
+	AsPoolLoaderJob *job = (AsPoolLoaderJob *) data;
+	GAsyncQueue *done_queue = (GAsyncQueue *) user_data;
+	gint64 start_time = g_get_monotonic_time ();
+
+	as_pool_loader_process_group (job->pool,
+				      job->lgroup,
+				      job->force_cache_refresh,
+				      &job->caches_updated,
+				      &job->error);
+	job->duration_usec = g_get_monotonic_time () - start_time;
+
+	g_async_queue_push (done_queue, job);
+}
+
+/**
+ * as_pool_loader_process_groups:
+ * @n_jobs: Maximum number of groups to process at the same time, or 0 for one per CPU.
+ *
+ * Process a set of location groups. Every group has its own cache section,
+ * so groups are independent of each other and can be processed concurrently.
+ */
+static gboolean
+as_pool_loader_process_groups (AsPool *pool,
+			       GPtrArray *groups,
+			       gboolean force_cache_refresh,
+			       guint n_jobs,
+			       AsPoolRefreshProgressFn progress_fn,
+			       gpointer user_data,
+			       gboolean *caches_updated,
+			       GError **error)
+{
+	GThreadPool *tpool = NULL;
+	GAsyncQueue *done_queue;
+	guint n_next = 0;
+	guint n_running = 0;
+	GError *first_error = NULL;
+
+	/* NOTE: Write-lock is held by the caller. */
+
+	if (n_jobs == 0)
+		n_jobs = g_get_num_processors ();
+	n_jobs = MIN (n_jobs, groups->len);
+
+	done_queue = g_async_queue_new ();
+	if (n_jobs > 1)
+		tpool = g_thread_pool_new (as_pool_loader_job_run_cb,
+					   done_queue,
+					   n_jobs,
+					   FALSE,
+					   NULL);
+
+	while (n_next < groups->len || n_running > 0) {
+		AsPoolLoaderJob *job;
+
+		/* keep at most n_jobs groups in flight, and start no new ones after an error */
+		while (first_error == NULL && n_running < MAX (n_jobs, 1) && n_next < groups->len) {
+			job = g_new0 (AsPoolLoaderJob, 1);
+			job->pool = pool;
+			job->lgroup = g_ptr_array_index (groups, n_next++);
+			job->force_cache_refresh = force_cache_refresh;
+
+			if (progress_fn != NULL)
+				progress_fn (job->lgroup->cache_key,
+					     AS_POOL_SECTION_STATE_STARTED,
+					     0,
+					     user_data);
+			if (tpool == NULL)
+				as_pool_loader_job_run_cb (job, done_queue);
+			else
+				g_thread_pool_push (tpool, job, NULL);
+			n_running++;
+		}
+		if (n_running == 0)
+			break;
+
+		job = g_async_queue_pop (done_queue);
+		n_running--;
+
+		if (progress_fn != NULL) {
+			AsPoolSectionState state = AS_POOL_SECTION_STATE_UNCHANGED;
+			if (job->error != NULL)
+				state = AS_POOL_SECTION_STATE_FAILED;
+			else if (job->caches_updated)
+				state = AS_POOL_SECTION_STATE_UPDATED;
+			progress_fn (job->lgroup->cache_key, state, job->duration_usec, user_data);
+		}
+
+		if (job->caches_updated && caches_updated != NULL)
+			*caches_updated = TRUE;
+		if (job->error != NULL && first_error == NULL)
+			first_error = g_steal_pointer (&job->error);
+		as_pool_loader_job_free (job);
+	}
+
+	if (tpool != NULL)
+		g_thread_pool_free (tpool, FALSE, TRUE);
+	g_async_queue_unref (done_queue);
+
+	/* cache writing errors or other fatal stuff will cause us to stop loading anything */
+	if (first_error != NULL) {
+		g_propagate_error (error, first_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 /**
  * as_pool_load_internal:
  *
@@ -1599,15 +1732,18 @@ static gboolean
 as_pool_load_internal (AsPool *pool,
 		       gboolean include_user_data,
 		       gboolean force_cache_refresh,
+		       guint n_jobs,
+		       AsPoolRefreshProgressFn progress_fn,
+		       gpointer user_data,
 		       gboolean *caches_updated,
 		       GCancellable *cancellable,
 		       GError **error)
 {
 	AsPoolPrivate *priv = GET_PRIVATE (pool);
 	g_autoptr(AsProfileTask) ptask = NULL;
+	g_autoptr(GPtrArray) groups = NULL;
 	GHashTableIter loc_iter;
 	gpointer loc_value;
-	gboolean ret = TRUE;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
 
 	ptask = as_profile_start_literal (priv->profile, "AsPool:load");
@@ -1632,32 +1768,29 @@ as_pool_load_internal (AsPool *pool,
 	if (caches_updated != NULL)
 		*caches_updated = FALSE;
 
-	/* process data from all the individual metadata silos in known locations */
+	/* collect the individual metadata silos in known locations, followed by the user-defined locations */
+	groups = g_ptr_array_new ();
 	g_hash_table_iter_init (&loc_iter, priv->std_data_locations);
 	while (g_hash_table_iter_next (&loc_iter, NULL, &loc_value)) {
-		ret = as_pool_loader_process_group (pool,
-						    loc_value,
-						    force_cache_refresh,
-						    caches_updated,
-						    error);
-		/* cache writing errors or other fatal stuff will cause us to stop loading anything */
-		if (!ret)
-			return FALSE;
+		AsLocationGroup *lgroup = loc_value;
+		if (lgroup->locations->len > 0)
+			g_ptr_array_add (groups, lgroup);
 	}
-
-	/* process data in user-defined locations */
 	g_hash_table_iter_init (&loc_iter, priv->extra_data_locations);
 	while (g_hash_table_iter_next (&loc_iter, NULL, &loc_value)) {
-		ret = as_pool_loader_process_group (pool,
-						    loc_value,
-						    force_cache_refresh,
-						    caches_updated,
-						    error);
-		if (!ret)
-			return FALSE;
+		AsLocationGroup *lgroup = loc_value;
+		if (lgroup->locations->len > 0)
+			g_ptr_array_add (groups, lgroup);
 	}
 
-	return ret;
+	return as_pool_loader_process_groups (pool,
+					      groups,
+					      force_cache_refresh,
+					      n_jobs,
+					      progress_fn,
+					      user_data,
+					      caches_updated,
+					      error);
 }
 
 /**
@@ -1681,7 +1814,10 @@ as_pool_load (AsPool *pool, GCancellable *cancellable, GError **error)
 	return as_pool_load_internal (pool,
 				      TRUE,  /* also load user-specific data */
 				      FALSE, /* do not force cache refresh */
-				      NULL,  /* we don't care whether caches were used or not */
+				      1,     /* sections are mostly read from the cache, which is serialized */
+				      NULL,
+				      NULL,
+				      NULL, /* we don't care whether caches were used or not */
 				      cancellable,
 				      error);
 }
@@ -2247,16 +2383,25 @@ as_pool_search (AsPool *pool, const gchar *search)
  * as_pool_refresh_system_cache:
  * @pool: An instance of #AsPool.
  * @force: Enforce refresh, even if source data has not changed.
+ * @n_jobs: Maximum number of cache sections to rebuild at the same time, or 0 for one per CPU.
+ * @progress_fn: (scope call) (nullable): Function to report the progress of each cache section to.
+ * @user_data: User data for @progress_fn.
  * @caches_updated: Return whether caches were updated or not.
  *
  * Update the AppStream cache. There is normally no need to call this function manually, because cache updates are handled
  * transparently in the background.
  *
+ * The cache sections, e.g. for the OS catalog data, local metainfo files and each Flatpak remote,
+ * are independent of each other and are rebuilt concurrently.
+ *
  * Returns: %TRUE on success, %FALSE on error.
  */
 gboolean
 as_pool_refresh_system_cache (AsPool *pool,
 			      gboolean force,
+			      guint n_jobs,
+			      AsPoolRefreshProgressFn progress_fn,
+			      gpointer user_data,
 			      gboolean *caches_updated,
 			      GError **error)
 {
@@ -2284,6 +2429,9 @@ as_pool_refresh_system_cache (AsPool *pool,
 	ret = as_pool_load_internal (pool,
 				     FALSE, /* no user data, only load system data */
 				     force,
+				     n_jobs,
+				     progress_fn,
+				     user_data,
 				     caches_updated,
 				     NULL,
 				     &tmp_error);
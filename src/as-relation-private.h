@@ -34,6 +34,8 @@ AS_BEGIN_PRIVATE_DECLS
 GVariant *as_relation_get_value_var (AsRelation *relation);
 void	  as_relation_set_value_var (AsRelation *relation, GVariant *value);
 
+gchar	 *as_relation_get_cache_key (AsRelation *relation);
+
 gboolean  as_relation_load_from_xml (AsRelation *relation,
 				     AsContext	*ctx,
 				     xmlNode	*node,
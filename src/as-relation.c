@@ -648,6 +648,34 @@ as_relation_set_value_var (AsRelation *relation, GVariant *value)
 	priv->value = g_variant_ref_sink (value);
 }
 
+/**
+ * as_relation_get_cache_key:
+ * @relation: an #AsRelation instance.
+ *
+ * Build a string which is identical for all relations that check
+ * the same thing in the same way, so their check results can be shared.
+ *
+ * Returns: (transfer full): the key for this relation.
+ **/
+gchar *
+as_relation_get_cache_key (AsRelation *relation)
+{
+	AsRelationPrivate *priv = GET_PRIVATE (relation);
+	g_autofree gchar *value_str = NULL;
+
+	if (priv->value != NULL)
+		value_str = g_variant_print (priv->value, TRUE);
+
+	return g_strdup_printf ("%i;%i;%i;%i;%u;%s;%s",
+				priv->kind,
+				priv->item_kind,
+				priv->compare,
+				priv->display_side_kind,
+				priv->bandwidth_mbitps,
+				priv->version != NULL ? priv->version : "",
+				value_str != NULL ? value_str : "");
+}
+
 /**
  * as_relation_get_value_str:
  * @relation: an #AsRelation instance.
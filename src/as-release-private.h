@@ -28,6 +28,8 @@
 
 AS_BEGIN_PRIVATE_DECLS
 
+const gchar *as_release_get_version_sort_key (AsRelease *release);
+
 gboolean as_release_description_translatable (AsRelease *release);
 void	 as_release_set_description_translatable (AsRelease *release, gboolean translatable);
 
@@ -36,6 +36,8 @@
 
 #include "as-release-private.h"
 
+#include <string.h>
+
 #include "as-utils.h"
 #include "as-utils-private.h"
 #include "as-vercmp.h"
@@ -47,6 +49,7 @@
 typedef struct {
 	AsReleaseKind kind;
 	gchar *version;
+	gchar *version_sort_key;
 	GHashTable *description;
 	guint64 timestamp;
 	gchar *date;
@@ -223,6 +226,7 @@ as_release_finalize (GObject *object)
 	AsReleasePrivate *priv = GET_PRIVATE (release);
 
 	g_free (priv->version);
+	g_free (priv->version_sort_key);
 	g_free (priv->date);
 	g_free (priv->date_eol);
 	g_free (priv->url_details);
@@ -308,7 +312,33 @@ as_release_set_version (AsRelease *release, const gchar *version)
 {
 	AsReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (AS_IS_RELEASE (release));
-	as_assign_string_safe (priv->version, version);
+	if (as_str_equal0 (priv->version, version))
+		return;
+	g_free (priv->version);
+	priv->version = g_strdup (version);
+
+	/* computed here, so releases of a shared pool can be compared from multiple threads */
+	g_free (priv->version_sort_key);
+	priv->version_sort_key = version == NULL ? NULL
+						 : as_vercmp_sort_key (version, AS_VERCMP_FLAG_NONE);
+}
+
+/**
+ * as_release_get_version_sort_key:
+ * @release: a #AsRelease instance.
+ *
+ * Get the sort key of the release version, see as_vercmp_sort_key().
+ *
+ * Returns: the sort key.
+ **/
+const gchar *
+as_release_get_version_sort_key (AsRelease *release)
+{
+	AsReleasePrivate *priv = GET_PRIVATE (release);
+	/* the key of a missing version */
+	if (priv->version_sort_key == NULL)
+		return "";
+	return priv->version_sort_key;
 }
 
 /**
@@ -318,14 +348,25 @@ as_release_set_version (AsRelease *release, const gchar *version)
  *
  * Compare the version numbers of two releases.
  *
+ * The result is the same as as_vercmp_simple() gives for the two versions,
+ * except for versions that as_vercmp_simple() considers equal to multiple
+ * versions that are not equal to each other. For example, it considers "1."
+ * equal to "1.0~rc1" and to "1.0", while this function orders "1.0~rc1" before
+ * "1." and "1.0". See as_vercmp_sort_key() for details.
+ *
  * Returns: 1 if @rel1 version is higher than @rel2, 0 if versions are equal, -1 if @rel2 version is higher than @rel1.
  */
 gint
 as_release_vercmp (AsRelease *rel1, AsRelease *rel2)
 {
+	gint ret;
 	g_return_val_if_fail (AS_IS_RELEASE (rel1), 0);
 	g_return_val_if_fail (AS_IS_RELEASE (rel2), 0);
-	return as_vercmp_simple (as_release_get_version (rel1), as_release_get_version (rel2));
+
+	/* releases are usually compared many times while sorting, so we use the cached keys */
+	ret = strcmp (as_release_get_version_sort_key (rel1),
+		      as_release_get_version_sort_key (rel2));
+	return (ret > 0) - (ret < 0);
 }
 
 /**
@@ -35,6 +35,15 @@ void as_system_info_set_kernel (AsSystemInfo *sysinfo, const gchar *name, const
 AS_INTERNAL_VISIBLE
 void as_system_info_set_memory_total (AsSystemInfo *sysinfo, gulong size_mib);
 
+AS_INTERNAL_VISIBLE
+void as_system_info_set_sysfs_devices_root (AsSystemInfo *sysinfo, const gchar *root);
+
+AS_INTERNAL_VISIBLE
+void as_system_info_set_modalias_cache_file (AsSystemInfo *sysinfo, const gchar *fname);
+
+AS_INTERNAL_VISIBLE
+void as_system_info_set_boot_id (AsSystemInfo *sysinfo, const gchar *boot_id);
+
 AS_END_PRIVATE_DECLS
 
 #endif /* __AS_SYSTEM_INFO_PRIVATE_H */
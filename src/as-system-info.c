@@ -45,10 +45,14 @@
 #include <sys/utsname.h>
 #endif
 #include <dirent.h>
+#include <string.h>
 #include <glib.h>
 
 #if defined(__linux__)
 #include <sys/sysinfo.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #elif defined(__FreeBSD__)
 #include <sys/types.h>
 #include <sys/sysctl.h>
@@ -74,6 +78,10 @@ typedef struct {
 
 	gulong memory_total;
 
+	gchar *sysfs_devices_root;
+	gchar *modalias_cache_fname;
+	gchar *boot_id;
+	gboolean modaliases_loaded;
 	GPtrArray *modaliases;
 	GHashTable *modalias_to_sysfs;
 
@@ -183,6 +191,9 @@ as_system_info_finalize (GObject *object)
 	g_free (priv->kernel_name);
 	g_free (priv->kernel_version);
 
+	g_free (priv->sysfs_devices_root);
+	g_free (priv->modalias_cache_fname);
+	g_free (priv->boot_id);
 	g_ptr_array_unref (priv->modaliases);
 	g_hash_table_unref (priv->modalias_to_sysfs);
 
@@ -520,63 +531,228 @@ as_system_info_set_memory_total (AsSystemInfo *sysinfo, gulong size_mib)
 
 #if defined(__linux__)
 /**
- * as_system_info_populate_modaliases_map_cb:
+ * as_system_info_read_modalias_at:
+ *
+ * Read the modalias file in the directory @dir_fd, without its trailing newline.
  */
-static gboolean
-as_system_info_populate_modaliases_map_cb (AsSystemInfo *sysinfo, const gchar *root_path)
+static gchar *
+as_system_info_read_modalias_at (int dir_fd, const gchar *dir_path)
+{
+	gchar buf[4096];
+	gsize len = 0;
+	int fd;
+
+	fd = openat (dir_fd, "modalias", O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+	if (fd < 0) {
+		g_warning ("Error while reading modalias file in %s: %s",
+			   dir_path,
+			   g_strerror (errno));
+		return NULL;
+	}
+
+	/* sysfs attributes are at most a page long, and we can read them in one go */
+	while (len < sizeof (buf) - 1) {
+		gssize r = read (fd, buf + len, sizeof (buf) - 1 - len);
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			g_warning ("Error while reading modalias file in %s: %s",
+				   dir_path,
+				   g_strerror (errno));
+			close (fd);
+			return NULL;
+		}
+		if (r == 0)
+			break;
+		len += r;
+	}
+	close (fd);
+
+	while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r'))
+		len--;
+	if (len == 0)
+		return NULL;
+
+	return g_strndup (buf, len);
+}
+
+/**
+ * as_system_info_populate_modaliases_map_at:
+ * @dir_fd: file descriptor of the directory to scan, consumed by this function.
+ * @path: path of the directory, restored to its original length before returning.
+ *
+ * Recursively find modalias files below a sysfs directory.
+ * We only look at the entry types reported by readdir() and open everything
+ * relative to its parent directory, so a scan needs no per-entry stat() and
+ * no lookups of full paths.
+ */
+static void
+as_system_info_populate_modaliases_map_at (AsSystemInfo *sysinfo, int dir_fd, GString *path)
 {
 	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	gsize path_len = path->len;
 	DIR *dir;
 	struct dirent *ent;
 
-	if ((dir = opendir (root_path)) != NULL) {
-		while ((ent = readdir (dir)) != NULL) {
-			if (ent->d_type == DT_LNK)
+	dir = fdopendir (dir_fd);
+	if (dir == NULL) {
+		g_warning ("Error while searching for modalias entries in %s: %s",
+			   path->str,
+			   g_strerror (errno));
+		close (dir_fd);
+		return;
+	}
+
+	while ((ent = readdir (dir)) != NULL) {
+		unsigned char d_type = ent->d_type;
+
+		if (ent->d_name[0] == '.' &&
+		    (ent->d_name[1] == '\0' || (ent->d_name[1] == '.' && ent->d_name[2] == '\0')))
+			continue;
+
+		/* only needed on filesystems that do not report the entry type */
+		if (d_type == DT_UNKNOWN) {
+			struct stat st;
+
+			if (fstatat (dirfd (dir), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
 				continue;
+			if (S_ISDIR (st.st_mode))
+				d_type = DT_DIR;
+			else if (S_ISREG (st.st_mode))
+				d_type = DT_REG;
+		}
 
-			if (ent->d_type == DT_DIR) {
-				g_autofree gchar *subdir_path = g_build_filename (root_path,
-										  ent->d_name,
-										  NULL);
-				if (!as_str_equal0 (ent->d_name, ".") &&
-				    !as_str_equal0 (ent->d_name, ".."))
-					as_system_info_populate_modaliases_map_cb (sysinfo,
-										   subdir_path);
-			} else {
-				if (as_str_equal0 (ent->d_name, "modalias")) {
-					gchar *contents = NULL;
-					g_autoptr(GError) read_error = NULL;
-					g_autofree gchar *path = g_build_filename (root_path,
-										   ent->d_name,
-										   NULL);
-
-					if (!g_file_get_contents (path,
-								  &contents,
-								  NULL,
-								  &read_error)) {
-						g_warning (
-						    "Error while reading modalias file %s: %s",
-						    path,
-						    read_error->message);
-						closedir (dir);
-						return FALSE;
-					}
-					contents = as_strstripnl (contents);
-					g_hash_table_insert (priv->modalias_to_sysfs,
-							     contents,
-							     g_path_get_dirname (path));
-				}
-			}
+		/* links are skipped, they would lead us to devices we already visit */
+		if (d_type == DT_DIR) {
+			int subdir_fd = openat (dirfd (dir),
+						ent->d_name,
+						O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+			if (subdir_fd < 0)
+				continue;
+
+			g_string_append_c (path, G_DIR_SEPARATOR);
+			g_string_append (path, ent->d_name);
+			as_system_info_populate_modaliases_map_at (sysinfo, subdir_fd, path);
+			g_string_truncate (path, path_len);
+		} else if (d_type == DT_REG && as_str_equal0 (ent->d_name, "modalias")) {
+			gchar *modalias = as_system_info_read_modalias_at (dirfd (dir), path->str);
+			if (modalias != NULL)
+				g_hash_table_insert (priv->modalias_to_sysfs,
+						     modalias,
+						     g_strndup (path->str, path_len));
 		}
-		closedir (dir);
-	} else {
-		g_warning ("Error while searching for modalias entries in %s: %s",
-			   root_path,
-			   g_strerror (errno));
 	}
 
+	closedir (dir);
+}
+
+/**
+ * as_system_info_get_boot_id:
+ *
+ * Returns: the ID of the current boot, or %NULL if it is unknown.
+ */
+static const gchar *
+as_system_info_get_boot_id (AsSystemInfo *sysinfo)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	gchar *contents = NULL;
+
+	if (priv->boot_id != NULL)
+		return priv->boot_id;
+
+	if (!g_file_get_contents ("/proc/sys/kernel/random/boot_id", &contents, NULL, NULL))
+		return NULL;
+	priv->boot_id = as_strstripnl (contents);
+
+	return priv->boot_id;
+}
+
+/**
+ * as_system_info_load_modalias_snapshot:
+ *
+ * Load the modaliases from the snapshot file, if it was written during
+ * the current boot for the same sysfs root.
+ *
+ * Returns: %TRUE if the snapshot was used.
+ */
+static gboolean
+as_system_info_load_modalias_snapshot (AsSystemInfo *sysinfo, const gchar *root)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	const gchar *boot_id;
+	g_autofree gchar *contents = NULL;
+	g_autofree gchar *expected_header = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	boot_id = as_system_info_get_boot_id (sysinfo);
+	if (boot_id == NULL)
+		return FALSE;
+	if (!g_file_get_contents (priv->modalias_cache_fname, &contents, NULL, NULL))
+		return FALSE;
+
+	expected_header = g_strdup_printf ("%s\t%s", boot_id, root);
+	lines = g_strsplit (contents, "\n", -1);
+	if (!as_str_equal0 (lines[0], expected_header))
+		return FALSE;
+
+	for (guint i = 1; lines[i] != NULL; i++) {
+		gchar *sep = strchr (lines[i], '\t');
+		if (sep == NULL)
+			continue;
+		g_hash_table_insert (priv->modalias_to_sysfs,
+				     g_strndup (lines[i], sep - lines[i]),
+				     g_strdup (sep + 1));
+	}
+
+	g_debug ("Loaded %u modaliases from snapshot %s",
+		 g_hash_table_size (priv->modalias_to_sysfs),
+		 priv->modalias_cache_fname);
 	return TRUE;
 }
+
+/**
+ * as_system_info_save_modalias_snapshot:
+ */
+static void
+as_system_info_save_modalias_snapshot (AsSystemInfo *sysinfo, const gchar *root)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	const gchar *boot_id;
+	GHashTableIter ht_iter;
+	gpointer ht_key, ht_value;
+	g_autoptr(GString) contents = NULL;
+	g_autofree gchar *cache_dir = NULL;
+	g_autoptr(GError) error = NULL;
+
+	boot_id = as_system_info_get_boot_id (sysinfo);
+	if (boot_id == NULL)
+		return;
+
+	contents = g_string_new (NULL);
+	g_string_append_printf (contents, "%s\t%s\n", boot_id, root);
+	g_hash_table_iter_init (&ht_iter, priv->modalias_to_sysfs);
+	while (g_hash_table_iter_next (&ht_iter, &ht_key, &ht_value))
+		g_string_append_printf (contents,
+					"%s\t%s\n",
+					(const gchar *) ht_key,
+					(const gchar *) ht_value);
+
+	cache_dir = g_path_get_dirname (priv->modalias_cache_fname);
+	g_mkdir_with_parents (cache_dir, 0755);
+	if (!g_file_set_contents (priv->modalias_cache_fname,
+				  contents->str,
+				  contents->len,
+				  &error))
+		g_debug ("Unable to write modalias snapshot: %s", error->message);
+}
+#endif
+
+#if defined(__linux__)
+static gint
+as_system_info_modalias_cmp (gconstpointer a, gconstpointer b)
+{
+	return strcmp (*((const gchar **) a), *((const gchar **) b));
+}
 #endif
 
 /**
@@ -587,20 +763,160 @@ as_system_info_populate_modaliases (AsSystemInfo *sysinfo)
 {
 #if defined(__linux__)
 	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	const gchar *root;
 	GHashTableIter ht_iter;
 	gpointer ht_key;
 
 	/* we never want to run this multiple times */
-	if (priv->modaliases->len != 0)
+	if (priv->modaliases_loaded)
 		return;
+	priv->modaliases_loaded = TRUE;
+
+	root = priv->sysfs_devices_root != NULL ? priv->sysfs_devices_root : "/sys/devices";
+	if (priv->modalias_cache_fname == NULL ||
+	    !as_system_info_load_modalias_snapshot (sysinfo, root)) {
+		int root_fd;
+		g_autoptr(GString) path = g_string_new (root);
+
+		root_fd = open (root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (root_fd < 0)
+			g_warning ("Error while searching for modalias entries in %s: %s",
+				   root,
+				   g_strerror (errno));
+		else
+			as_system_info_populate_modaliases_map_at (sysinfo, root_fd, path);
+
+		if (priv->modalias_cache_fname != NULL && root_fd >= 0)
+			as_system_info_save_modalias_snapshot (sysinfo, root);
+	}
 
-	as_system_info_populate_modaliases_map_cb (sysinfo, "/sys/devices");
 	g_hash_table_iter_init (&ht_iter, priv->modalias_to_sysfs);
 	while (g_hash_table_iter_next (&ht_iter, &ht_key, NULL))
 		g_ptr_array_add (priv->modaliases, ht_key);
+
+	/* keep modaliases sharing a prefix next to each other, so globs can be resolved
+	 * by looking at a small range of the list only */
+	g_ptr_array_sort (priv->modaliases, as_system_info_modalias_cmp);
 #endif
 }
 
+/**
+ * as_system_info_set_sysfs_devices_root:
+ * @sysinfo: a #AsSystemInfo instance.
+ * @root: (nullable): the directory to scan instead of /sys/devices.
+ *
+ * Read device modaliases from a different directory. This is used to
+ * test hardware matching against fake sysfs trees.
+ * Any modaliases that were already read are dropped.
+ */
+void
+as_system_info_set_sysfs_devices_root (AsSystemInfo *sysinfo, const gchar *root)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+
+	as_assign_string_safe (priv->sysfs_devices_root, root);
+	g_ptr_array_set_size (priv->modaliases, 0);
+	g_hash_table_remove_all (priv->modalias_to_sysfs);
+	priv->modaliases_loaded = FALSE;
+}
+
+/**
+ * as_system_info_set_modalias_cache_file:
+ * @sysinfo: a #AsSystemInfo instance.
+ * @fname: (nullable): the snapshot file to use, or %NULL to always scan sysfs.
+ *
+ * Set the file the device modaliases are cached in.
+ */
+void
+as_system_info_set_modalias_cache_file (AsSystemInfo *sysinfo, const gchar *fname)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	as_assign_string_safe (priv->modalias_cache_fname, fname);
+}
+
+/**
+ * as_system_info_set_boot_id:
+ * @sysinfo: a #AsSystemInfo instance.
+ * @boot_id: (nullable): the boot ID to key modalias snapshots with.
+ *
+ * Override the ID of the current boot, instead of reading it from the kernel.
+ */
+void
+as_system_info_set_boot_id (AsSystemInfo *sysinfo, const gchar *boot_id)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	as_assign_string_safe (priv->boot_id, boot_id);
+}
+
+/**
+ * as_system_info_set_modalias_cache_enabled:
+ * @sysinfo: a #AsSystemInfo instance.
+ * @enabled: %TRUE to use a modalias snapshot.
+ *
+ * Keep a snapshot of the device modaliases in the user's cache directory.
+ * The snapshot is used by all later #AsSystemInfo instances with caching enabled,
+ * until the system is rebooted, so they do not need to scan sysfs again.
+ *
+ * Devices that were plugged in after the snapshot was written are not seen,
+ * so this should only be enabled if that is acceptable for the application.
+ *
+ * Since: 1.0.0
+ */
+void
+as_system_info_set_modalias_cache_enabled (AsSystemInfo *sysinfo, gboolean enabled)
+{
+	g_autofree gchar *fname = NULL;
+
+	if (enabled)
+		fname = g_build_filename (g_get_user_cache_dir (),
+					  "appstream",
+					  "modaliases.snapshot",
+					  NULL);
+	as_system_info_set_modalias_cache_file (sysinfo, fname);
+}
+
+/**
+ * as_system_info_find_modalias_glob:
+ *
+ * Check whether a modalias on this system matches @modalias_glob.
+ * Only modaliases starting with the literal prefix of the glob are tested,
+ * which we find by bisecting the sorted modalias list.
+ */
+static gboolean
+as_system_info_find_modalias_glob (AsSystemInfoPrivate *priv, const gchar *modalias_glob)
+{
+	GPtrArray *modaliases = priv->modaliases;
+	gsize prefix_len = strcspn (modalias_glob, "*?");
+	guint lo = 0;
+	guint hi = modaliases->len;
+
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		const gchar *modalias = g_ptr_array_index (modaliases, mid);
+
+		if (strncmp (modalias, modalias_glob, prefix_len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* without wildcards, only the first entry with the prefix can be an exact match */
+	if (modalias_glob[prefix_len] == '\0')
+		return lo < modaliases->len &&
+		       strcmp (g_ptr_array_index (modaliases, lo), modalias_glob) == 0;
+
+	for (guint i = lo; i < modaliases->len; i++) {
+		const gchar *modalias = g_ptr_array_index (modaliases, i);
+
+		if (strncmp (modalias, modalias_glob, prefix_len) != 0)
+			break;
+		if (g_pattern_match_simple (modalias_glob, modalias))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
 /**
  * as_system_info_get_modaliases:
  * @sysinfo: a #AsSystemInfo instance.
@@ -649,16 +965,71 @@ as_system_info_has_device_matching_modalias (AsSystemInfo *sysinfo, const gchar
 	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
 	as_system_info_populate_modaliases (sysinfo);
 
-	for (guint i = 0; i < priv->modaliases->len; i++) {
-		const gchar *modalias = (const gchar *) g_ptr_array_index (priv->modaliases, i);
-		if (g_strcmp0 (modalias, modalias_glob) == 0)
-			return TRUE;
+	return as_system_info_find_modalias_glob (priv, modalias_glob);
+}
 
-		if (g_pattern_match_simple (modalias, modalias_glob))
-			return TRUE;
+/**
+ * as_system_info_get_components_matching_hardware:
+ * @sysinfo: a #AsSystemInfo instance.
+ * @cbox: the components to check.
+ *
+ * Find all components in @cbox which provide a modalias glob that matches
+ * a device on this system.
+ * This is much faster than calling as_system_info_has_device_matching_modalias()
+ * for every provided modalias, as each distinct glob is only resolved once.
+ *
+ * Returns: (transfer full): the components supporting hardware of this system.
+ *
+ * Since: 1.0.0
+ */
+AsComponentBox *
+as_system_info_get_components_matching_hardware (AsSystemInfo *sysinfo, AsComponentBox *cbox)
+{
+	AsSystemInfoPrivate *priv = GET_PRIVATE (sysinfo);
+	AsComponentBox *result = as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+	g_autoptr(GHashTable) glob_results = NULL;
+
+	as_system_info_populate_modaliases (sysinfo);
+	if (priv->modaliases->len == 0)
+		return result;
+
+	/* firmware and drivers often share their globs, so we remember every result */
+	glob_results = g_hash_table_new (g_str_hash, g_str_equal);
+	for (guint i = 0; i < as_component_box_len (cbox); i++) {
+		AsComponent *cpt = as_component_box_index (cbox, i);
+		AsProvided *prov = as_component_get_provided_for_kind (cpt,
+								       AS_PROVIDED_KIND_MODALIAS);
+		GPtrArray *globs;
+
+		if (prov == NULL)
+			continue;
+
+		globs = as_provided_get_items (prov);
+		for (guint j = 0; j < globs->len; j++) {
+			const gchar *modalias_glob = g_ptr_array_index (globs, j);
+			gpointer cached_value;
+			gboolean found;
+
+			if (g_hash_table_lookup_extended (glob_results,
+							  modalias_glob,
+							  NULL,
+							  &cached_value)) {
+				found = GPOINTER_TO_INT (cached_value);
+			} else {
+				found = as_system_info_find_modalias_glob (priv, modalias_glob);
+				g_hash_table_insert (glob_results,
+						     (gpointer) modalias_glob,
+						     GINT_TO_POINTER (found));
+			}
+
+			if (found) {
+				as_component_box_add (result, cpt, NULL);
+				break;
+			}
+		}
 	}
 
-	return FALSE;
+	return result;
 }
 
 /**
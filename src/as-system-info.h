@@ -28,6 +28,7 @@
 #include <glib-object.h>
 
 #include "as-relation.h"
+#include "as-component-box.h"
 
 G_BEGIN_DECLS
 
@@ -120,10 +121,13 @@ const gchar  *as_system_info_get_kernel_version (AsSystemInfo *sysinfo);
 
 gulong	      as_system_info_get_memory_total (AsSystemInfo *sysinfo);
 
+void	      as_system_info_set_modalias_cache_enabled (AsSystemInfo *sysinfo, gboolean enabled);
 GPtrArray    *as_system_info_get_modaliases (AsSystemInfo *sysinfo);
 const gchar  *as_system_info_modalias_to_syspath (AsSystemInfo *sysinfo, const gchar *modalias);
 gboolean      as_system_info_has_device_matching_modalias (AsSystemInfo *sysinfo,
 							   const gchar	*modalias_glob);
+AsComponentBox *as_system_info_get_components_matching_hardware (AsSystemInfo	*sysinfo,
+								 AsComponentBox *cbox);
 
 gchar	     *as_system_info_get_device_name_for_modalias (AsSystemInfo *sysinfo,
 							   const gchar	*modalias,
@@ -22,6 +22,8 @@
 #include "as-vercmp.h"
 
 #include <config.h>
+#include <limits.h>
+#include <string.h>
 #include <glib.h>
 
 #include "as-macros.h"
@@ -262,3 +264,131 @@ as_vercmp_test_match (const gchar *ver1,
 		return FALSE;
 	}
 }
+
+/* Bytes of a version sort key. Their order is the order as_vercmp()
+ * gives to the respective parts of a version string. */
+#define AS_SORT_KEY_TILDE    0x01 /* sorts before everything, even the end of a part */
+#define AS_SORT_KEY_PART_END 0x02 /* only written after an empty run and a zero number */
+#define AS_SORT_KEY_RUN_END  0x03 /* end of a non-digit run, a number follows */
+#define AS_SORT_KEY_ALPHA    0x04 /* 'A' to 'z' are mapped to 0x04 - 0x3D */
+#define AS_SORT_KEY_OTHER    0x40 /* followed by a second byte */
+
+/**
+ * as_sort_key_append_number:
+ *
+ * Append a number to a version sort key. The number's length is
+ * written first, so that bigger numbers sort after smaller ones.
+ */
+static gboolean
+as_sort_key_append_number (GString *key, const gchar *num, gsize len)
+{
+	/* leading zeros do not change the value */
+	for (; len > 0 && *num == '0'; num++, len--)
+		;
+
+	if (len < 0xFE) {
+		g_string_append_c (key, (gchar) (len + 1));
+	} else {
+		/* long numbers: the length follows in five 7-bit chunks, without NUL bytes */
+		g_string_append_c (key, (gchar) 0xFF);
+		for (gint shift = 28; shift >= 0; shift -= 7)
+			g_string_append_c (key, (gchar) (0x80 | ((len >> shift) & 0x7F)));
+	}
+	g_string_append_len (key, num, len);
+
+	return len == 0;
+}
+
+/**
+ * as_sort_key_append_part:
+ *
+ * Append the version or revision part of a version string to a sort key.
+ * The part is split into pairs of a non-digit run and a number, which
+ * are compared one after another by as_vercmp().
+ */
+static void
+as_sort_key_append_part (GString *key, const gchar *p, const gchar *end)
+{
+	gsize pair_start = key->len;
+	gboolean null_pair = FALSE;
+
+	while (p < end) {
+		const gchar *num;
+
+		pair_start = key->len;
+		for (; p < end && !g_ascii_isdigit (*p); p++) {
+			if (*p == '~') {
+				g_string_append_c (key, AS_SORT_KEY_TILDE);
+			} else if (g_ascii_isalpha (*p)) {
+				g_string_append_c (key, (gchar) (AS_SORT_KEY_ALPHA + (*p - 'A')));
+			} else {
+				/* as_vercmp() compares these as plain chars, which may be signed */
+				guint c = (guint) ((gint) *p - CHAR_MIN);
+				g_string_append_c (key, (gchar) (AS_SORT_KEY_OTHER + (c >> 7)));
+				g_string_append_c (key, (gchar) ((c & 0x7F) + 1));
+			}
+		}
+		null_pair = key->len == pair_start;
+		g_string_append_c (key, AS_SORT_KEY_RUN_END);
+
+		for (num = p; p < end && g_ascii_isdigit (*p); p++)
+			;
+		null_pair = as_sort_key_append_number (key, num, p - num) && null_pair;
+	}
+
+	/* The end of a part is written like a trailing zero, which as_vercmp()
+	 * considers equal to it, but it sorts before a zero followed by anything
+	 * other than a tilde. A trailing zero is therefore replaced by it. */
+	if (null_pair)
+		g_string_truncate (key, pair_start);
+	g_string_append_c (key, AS_SORT_KEY_RUN_END);
+	as_sort_key_append_number (key, "", 0);
+	g_string_append_c (key, AS_SORT_KEY_PART_END);
+}
+
+/**
+ * as_vercmp_sort_key:
+ * @version: (nullable): a version number
+ * @flags: Flags, e.g. %AS_VERCMP_FLAG_NONE
+ *
+ * Compute a key for @version, so that comparing the keys of two versions
+ * with strcmp() gives the same order as as_vercmp() with the same @flags.
+ *
+ * This is useful if a version is compared many times, e.g. when sorting,
+ * as the version string only has to be parsed once.
+ *
+ * The order only differs from as_vercmp() for versions that it does not order
+ * consistently either: if a part of one version is empty or ends with a non-digit
+ * character, and the other version continues with a number that is zero at the
+ * same position and has more characters after that, as_vercmp() considers
+ * both equal, while the key compares the remaining characters.
+ *
+ * Returns: (transfer full): the sort key for @version.
+ *
+ * Since: 1.0.0
+ */
+gchar *
+as_vercmp_sort_key (const gchar *version, AsVercmpFlags flags)
+{
+	AsVersion ver;
+	GString *key;
+
+	/* a missing version is older than any other */
+	if (version == NULL)
+		return g_strdup ("");
+
+	key = g_string_sized_new (strlen (version) * 2 + 8);
+	as_version_parse (&ver, version);
+
+	if (!as_flags_contains (flags, AS_VERCMP_FLAG_IGNORE_EPOCH)) {
+		const gchar *epoch_end = ver.epoch;
+		for (; g_ascii_isdigit (*epoch_end); epoch_end++)
+			;
+		as_sort_key_append_number (key, ver.epoch, epoch_end - ver.epoch);
+	}
+
+	as_sort_key_append_part (key, ver.version, MAX (ver.version, ver.version_end));
+	as_sort_key_append_part (key, ver.revision, ver.revision_end);
+
+	return g_string_free (key, FALSE);
+}
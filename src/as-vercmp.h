@@ -45,6 +45,8 @@ typedef enum {
 gint	 as_vercmp (const gchar *a, const gchar *b, AsVercmpFlags flags);
 gint	 as_vercmp_simple (const gchar *a, const gchar *b);
 
+gchar	*as_vercmp_sort_key (const gchar *version, AsVercmpFlags flags);
+
 gboolean as_vercmp_test_match (const gchar	*ver1,
 			       AsRelationCompare compare,
 			       const gchar	*ver2,
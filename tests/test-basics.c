@@ -20,6 +20,7 @@
 
 #include <config.h>
 #include <glib.h>
+#include <string.h>
 #include "appstream.h"
 #include "as-component-private.h"
 #include "as-component-box-private.h"
@@ -884,6 +885,177 @@ test_version_compare (void)
 	    as_vercmp_test_match ("5", AS_RELATION_COMPARE_GE, "6", AS_VERCMP_FLAG_NONE));
 }
 
+/**
+ * asx_sort_key_cmp:
+ */
+static gint
+asx_sort_key_cmp (const gchar *a, const gchar *b, AsVercmpFlags flags)
+{
+	g_autofree gchar *key_a = as_vercmp_sort_key (a, flags);
+	g_autofree gchar *key_b = as_vercmp_sort_key (b, flags);
+	gint ret = strcmp (key_a, key_b);
+	return (ret > 0) - (ret < 0);
+}
+
+/**
+ * asx_random_version_part:
+ *
+ * Generate a random version (or revision) part, which always
+ * starts and ends with a number.
+ */
+static void
+asx_random_version_part (GString *str)
+{
+	const gchar *numbers[] = { "0", "00", "1", "01", "2", "9", "10", "010", "99", "12345678901234567890" };
+	const gchar *separators[] = { ".", ".", ".", "~", "~rc", "~~", "+", "+dfsg", "a", "b", "rc",
+				      "beta", "_", "\xc3\xa4", ".a", "+b." };
+	guint n_numbers = g_test_rand_int_range (1, 5);
+
+	for (guint i = 0; i < n_numbers; i++) {
+		if (i > 0)
+			g_string_append (str, separators[g_test_rand_int_range (0, G_N_ELEMENTS (separators))]);
+		g_string_append (str, numbers[g_test_rand_int_range (0, G_N_ELEMENTS (numbers))]);
+	}
+}
+
+/**
+ * asx_random_version:
+ */
+static gchar *
+asx_random_version (void)
+{
+	const gchar *epochs[] = { "0", "1", "2", "01", "10" };
+	GString *str = g_string_new (NULL);
+
+	if (g_test_rand_bit ()) {
+		g_string_append (str, epochs[g_test_rand_int_range (0, G_N_ELEMENTS (epochs))]);
+		g_string_append_c (str, ':');
+	}
+	asx_random_version_part (str);
+	if (g_test_rand_bit ()) {
+		g_string_append_c (str, '-');
+		asx_random_version_part (str);
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+/**
+ * test_version_sort_keys:
+ *
+ * Test that version sort keys are ordered exactly like as_vercmp() orders versions.
+ */
+static void
+test_version_sort_keys (void)
+{
+	const gchar *versions[] = { "6", "8", "0.6.12b-d", "0.6.12a", "7.4", "ab.d", "ab.f",
+				    "5.9.1+dfsg-5pureos1", "5.9.1+dfsg-5", "2.79", "2.79a",
+				    "3.0.rc2", "3.0.0", "3.0.0~rc2", "11.0.9.1+1-0ubuntu1",
+				    "11.0.9+11-0ubuntu2", "001.002.003", "1.2.3", "4:5.6-2",
+				    "8.0-6", "1:1.0-4", "3:0.8-2", "1.2", "1.2.", "1.2.0", "1.2-0",
+				    "1.2-", "alpha", "beta", "9half", "9+", "9a", "10", "0", "00~rc1" };
+	const struct {
+		const gchar *a;
+		const gchar *b;
+		gint expected;
+	} edge_cases[] = {
+		{ "1.0~rc1", "1.0",	-1 },
+		{ "1.0~rc1", "1.0~rc2", -1 },
+		{ "1.0~~",   "1.0~",	-1 },
+		{ "1.0~",    "1.0~rc1", -1 },
+		{ "1.0~rc1", "1.0~beta", 1 },
+		{ "2~",	     "1.9",	1  },
+		{ "1.01",    "1.1",	0  },
+		{ "1.002",   "1.1",	1  },
+		{ "0010",    "9",	1  },
+		{ "1.0010",  "1.010",	0  },
+		{ "000",     "",	0  },
+		{ "1.0a",    "1.0",	1  },
+		{ "1.0a",    "1.0b",	-1 },
+		{ "1.0a",    "1.0.1",	-1 },
+		{ "1.0a1",   "1.0a",	1  },
+		{ "1a2b3",   "1a2b",	1  },
+		{ "1beta2",  "1beta10", -1 },
+		{ "rc1",     "1",	1  },
+		{ "1+",	     "1a",	1  },
+		{ "1_",	     "1+",	1  },
+	};
+	const struct {
+		const gchar *a;
+		const gchar *b;
+		gint expected;
+	} divergent_cases[] = {
+		{ "1.",	 "1.0~rc1", 1  },
+		{ "",	 "0.1",	    -1 },
+		{ "1.a", "1.a0.1",  -1 },
+	};
+	g_autoptr(AsRelease) rel1 = as_release_new ();
+	g_autoptr(AsRelease) rel2 = as_release_new ();
+
+	/* known versions, including ones as_vercmp() compares specially */
+	for (guint i = 0; i < G_N_ELEMENTS (versions); i++) {
+		for (guint j = 0; j < G_N_ELEMENTS (versions); j++) {
+			gint expected = as_vercmp_simple (versions[i], versions[j]);
+			expected = (expected > 0) - (expected < 0);
+			g_assert_cmpint (asx_sort_key_cmp (versions[i], versions[j], AS_VERCMP_FLAG_NONE),
+					 ==,
+					 expected);
+		}
+	}
+	g_assert_cmpint (asx_sort_key_cmp (NULL, NULL, AS_VERCMP_FLAG_NONE), ==, 0);
+	g_assert_cmpint (asx_sort_key_cmp (NULL, "", AS_VERCMP_FLAG_NONE), <, 0);
+	g_assert_cmpint (asx_sort_key_cmp ("", "0", AS_VERCMP_FLAG_NONE), ==, 0);
+	g_assert_cmpint (asx_sort_key_cmp ("1:1.0-4", "3:0.8-2", AS_VERCMP_FLAG_IGNORE_EPOCH), >, 0);
+
+	/* pre-releases, leading zeros and mixed alpha/numeric segments */
+	for (guint i = 0; i < G_N_ELEMENTS (edge_cases); i++) {
+		gint ret = as_vercmp_simple (edge_cases[i].a, edge_cases[i].b);
+		g_assert_cmpint ((ret > 0) - (ret < 0), ==, edge_cases[i].expected);
+		g_assert_cmpint (asx_sort_key_cmp (edge_cases[i].a, edge_cases[i].b, AS_VERCMP_FLAG_NONE),
+				 ==,
+				 edge_cases[i].expected);
+	}
+
+	/* the documented cases where as_vercmp() is not transitive and the key differs */
+	for (guint i = 0; i < G_N_ELEMENTS (divergent_cases); i++) {
+		g_assert_cmpint (as_vercmp_simple (divergent_cases[i].a, divergent_cases[i].b), ==, 0);
+		g_assert_cmpint (asx_sort_key_cmp (divergent_cases[i].a,
+						   divergent_cases[i].b,
+						   AS_VERCMP_FLAG_NONE),
+				 ==,
+				 divergent_cases[i].expected);
+	}
+
+	/* random versions */
+	for (guint i = 0; i < 50000; i++) {
+		g_autofree gchar *a = asx_random_version ();
+		g_autofree gchar *b = asx_random_version ();
+		AsVercmpFlags flags = g_test_rand_bit () ? AS_VERCMP_FLAG_NONE
+							 : AS_VERCMP_FLAG_IGNORE_EPOCH;
+		gint expected = as_vercmp (a, b, flags);
+		gint ret;
+
+		expected = (expected > 0) - (expected < 0);
+		ret = asx_sort_key_cmp (a, b, flags);
+		if (ret != expected)
+			g_error ("Sort keys of '%s' and '%s' compare as %i, but as_vercmp() returned %i",
+				 a,
+				 b,
+				 ret,
+				 expected);
+	}
+
+	/* releases cache their key, which must follow version changes */
+	g_assert_cmpint (as_release_vercmp (rel1, rel2), ==, 0);
+	as_release_set_version (rel1, "1.2.3");
+	as_release_set_version (rel2, "1.2.3~rc1");
+	g_assert_cmpint (as_release_vercmp (rel1, rel2), ==, 1);
+	as_release_set_version (rel2, "1.10");
+	g_assert_cmpint (as_release_vercmp (rel1, rel2), ==, -1);
+	as_release_set_version (rel1, "1.10");
+	g_assert_cmpint (as_release_vercmp (rel1, rel2), ==, 0);
+}
+
 /**
  * test_system_info:
  *
@@ -1237,6 +1409,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/AppStream/ReadDesktopEntry", test_read_desktop_entry_simple);
 	g_test_add_func ("/AppStream/ConvertDesktopEntry", test_desktop_entry_convert);
 	g_test_add_func ("/AppStream/VersionCompare", test_version_compare);
+	g_test_add_func ("/AppStream/VersionSortKeys", test_version_sort_keys);
 	g_test_add_func ("/AppStream/SystemInfo", test_system_info);
 	g_test_add_func ("/AppStream/rDNSConvert", test_rdns_convert);
 	g_test_add_func ("/AppStream/URIToBasename", test_filebasename_from_uri);
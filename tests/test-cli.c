@@ -0,0 +1,144 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include "appstream.h"
+
+#include "ascli-daemon.h"
+#include "ascli-utils.h"
+#include "as-test-utils.h"
+
+/**
+ * asx_new_internal_component:
+ *
+ * Create a component with data that is normally only stored in the cache.
+ */
+static AsComponent *
+asx_new_internal_component (const gchar *id, const gchar *origin)
+{
+	AsComponent *cpt = as_component_new ();
+
+	as_component_set_kind (cpt, AS_COMPONENT_KIND_DESKTOP_APP);
+	as_component_set_id (cpt, id);
+	as_component_set_name (cpt, "Test", "C");
+	as_component_set_summary (cpt, "A test component", "C");
+	as_component_set_name_variant_suffix (cpt, "Nightly", "C");
+	as_component_set_origin (cpt, origin);
+	as_component_set_scope (cpt, AS_COMPONENT_SCOPE_USER);
+	as_component_set_branch (cpt, "stable");
+
+	return cpt;
+}
+
+/**
+ * test_daemon_roundtrip:
+ *
+ * Components sent by the query daemon must be identical
+ * to the ones a query on the pool returns.
+ */
+static void
+test_daemon_roundtrip (void)
+{
+	g_autoptr(AsComponentBox) cbox = NULL;
+	g_autoptr(AsComponentBox) result = NULL;
+	g_autoptr(AsComponent) cpt1 = NULL;
+	g_autoptr(AsComponent) cpt2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *data = NULL;
+	AsComponent *cpt;
+
+	cpt1 = asx_new_internal_component ("org.example.One", "example-main");
+	cpt2 = asx_new_internal_component ("org.example.Two", "example-extra");
+	as_component_set_scope (cpt2, AS_COMPONENT_SCOPE_SYSTEM);
+
+	cbox = as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+	as_component_box_add (cbox, cpt1, NULL);
+	as_component_box_add (cbox, cpt2, NULL);
+
+	data = ascli_daemon_components_to_data (cbox, "C", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data);
+
+	result = ascli_daemon_components_from_data (data, -1, "C", &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (as_component_box_len (result), ==, 2);
+
+	cpt = as_component_box_index (result, 0);
+	g_assert_cmpstr (as_component_get_id (cpt), ==, "org.example.One");
+	g_assert_cmpstr (as_component_get_origin (cpt), ==, "example-main");
+	g_assert_cmpint (as_component_get_scope (cpt), ==, AS_COMPONENT_SCOPE_USER);
+	g_assert_cmpstr (as_component_get_branch (cpt), ==, "stable");
+	g_assert_cmpstr (as_component_get_name_variant_suffix (cpt), ==, "Nightly");
+
+	cpt = as_component_box_index (result, 1);
+	g_assert_cmpstr (as_component_get_id (cpt), ==, "org.example.Two");
+	g_assert_cmpstr (as_component_get_origin (cpt), ==, "example-extra");
+	g_assert_cmpint (as_component_get_scope (cpt), ==, AS_COMPONENT_SCOPE_SYSTEM);
+}
+
+/**
+ * test_daemon_json_output:
+ *
+ * Test JSON output of components received from the query daemon.
+ */
+static void
+test_daemon_json_output (void)
+{
+	g_autoptr(AsComponentBox) cbox = NULL;
+	g_autoptr(AsComponentBox) result = NULL;
+	g_autoptr(AsComponent) cpt = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *data = NULL;
+	g_autofree gchar *json = NULL;
+	g_auto(GStrv) fields = NULL;
+
+	cpt = asx_new_internal_component ("org.example.One", "example-main");
+	cbox = as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+	as_component_box_add (cbox, cpt, NULL);
+
+	data = ascli_daemon_components_to_data (cbox, "C", &error);
+	g_assert_no_error (error);
+	result = ascli_daemon_components_from_data (data, -1, "C", &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (as_component_box_len (result), ==, 1);
+
+	/* fields that are selected more than once are only written once */
+	fields = g_strsplit ("id,origin,id", ",", -1);
+	json = ascli_component_to_json_string (as_component_box_index (result, 0), fields);
+	g_assert_cmpstr (json, ==, "{\"id\":\"org.example.One\",\"origin\":\"example-main\"}");
+}
+
+int
+main (int argc, char **argv)
+{
+	int ret;
+
+	g_setenv ("G_MESSAGES_DEBUG", "all", TRUE);
+	g_test_init (&argc, &argv, NULL);
+
+	/* only critical and error are fatal */
+	g_log_set_fatal_mask (NULL, G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL);
+
+	g_test_add_func ("/AppStream/CLI/DaemonRoundtrip", test_daemon_roundtrip);
+	g_test_add_func ("/AppStream/CLI/DaemonJsonOutput", test_daemon_json_output);
+
+	ret = g_test_run ();
+	return ret;
+}
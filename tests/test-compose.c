@@ -19,6 +19,7 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include "appstream-compose.h"
 #include "asc-font-private.h"
 #include "asc-utils-metainfo.h"
@@ -28,6 +29,9 @@
 #include "asc-image.h"
 #include "asc-canvas.h"
 #include "asc-canvas-private.h"
+#include "asc-media-registry.h"
+#include "asc-result-private.h"
+#include "asc-trace.h"
 
 #include "as-utils-private.h"
 #include "as-test-utils.h"
@@ -217,6 +221,50 @@ test_read_fontinfo (void)
 			 "Five or six big jet planes zoomed quickly past the tower.");
 }
 
+static gpointer
+test_read_fontinfo_thread_cb (gpointer data)
+{
+	GBytes *bytes = data;
+	g_autoptr(AscFont) font = NULL;
+	g_autoptr(GError) error = NULL;
+
+	for (guint i = 0; i < 8; i++) {
+		g_clear_object (&font);
+		font = asc_font_new_from_bytes (bytes, "NotoSans-Regular.ttf", &error);
+		g_assert_no_error (error);
+		g_assert_cmpstr (asc_font_get_family (font), ==, "Noto Sans");
+		g_assert_cmpstr (asc_font_get_style (font), ==, "Regular");
+	}
+
+	return NULL;
+}
+
+/**
+ * test_read_fontinfo_parallel:
+ *
+ * Load fonts from memory in multiple threads at once.
+ */
+static void
+test_read_fontinfo_parallel (void)
+{
+	g_autofree gchar *font_fname = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GError) error = NULL;
+	GThread *threads[6];
+	gchar *data = NULL;
+	gsize data_len;
+
+	font_fname = g_build_filename (datadir, "NotoSans-Regular.ttf", NULL);
+	g_file_get_contents (font_fname, &data, &data_len, &error);
+	g_assert_no_error (error);
+	bytes = g_bytes_new_take (data, data_len);
+
+	for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+		threads[i] = g_thread_new ("font-load", test_read_fontinfo_thread_cb, bytes);
+	for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+		g_thread_join (threads[i]);
+}
+
 /**
  * test_image_transform:
  *
@@ -346,6 +394,228 @@ test_canvas (void)
 	g_assert_no_error (error);
 }
 
+static gpointer
+test_canvas_parallel_thread_cb (gpointer data)
+{
+	GBytes *svg_bytes = data;
+	g_autofree gchar *font_fname = NULL;
+	g_autoptr(AscFont) font = NULL;
+	g_autoptr(GError) error = NULL;
+
+	font_fname = g_build_filename (datadir, "NotoSans-Regular.ttf", NULL);
+	font = asc_font_new_from_file (font_fname, &error);
+	g_assert_no_error (error);
+
+	for (guint i = 0; i < 4; i++) {
+		g_autoptr(AscCanvas) cv = NULL;
+		g_autoptr(GInputStream) stream = NULL;
+		gboolean ret;
+
+		stream = g_memory_input_stream_new_from_bytes (svg_bytes);
+		cv = asc_canvas_new (128, 128);
+		ret = asc_canvas_render_svg (cv, stream, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		g_clear_object (&cv);
+
+		cv = asc_canvas_new (64, 64);
+		ret = asc_canvas_draw_text_line (cv, font, "Aa", -1, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+	}
+
+	return NULL;
+}
+
+/**
+ * test_canvas_parallel:
+ *
+ * Render SVG graphics and text on multiple threads at once.
+ */
+static void
+test_canvas_parallel (void)
+{
+	g_autofree gchar *sample_svg_fname = NULL;
+	g_autoptr(GBytes) svg_bytes = NULL;
+	g_autoptr(GError) error = NULL;
+	GThread *threads[4];
+	gchar *data = NULL;
+	gsize data_len;
+
+	sample_svg_fname = g_build_filename (datadir, "table.svgz", NULL);
+	g_file_get_contents (sample_svg_fname, &data, &data_len, &error);
+	g_assert_no_error (error);
+	svg_bytes = g_bytes_new_take (data, data_len);
+
+	for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+		threads[i] = g_thread_new ("canvas-render",
+					   test_canvas_parallel_thread_cb,
+					   svg_bytes);
+	for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+		g_thread_join (threads[i]);
+}
+
+/**
+ * test_svg_cache:
+ *
+ * Test rendering SVG graphics via the parsed-document cache.
+ */
+static void
+test_svg_cache (void)
+{
+	g_autofree gchar *sample_svg_fname = NULL;
+	g_autoptr(AscSvgCache) cache = NULL;
+	g_autoptr(GBytes) svgz_bytes = NULL;
+	g_autoptr(GBytes) svg_bytes = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GdkPixbuf) pix_red = NULL;
+	AscSvgCacheStats stats;
+	const guchar *pixels;
+	gchar *data = NULL;
+	gsize data_len;
+	const gchar *simple_svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"16\" height=\"16\">"
+				  "<rect width=\"16\" height=\"16\" fill=\"#ff0000\"/></svg>";
+	const guint sizes[] = { 48, 64, 128 };
+
+	sample_svg_fname = g_build_filename (datadir, "table.svgz", NULL);
+	g_file_get_contents (sample_svg_fname, &data, &data_len, &error);
+	g_assert_no_error (error);
+	svgz_bytes = g_bytes_new_take (data, data_len);
+	svg_bytes = g_bytes_new_static (simple_svg, strlen (simple_svg));
+
+	/* one document, rendered in all sizes */
+	cache = asc_svg_cache_new (1024 * 1024);
+	for (guint i = 0; i < G_N_ELEMENTS (sizes); i++) {
+		g_autoptr(GdkPixbuf) pix = NULL;
+
+		pix = asc_svg_cache_render (cache, svgz_bytes, sizes[i], &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (gdk_pixbuf_get_width (pix), ==, sizes[i]);
+		g_assert_cmpint (gdk_pixbuf_get_height (pix), ==, sizes[i]);
+	}
+	asc_svg_cache_get_stats (cache, &stats);
+	g_assert_cmpint (stats.n_parsed, ==, 1);
+	g_assert_cmpint (stats.n_hits, ==, 2);
+	g_assert_cmpint (stats.n_rendered, ==, 3);
+	g_assert_cmpint (stats.n_evicted, ==, 0);
+
+	/* colors must survive the conversion from Cairo's premultiplied format */
+	pix_red = asc_svg_cache_render (cache, svg_bytes, 16, &error);
+	g_assert_no_error (error);
+	pixels = gdk_pixbuf_get_pixels (pix_red);
+	g_assert_cmpint (pixels[0], ==, 0xff);
+	g_assert_cmpint (pixels[1], ==, 0x00);
+	g_assert_cmpint (pixels[2], ==, 0x00);
+	g_assert_cmpint (pixels[3], ==, 0xff);
+
+	/* a cleared cache must be usable again */
+	asc_svg_cache_clear (cache);
+	g_clear_object (&pix_red);
+	pix_red = asc_svg_cache_render (cache, svg_bytes, 16, &error);
+	g_assert_no_error (error);
+	asc_svg_cache_get_stats (cache, &stats);
+	g_assert_cmpint (stats.n_parsed, ==, 1);
+	g_assert_cmpint (stats.n_hits, ==, 0);
+	asc_svg_cache_free (g_steal_pointer (&cache));
+
+	/* a tiny cache only keeps the most recent document */
+	cache = asc_svg_cache_new (1);
+	for (guint i = 0; i < 2; i++) {
+		g_autoptr(GdkPixbuf) pix1 = NULL;
+		g_autoptr(GdkPixbuf) pix2 = NULL;
+
+		pix1 = asc_svg_cache_render (cache, svgz_bytes, 64, &error);
+		g_assert_no_error (error);
+		pix2 = asc_svg_cache_render (cache, svg_bytes, 64, &error);
+		g_assert_no_error (error);
+	}
+	asc_svg_cache_get_stats (cache, &stats);
+	g_assert_cmpint (stats.n_parsed, ==, 4);
+	g_assert_cmpint (stats.n_hits, ==, 0);
+	g_assert_cmpint (stats.n_evicted, ==, 3);
+}
+
+/**
+ * test_media_registry:
+ *
+ * Test reusing generated media files for identical input data.
+ */
+static void
+test_media_registry (void)
+{
+	g_autoptr(AscMediaRegistry) mreg = NULL;
+	g_autoptr(GBytes) data1 = NULL;
+	g_autoptr(GBytes) data2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *key1 = NULL;
+	g_autofree gchar *key2 = NULL;
+	g_autofree gchar *key3 = NULL;
+	g_autofree gchar *tmp_dir = NULL;
+	g_autofree gchar *orig_fname = NULL;
+	g_autofree gchar *dest_fname = NULL;
+	g_autofree gchar *orig_dir = NULL;
+	g_autofree gchar *dest_dir = NULL;
+	AscMediaRegistryStats stats;
+	GStatBuf orig_stat, dest_stat;
+	guint width = 0;
+	guint height = 0;
+
+	tmp_dir = g_build_filename (g_get_tmp_dir (), "asc-media-registry-test", NULL);
+	as_utils_delete_dir_recursive (tmp_dir);
+	orig_fname = g_build_filename (tmp_dir, "a", "icon.png", NULL);
+	dest_fname = g_build_filename (tmp_dir, "b", "icon.png", NULL);
+	orig_dir = g_path_get_dirname (orig_fname);
+	dest_dir = g_path_get_dirname (dest_fname);
+	g_mkdir_with_parents (orig_dir, 0755);
+	g_mkdir_with_parents (dest_dir, 0755);
+
+	data1 = g_bytes_new_static ("icon-data", 9);
+	data2 = g_bytes_new_static ("other-data", 10);
+	key1 = asc_media_registry_make_key (data1, "64x64");
+	key2 = asc_media_registry_make_key (data1, "128x128");
+	key3 = asc_media_registry_make_key (data2, "64x64");
+	g_assert_cmpstr (key1, !=, key2);
+	g_assert_cmpstr (key1, !=, key3);
+
+	mreg = asc_media_registry_new ();
+
+	/* nothing registered yet, an existing target file is removed */
+	g_file_set_contents (dest_fname, "stale", -1, NULL);
+	g_assert_false (asc_media_registry_reuse (mreg, key1, dest_fname, NULL, NULL));
+	g_assert_false (g_file_test (dest_fname, G_FILE_TEST_EXISTS));
+
+	/* register a generated file and reuse it */
+	g_file_set_contents (orig_fname, "generated-png-data", -1, &error);
+	g_assert_no_error (error);
+	asc_media_registry_add (mreg, key1, orig_fname, 64, 48, 1000);
+
+	g_assert_true (asc_media_registry_lookup (mreg, key1, &width, &height));
+	g_assert_cmpint (width, ==, 64);
+	g_assert_cmpint (height, ==, 48);
+	g_assert_false (asc_media_registry_lookup (mreg, key2, NULL, NULL));
+
+	width = height = 0;
+	g_assert_true (asc_media_registry_reuse (mreg, key1, dest_fname, &width, &height));
+	g_assert_cmpint (width, ==, 64);
+	g_assert_cmpint (height, ==, 48);
+	g_assert_cmpint (g_stat (orig_fname, &orig_stat), ==, 0);
+	g_assert_cmpint (g_stat (dest_fname, &dest_stat), ==, 0);
+	g_assert_cmpint (orig_stat.st_ino, ==, dest_stat.st_ino);
+
+	asc_media_registry_get_stats (mreg, &stats);
+	g_assert_cmpint (stats.n_reused, ==, 1);
+	g_assert_cmpint (stats.bytes_saved, ==, 18);
+	g_assert_cmpint (stats.usec_saved, ==, 1000);
+
+	/* entries whose file vanished are dropped */
+	g_remove (dest_fname);
+	g_remove (orig_fname);
+	g_assert_false (asc_media_registry_reuse (mreg, key1, dest_fname, NULL, NULL));
+	g_assert_false (asc_media_registry_lookup (mreg, key1, NULL, NULL));
+
+	as_utils_delete_dir_recursive (tmp_dir);
+}
+
 /**
  * test_compose_hints:
  *
@@ -388,6 +658,33 @@ test_compose_hints (void)
 	    ==,
 	    "This is an explanation for the compose testsuite which contains 3 placeholders, "
 	    "including one {odd} one and one left {{invalid}} intentionally.");
+
+	/* register custom tags */
+	g_assert_true (asc_globals_add_hint_tag ("dev-testsuite-custom",
+						 AS_ISSUE_SEVERITY_WARNING,
+						 "A custom tag.",
+						 FALSE));
+	g_assert_false (asc_globals_add_hint_tag ("dev-testsuite-custom",
+						  AS_ISSUE_SEVERITY_INFO,
+						  "Not replaced.",
+						  FALSE));
+	g_assert_cmpstr (asc_globals_hint_tag_explanation ("dev-testsuite-custom"),
+			 ==,
+			 "A custom tag.");
+
+	/* override an existing tag */
+	g_assert_true (asc_globals_add_hint_tag ("dev-testsuite-custom",
+						 AS_ISSUE_SEVERITY_WARNING,
+						 "A replaced custom tag.",
+						 TRUE));
+	g_assert_cmpstr (asc_globals_hint_tag_explanation ("dev-testsuite-custom"),
+			 ==,
+			 "A replaced custom tag.");
+
+	/* previously registered tags must still be known */
+	g_assert_cmpint (asc_globals_hint_tag_severity ("internal-unknown-tag"),
+			 ==,
+			 AS_ISSUE_SEVERITY_ERROR);
 }
 
 /**
@@ -399,6 +696,7 @@ static void
 test_compose_result (void)
 {
 	g_autoptr(AscResult) cres = NULL;
+	g_autoptr(AscResult) cres_fast = NULL;
 	g_autoptr(AsComponent) cpt = NULL;
 	g_autoptr(GError) error = NULL;
 	GPtrArray *hints;
@@ -424,8 +722,16 @@ test_compose_result (void)
 	g_assert_cmpint (asc_result_components_count (cres), ==, 1);
 	g_assert_cmpint (asc_result_hints_count (cres), ==, 1);
 
+	/* the default MD5 GCID must not change, it determines media paths */
+	g_assert_cmpstr (asc_result_gcid_for_component (cres, cpt),
+			 ==,
+			 "org/freedesktop/appstream.dummy/7108287871ae6ac168fe01dc496f11ba");
+
 	ret = asc_result_update_component_gcid_with_string (cres, cpt, "<moredata>");
 	g_assert_true (ret);
+	g_assert_cmpstr (asc_result_gcid_for_component (cres, cpt),
+			 ==,
+			 "org/freedesktop/appstream.dummy/5ccb0e3ff709cc90c2b1d4a7029fdfaf");
 
 	g_assert_true (asc_result_get_component (cres, "org.freedesktop.appstream.dummy") == cpt);
 
@@ -454,6 +760,25 @@ test_compose_result (void)
 	tmp = asc_hint_format_explanation (ASC_HINT (g_ptr_array_index (hints, 1)));
 	g_assert_cmpstr (tmp, ==, "Dummy error hint for the testsuite. Var1: testvalue-error.");
 	g_free (tmp);
+
+	/* the fast hash is optional, but if we have it, it must produce GCIDs of the same shape */
+	cres_fast = asc_result_new ();
+	if (asc_result_set_gcid_hash_kind (cres_fast, ASC_GCID_HASH_KIND_XXH3)) {
+		const gchar *gcid;
+
+		ret = asc_result_add_component_with_string (cres_fast, cpt, "<testdata>", &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+
+		gcid = asc_result_gcid_for_component (cres_fast, cpt);
+		g_assert_true (g_str_has_prefix (gcid, "org/freedesktop/appstream.dummy/"));
+		g_assert_cmpint (strlen (gcid), ==, strlen ("org/freedesktop/appstream.dummy/") + 32);
+		g_assert_cmpstr (gcid,
+				 !=,
+				 "org/freedesktop/appstream.dummy/7108287871ae6ac168fe01dc496f11ba");
+	} else {
+		g_assert_cmpint (asc_result_get_gcid_hash_kind (cres_fast), ==, ASC_GCID_HASH_KIND_MD5);
+	}
 }
 
 /**
@@ -663,7 +988,7 @@ test_compose_directory_unit (void)
 	g_assert_true (ret);
 
 	contents = asc_unit_get_contents (ASC_UNIT (dirunit));
-	g_assert_cmpint (contents->len, ==, 15);
+	g_assert_cmpint (contents->len, ==, 17);
 	as_sort_strings (contents);
 
 	g_assert_cmpstr (g_ptr_array_index (contents, 0), ==, "/Noto.LICENSE");
@@ -762,6 +1087,74 @@ test_compose_locale_stats (void)
 	g_assert_cmpint (as_component_get_language (cpt, "de"), ==, 100);
 }
 
+/**
+ * test_compose_locale_multidomain:
+ *
+ * Test reading translation status from multiple domains and locale directories.
+ */
+static void
+test_compose_locale_multidomain (void)
+{
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AscResult) cres = NULL;
+	g_autoptr(AsComponent) cpt = NULL;
+	g_autoptr(AsComponent) cpt_broken = NULL;
+	g_autoptr(AsTranslation) tr1 = NULL;
+	g_autoptr(AsTranslation) tr2 = NULL;
+	g_autoptr(AsTranslation) tr3 = NULL;
+	g_autoptr(AscDirectoryUnit) dirunit = asc_directory_unit_new (datadir);
+	GPtrArray *hints;
+
+	ret = asc_unit_open (ASC_UNIT (dirunit), &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* component with translations in two domains, one of them in a langpack directory */
+	cpt = as_component_new ();
+	as_component_set_id (cpt, "org.freedesktop.appstream.multidomain");
+	tr1 = as_translation_new ();
+	as_translation_set_kind (tr1, AS_TRANSLATION_KIND_GETTEXT);
+	as_translation_set_id (tr1, "app");
+	as_component_add_translation (cpt, tr1);
+	tr2 = as_translation_new ();
+	as_translation_set_kind (tr2, AS_TRANSLATION_KIND_GETTEXT);
+	as_translation_set_id (tr2, "langpack");
+	as_component_add_translation (cpt, tr2);
+
+	/* component with a truncated translation file */
+	cpt_broken = as_component_new ();
+	as_component_set_id (cpt_broken, "org.freedesktop.appstream.broken");
+	tr3 = as_translation_new ();
+	as_translation_set_kind (tr3, AS_TRANSLATION_KIND_GETTEXT);
+	as_translation_set_id (tr3, "broken");
+	as_component_add_translation (cpt_broken, tr3);
+
+	cres = asc_result_new ();
+	ret = asc_result_add_component_with_string (cres, cpt, "<testdata>", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = asc_result_add_component_with_string (cres, cpt_broken, "<testdata2>", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	asc_read_translation_status (cres, ASC_UNIT (dirunit), "/usr", 25);
+
+	g_assert_cmpint (as_component_get_language (cpt, "en_GB"), ==, 100);
+	g_assert_cmpint (as_component_get_language (cpt, "ru"), ==, 33);
+	g_assert_cmpint (as_component_get_language (cpt, "pt_BR"), ==, 100);
+	g_assert_cmpint (as_component_get_language (cpt, "de"), ==, -1);
+	g_assert_null (asc_result_get_hints (cres, "org.freedesktop.appstream.multidomain"));
+
+	hints = asc_result_get_hints (cres, "org.freedesktop.appstream.broken");
+	g_assert_nonnull (hints);
+	g_assert_cmpint (hints->len, ==, 1);
+	g_assert_cmpstr (asc_hint_get_tag (ASC_HINT (g_ptr_array_index (hints, 0))),
+			 ==,
+			 "translation-status-error");
+	g_assert_cmpint (as_component_get_language (cpt_broken, "de"), ==, -1);
+}
+
 static void
 test_compose_source_locale (void)
 {
@@ -908,6 +1301,445 @@ test_compose_font (void)
 	asc_assert_no_hints_in_result (cres);
 }
 
+/**
+ * asc_test_create_units:
+ *
+ * Create a number of directory units containing one simple
+ * metainfo file each. If @description is %NULL, a short default
+ * description is used.
+ */
+static GPtrArray *
+asc_test_create_units (const gchar *root_dir,
+		       guint n_units,
+		       const gchar *cid_prefix,
+		       const gchar *description)
+{
+	GPtrArray *units = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (guint i = 0; i < n_units; i++) {
+		g_autoptr(GError) error = NULL;
+		g_autofree gchar *unit_dir = NULL;
+		g_autofree gchar *mi_dir = NULL;
+		g_autofree gchar *mi_fname = NULL;
+		g_autofree gchar *mi_data = NULL;
+		g_autofree gchar *cid = NULL;
+		AscDirectoryUnit *dirunit;
+
+		unit_dir = g_strdup_printf ("%s/unit%03u", root_dir, i);
+		mi_dir = g_build_filename (unit_dir, "usr", "share", "metainfo", NULL);
+		g_assert_cmpint (g_mkdir_with_parents (mi_dir, 0755), ==, 0);
+
+		cid = g_strdup_printf ("%s%03u", cid_prefix, i);
+		mi_fname = g_strdup_printf ("%s/%s.metainfo.xml", mi_dir, cid);
+		mi_data = g_strdup_printf ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+					   "<component type=\"console-application\">\n"
+					   "  <id>%s</id>\n"
+					   "  <name>Test %u</name>\n"
+					   "  <summary>Test tool number %u</summary>\n"
+					   "  <description>%s</description>\n"
+					   "  <metadata_license>FSFAP</metadata_license>\n"
+					   "</component>\n",
+					   cid,
+					   i,
+					   i,
+					   description != NULL ? description : "<p>Does things.</p>");
+		g_file_set_contents (mi_fname, mi_data, -1, &error);
+		g_assert_no_error (error);
+
+		dirunit = asc_directory_unit_new (unit_dir);
+		asc_unit_set_bundle_id (ASC_UNIT (dirunit), cid);
+		g_ptr_array_add (units, dirunit);
+	}
+
+	return units;
+}
+
+/**
+ * test_compose_catalog_stream:
+ *
+ * Test that catalog data is streamed to disk in unit order.
+ */
+static void
+test_compose_catalog_stream (void)
+{
+	gboolean ret;
+	GPtrArray *results;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AscCompose) compose = NULL;
+	g_autoptr(AsMetadata) mdata = NULL;
+	g_autoptr(GPtrArray) units = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autofree gchar *data_dir = NULL;
+	g_autofree gchar *catalog_fname = NULL;
+	g_autofree gchar *part_fname = NULL;
+	GPtrArray *cpts;
+	const gchar *tmpdir = "/tmp/asc-catalog-stream-test";
+
+	if (g_file_test (tmpdir, G_FILE_TEST_EXISTS)) {
+		ret = as_utils_delete_dir_recursive (tmpdir);
+		g_assert_true (ret);
+	}
+
+	units = asc_test_create_units (tmpdir, 24, "org.example.streamtest", NULL);
+	data_dir = g_build_filename (tmpdir, "data", NULL);
+
+	compose = asc_compose_new ();
+	asc_compose_set_origin (compose, "streamtest");
+	asc_compose_set_flags (compose,
+			       ASC_COMPOSE_FLAG_USE_THREADS | ASC_COMPOSE_FLAG_IGNORE_ICONS);
+	asc_compose_set_data_result_dir (compose, data_dir);
+	for (guint i = 0; i < units->len; i++)
+		asc_compose_add_unit (compose, ASC_UNIT (g_ptr_array_index (units, i)));
+
+	results = asc_compose_run (compose, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results);
+	g_assert_cmpint (results->len, ==, 24);
+
+	/* the partial file must be gone */
+	catalog_fname = g_build_filename (data_dir, "streamtest.xml.gz", NULL);
+	part_fname = g_strconcat (catalog_fname, ".part", NULL);
+	g_assert_true (g_file_test (catalog_fname, G_FILE_TEST_EXISTS));
+	g_assert_false (g_file_test (part_fname, G_FILE_TEST_EXISTS));
+
+	/* components must be written in unit order */
+	mdata = as_metadata_new ();
+	file = g_file_new_for_path (catalog_fname);
+	ret = as_metadata_parse_file (mdata, file, AS_FORMAT_KIND_XML, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	cpts = as_metadata_get_components (mdata);
+	g_assert_cmpint (cpts->len, ==, 24);
+	for (guint i = 0; i < cpts->len; i++) {
+		g_autofree gchar *expected_cid = g_strdup_printf ("org.example.streamtest%03u", i);
+		AsComponent *cpt = AS_COMPONENT (g_ptr_array_index (cpts, i));
+		g_assert_cmpstr (as_component_get_id (cpt), ==, expected_cid);
+		g_assert_cmpstr (as_component_get_origin (cpt), ==, "streamtest");
+	}
+
+	ret = as_utils_delete_dir_recursive (tmpdir);
+	g_assert_true (ret);
+}
+
+/**
+ * test_compose_duplicates:
+ *
+ * Test that the first unit providing a component ID always wins,
+ * regardless of the order units are processed in.
+ */
+static void
+test_compose_duplicates (void)
+{
+	gboolean ret;
+	const guint n_units = 12;
+	const gchar *tmpdir = "/tmp/asc-duplicates-test";
+
+	if (g_file_test (tmpdir, G_FILE_TEST_EXISTS)) {
+		ret = as_utils_delete_dir_recursive (tmpdir);
+		g_assert_true (ret);
+	}
+
+	for (guint run = 0; run < 4; run++) {
+		GPtrArray *results;
+		g_autoptr(GError) error = NULL;
+		g_autoptr(AscCompose) compose = NULL;
+		g_autoptr(AsMetadata) mdata = NULL;
+		g_autoptr(GFile) file = NULL;
+		g_autofree gchar *data_dir = NULL;
+		g_autofree gchar *catalog_fname = NULL;
+
+		data_dir = g_build_filename (tmpdir, "data", NULL);
+		compose = asc_compose_new ();
+		asc_compose_set_origin (compose, "duptest");
+		asc_compose_set_flags (compose,
+				       ASC_COMPOSE_FLAG_USE_THREADS | ASC_COMPOSE_FLAG_IGNORE_ICONS);
+		/* check both with and without streaming the catalog */
+		if (run % 2 == 0)
+			asc_compose_set_data_result_dir (compose, data_dir);
+
+		for (guint i = 0; i < n_units; i++) {
+			g_autoptr(GPtrArray) units = NULL;
+			g_autofree gchar *unit_root = g_strdup_printf ("%s/dup%02u", tmpdir, i);
+
+			/* every unit provides the very same component */
+			units = asc_test_create_units (unit_root, 1, "org.example.duplicate", NULL);
+			asc_compose_add_unit (compose, ASC_UNIT (g_ptr_array_index (units, 0)));
+		}
+
+		results = asc_compose_run (compose, NULL, &error);
+		g_assert_no_error (error);
+		g_assert_nonnull (results);
+		g_assert_cmpint (results->len, ==, n_units);
+
+		for (guint i = 0; i < results->len; i++) {
+			AscResult *cres = ASC_RESULT (g_ptr_array_index (results, i));
+			GPtrArray *hints = asc_result_get_hints (cres, "org.example.duplicate000");
+			guint n_dup_hints = 0;
+
+			for (guint j = 0; hints != NULL && j < hints->len; j++) {
+				AscHint *hint = ASC_HINT (g_ptr_array_index (hints, j));
+				if (g_strcmp0 (asc_hint_get_tag (hint), "duplicate-component") == 0)
+					n_dup_hints++;
+			}
+
+			g_assert_cmpint (asc_result_components_count (cres), ==, i == 0 ? 1 : 0);
+			g_assert_cmpint (n_dup_hints, ==, i == 0 ? 0 : 1);
+		}
+
+		if (run % 2 != 0)
+			continue;
+
+		/* the catalog must only contain the component once */
+		catalog_fname = g_build_filename (data_dir, "duptest.xml.gz", NULL);
+		mdata = as_metadata_new ();
+		file = g_file_new_for_path (catalog_fname);
+		ret = as_metadata_parse_file (mdata, file, AS_FORMAT_KIND_XML, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		g_assert_cmpint (as_metadata_get_components (mdata)->len, ==, 1);
+	}
+
+	ret = as_utils_delete_dir_recursive (tmpdir);
+	g_assert_true (ret);
+}
+
+/**
+ * test_compose_trace:
+ *
+ * Test recording a trace of the compose stages.
+ */
+static void
+test_compose_trace (void)
+{
+	gboolean ret;
+	GPtrArray *results;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AscCompose) compose = NULL;
+	g_autoptr(GPtrArray) units = NULL;
+	g_autoptr(AscTrace) trace = NULL;
+	g_autofree gchar *trace_fname = NULL;
+	g_autofree gchar *trace_data = NULL;
+	g_autofree gchar *summary = NULL;
+	g_autofree gchar *json = NULL;
+	g_auto(GStrv) parts = NULL;
+	const gchar *tmpdir = "/tmp/asc-trace-test";
+
+	/* spans are recorded with properly escaped names */
+	trace = asc_trace_new ();
+	asc_trace_end (trace, asc_trace_begin (trace), "validate", "unit\"1\"", "org.example.A");
+	asc_trace_end (NULL, asc_trace_begin (NULL), "validate", NULL, NULL);
+	g_assert_cmpint (asc_trace_get_events_count (trace), ==, 1);
+	json = asc_trace_to_json (trace);
+	g_assert_nonnull (strstr (json, "\"name\":\"validate\""));
+	g_assert_nonnull (strstr (json, "\"ph\":\"X\""));
+	g_assert_nonnull (strstr (json, "\"unit\":\"unit\\\"1\\\"\",\"component\":\"org.example.A\""));
+
+	if (g_file_test (tmpdir, G_FILE_TEST_EXISTS)) {
+		ret = as_utils_delete_dir_recursive (tmpdir);
+		g_assert_true (ret);
+	}
+
+	units = asc_test_create_units (tmpdir, 8, "org.example.tracetest", NULL);
+	trace_fname = g_build_filename (tmpdir, "trace.json", NULL);
+
+	compose = asc_compose_new ();
+	asc_compose_set_origin (compose, "tracetest");
+	asc_compose_set_flags (compose,
+			       ASC_COMPOSE_FLAG_USE_THREADS | ASC_COMPOSE_FLAG_VALIDATE |
+				   ASC_COMPOSE_FLAG_IGNORE_ICONS);
+	for (guint i = 0; i < units->len; i++)
+		asc_compose_add_unit (compose, ASC_UNIT (g_ptr_array_index (units, i)));
+
+	/* no trace unless requested */
+	g_assert_null (asc_compose_get_trace_summary (compose));
+	asc_compose_set_trace_filename (compose, trace_fname);
+
+	results = asc_compose_run (compose, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results);
+
+	ret = g_file_get_contents (trace_fname, &trace_data, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_true (g_str_has_prefix (trace_data, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+
+	/* one span per unit, and one parse and validation span per component */
+	parts = g_strsplit (trace_data, "\"name\":\"unit\"", -1);
+	g_assert_cmpint (g_strv_length (parts), ==, 8 + 1);
+	g_clear_pointer (&parts, g_strfreev);
+	parts = g_strsplit (trace_data, "\"name\":\"validate\"", -1);
+	g_assert_cmpint (g_strv_length (parts), ==, 8 + 1);
+	g_assert_nonnull (strstr (trace_data, "\"component\":\"org.example.tracetest003\""));
+
+	summary = asc_compose_get_trace_summary (compose);
+	g_assert_nonnull (summary);
+	g_assert_true (g_str_has_prefix (summary, "Stage"));
+	g_assert_nonnull (strstr (summary, "metainfo-parse"));
+
+	/* icons were ignored, so no media statistics are available */
+	g_assert_null (asc_compose_get_statistics_summary (compose));
+
+	ret = as_utils_delete_dir_recursive (tmpdir);
+	g_assert_true (ret);
+}
+
+/**
+ * test_compose_many_units:
+ *
+ * Test processing many tiny units, which reuses the per-worker
+ * metadata, validator and networking objects between units.
+ * Run with "-m perf" to process 10,000 units and report the per-unit overhead.
+ */
+static void
+test_compose_many_units (void)
+{
+	gboolean ret;
+	GPtrArray *results;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AscCompose) compose = NULL;
+	g_autoptr(GPtrArray) units = NULL;
+	g_autoptr(GTimer) timer = NULL;
+	guint n_units = g_test_perf () ? 10000 : 200;
+	guint n_hints;
+	gdouble usec_per_unit;
+	const gchar *tmpdir = "/tmp/asc-many-units-test";
+
+	if (g_file_test (tmpdir, G_FILE_TEST_EXISTS)) {
+		ret = as_utils_delete_dir_recursive (tmpdir);
+		g_assert_true (ret);
+	}
+
+	units = asc_test_create_units (tmpdir, n_units, "org.example.manyunits", NULL);
+
+	compose = asc_compose_new ();
+	asc_compose_set_origin (compose, "manyunits");
+	asc_compose_set_flags (compose,
+			       ASC_COMPOSE_FLAG_USE_THREADS | ASC_COMPOSE_FLAG_VALIDATE |
+				   ASC_COMPOSE_FLAG_IGNORE_ICONS);
+	for (guint i = 0; i < units->len; i++)
+		asc_compose_add_unit (compose, ASC_UNIT (g_ptr_array_index (units, i)));
+
+	timer = g_timer_new ();
+	results = asc_compose_run (compose, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results);
+	g_assert_cmpint (results->len, ==, n_units);
+	usec_per_unit = g_timer_elapsed (timer, NULL) * G_USEC_PER_SEC / n_units;
+	g_test_minimized_result (usec_per_unit, "%.1f µs per unit", usec_per_unit);
+
+	/* all units are alike, no state must leak from one unit into the next */
+	n_hints = asc_result_hints_count (ASC_RESULT (g_ptr_array_index (results, 0)));
+	for (guint i = 0; i < results->len; i++) {
+		g_autofree gchar *expected_cid = g_strdup_printf ("org.example.manyunits%03u", i);
+		AscResult *cres = ASC_RESULT (g_ptr_array_index (results, i));
+
+		g_assert_cmpint (asc_result_components_count (cres), ==, 1);
+		g_assert_nonnull (asc_result_get_component (cres, expected_cid));
+		g_assert_cmpint (asc_result_hints_count (cres), ==, n_hints);
+	}
+
+	ret = as_utils_delete_dir_recursive (tmpdir);
+	g_assert_true (ret);
+}
+
+/**
+ * test_compose_spill_results:
+ *
+ * Test moving results to disk while composing and reading them back.
+ */
+static void
+test_compose_spill_results (void)
+{
+	gboolean ret;
+	GPtrArray *results;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AscCompose) compose = NULL;
+	g_autoptr(GPtrArray) units = NULL;
+	g_autoptr(GString) description = NULL;
+	g_autoptr(GPtrArray) cpts = NULL;
+	g_autofree gchar *spill_dir = NULL;
+	g_autofree gchar *spill_fname = NULL;
+	guint n_units = g_test_perf () ? 2000 : 200;
+	guint n_paras;
+	g_autofree gchar *last_para = NULL;
+	const gchar *cpt_desc;
+	AscResult *cres;
+	AsComponent *cpt;
+	const gchar *tmpdir = "/tmp/asc-spill-test";
+
+	if (g_file_test (tmpdir, G_FILE_TEST_EXISTS)) {
+		ret = as_utils_delete_dir_recursive (tmpdir);
+		g_assert_true (ret);
+	}
+
+	/* give every component a large description, 256 KiB each */
+	description = g_string_new ("");
+	for (n_paras = 0; description->len < 256 * 1024; n_paras++)
+		g_string_append_printf (description,
+					"<p>Paragraph %u of a very long description, which "
+					"takes up a lot of memory when kept around.</p>",
+					n_paras);
+	last_para = g_strdup_printf ("<p>Paragraph %u of", n_paras - 1);
+	units = asc_test_create_units (tmpdir, n_units, "org.example.spill", description->str);
+
+	compose = asc_compose_new ();
+	asc_compose_set_origin (compose, "spilltest");
+	asc_compose_set_flags (compose,
+			       ASC_COMPOSE_FLAG_IGNORE_ICONS | ASC_COMPOSE_FLAG_SPILL_RESULTS);
+	for (guint i = 0; i < units->len; i++)
+		asc_compose_add_unit (compose, ASC_UNIT (g_ptr_array_index (units, i)));
+
+	results = asc_compose_run (compose, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results);
+	g_assert_cmpint (results->len, ==, n_units);
+
+	/* without spilling, all descriptions would be held in memory at this point */
+	for (guint i = 0; i < results->len; i++) {
+		const gchar *fname;
+
+		cres = ASC_RESULT (g_ptr_array_index (results, i));
+		g_assert_true (asc_result_components_spilled (cres));
+		g_assert_cmpint (asc_result_components_count (cres), ==, 1);
+		g_assert_false (asc_result_unit_ignored (cres));
+
+		fname = asc_result_get_spill_filename (cres);
+		g_assert_nonnull (fname);
+		g_assert_true (g_str_has_suffix (fname, ".gvz"));
+		g_assert_true (g_file_test (fname, G_FILE_TEST_IS_REGULAR));
+	}
+
+	/* data is read back in when accessed */
+	cres = ASC_RESULT (g_ptr_array_index (results, 0));
+	spill_fname = g_strdup (asc_result_get_spill_filename (cres));
+	spill_dir = g_path_get_dirname (spill_fname);
+	cpts = asc_result_fetch_components (cres);
+	g_assert_false (asc_result_components_spilled (cres));
+	g_assert_null (asc_result_get_spill_filename (cres));
+	g_assert_false (g_file_test (spill_fname, G_FILE_TEST_EXISTS));
+	g_assert_cmpint (cpts->len, ==, 1);
+	cpt = AS_COMPONENT (g_ptr_array_index (cpts, 0));
+	g_assert_cmpstr (as_component_get_id (cpt), ==, "org.example.spill000");
+	cpt_desc = as_component_get_description (cpt);
+	g_assert_nonnull (cpt_desc);
+	g_assert_nonnull (strstr (cpt_desc, "<p>Paragraph 0 of a very long description"));
+	g_assert_nonnull (strstr (cpt_desc, last_para));
+	g_assert_nonnull (asc_result_gcid_for_cid (cres, "org.example.spill000"));
+
+	/* data that catalog XML does not hold survives as well */
+	g_assert_cmpstr (as_component_get_origin (cpt), ==, "spilltest");
+	g_assert_nonnull (as_component_get_context (cpt));
+
+	/* resetting removes the files of all remaining spilled results */
+	g_assert_true (g_file_test (spill_dir, G_FILE_TEST_IS_DIR));
+	asc_compose_reset (compose);
+	g_assert_false (g_file_test (spill_dir, G_FILE_TEST_EXISTS));
+
+	ret = as_utils_delete_dir_recursive (tmpdir);
+	g_assert_true (ret);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -937,16 +1769,26 @@ main (int argc, char **argv)
 	g_test_add_func ("/AppStream/Compose/Utils", test_utils);
 	g_test_add_func ("/AppStream/Compose/IssueTagSanity", test_compose_issue_tag_sanity);
 	g_test_add_func ("/AppStream/Compose/FontInfo", test_read_fontinfo);
+	g_test_add_func ("/AppStream/Compose/FontInfoParallel", test_read_fontinfo_parallel);
 	g_test_add_func ("/AppStream/Compose/Image", test_image_transform);
 	g_test_add_func ("/AppStream/Compose/Canvas", test_canvas);
+	g_test_add_func ("/AppStream/Compose/CanvasParallel", test_canvas_parallel);
+	g_test_add_func ("/AppStream/Compose/SvgCache", test_svg_cache);
+	g_test_add_func ("/AppStream/Compose/MediaRegistry", test_media_registry);
 	g_test_add_func ("/AppStream/Compose/Hints", test_compose_hints);
 	g_test_add_func ("/AppStream/Compose/Result", test_compose_result);
 	g_test_add_func ("/AppStream/Compose/DesktopEntry", test_compose_desktop_entry);
 	g_test_add_func ("/AppStream/Compose/DirectoryUnit", test_compose_directory_unit);
 	g_test_add_func ("/AppStream/Compose/LocaleStats", test_compose_locale_stats);
+	g_test_add_func ("/AppStream/Compose/LocaleMultiDomain", test_compose_locale_multidomain);
 	g_test_add_func ("/AppStream/Compose/SourceLocale", test_compose_source_locale);
 	g_test_add_func ("/AppStream/Compose/VideoInfo", test_compose_video_info);
 	g_test_add_func ("/AppStream/Compose/Font", test_compose_font);
+	g_test_add_func ("/AppStream/Compose/CatalogStream", test_compose_catalog_stream);
+	g_test_add_func ("/AppStream/Compose/Duplicates", test_compose_duplicates);
+	g_test_add_func ("/AppStream/Compose/Trace", test_compose_trace);
+	g_test_add_func ("/AppStream/Compose/ManyUnits", test_compose_many_units);
+	g_test_add_func ("/AppStream/Compose/SpillResults", test_compose_spill_results);
 
 	ret = g_test_run ();
 	g_free (datadir);
@@ -19,6 +19,8 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
 #include "appstream.h"
 #include "as-news-convert.h"
 #include "as-utils-private.h"
@@ -400,6 +402,215 @@ test_relation_satisfy_check (void)
 	g_clear_pointer (&rcr, g_object_unref);
 }
 
+#if defined(__linux__)
+/**
+ * asx_write_fake_modalias:
+ *
+ * Helper to add a device with the given modalias to a fake sysfs tree.
+ */
+static void
+asx_write_fake_modalias (const gchar *sysfs_root, const gchar *device_path, const gchar *modalias)
+{
+	g_autofree gchar *device_dir = NULL;
+	g_autofree gchar *modalias_fname = NULL;
+	g_autofree gchar *contents = NULL;
+	g_autoptr(GError) error = NULL;
+
+	device_dir = g_build_filename (sysfs_root, device_path, NULL);
+	modalias_fname = g_build_filename (device_dir, "modalias", NULL);
+	contents = g_strconcat (modalias, "\n", NULL);
+
+	g_assert_cmpint (g_mkdir_with_parents (device_dir, 0755), ==, 0);
+	g_file_set_contents (modalias_fname, contents, -1, &error);
+	g_assert_no_error (error);
+}
+
+/**
+ * asx_new_modalias_component:
+ */
+static AsComponent *
+asx_new_modalias_component (const gchar *cid, const gchar *modalias_glob1, const gchar *modalias_glob2)
+{
+	AsComponent *cpt = as_component_new ();
+
+	as_component_set_kind (cpt, AS_COMPONENT_KIND_FIRMWARE);
+	as_component_set_id (cpt, cid);
+	as_component_add_provided_item (cpt, AS_PROVIDED_KIND_MODALIAS, modalias_glob1);
+	if (modalias_glob2 != NULL)
+		as_component_add_provided_item (cpt, AS_PROVIDED_KIND_MODALIAS, modalias_glob2);
+
+	return cpt;
+}
+
+/**
+ * test_modalias_matching:
+ *
+ * Match modalias globs against devices of a fake sysfs tree.
+ */
+static void
+test_modalias_matching (void)
+{
+	g_autoptr(AsSystemInfo) sysinfo = NULL;
+	g_autoptr(AsComponentBox) cbox = NULL;
+	g_autoptr(AsComponentBox) matches = NULL;
+	g_autoptr(AsComponent) cpt_usb = NULL;
+	g_autoptr(AsComponent) cpt_other = NULL;
+	g_autoptr(AsComponent) cpt_serial = NULL;
+	g_autofree gchar *sysfs_root = NULL;
+	g_autofree gchar *link_target = NULL;
+	g_autofree gchar *link_fname = NULL;
+	g_autoptr(GError) error = NULL;
+	GPtrArray *modaliases;
+
+	sysfs_root = g_dir_make_tmp ("as-test-sysfs-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	asx_write_fake_modalias (sysfs_root,
+				 "pci0000:00/0000:00:14.0",
+				 "pci:v00008086d0000A36Dsv00001028sd0000085Cbc0Csc03i30");
+	asx_write_fake_modalias (sysfs_root,
+				 "pci0000:00/0000:00:14.0/usb1/1-1",
+				 "usb:v1130p0202d0100dc00dsc00dp00ic03isc00ip00in00");
+	asx_write_fake_modalias (sysfs_root,
+				 "platform/serial8250",
+				 "platform:serial8250");
+
+	/* links must not be followed, or we would see devices twice */
+	link_target = g_build_filename (sysfs_root, "platform", NULL);
+	link_fname = g_build_filename (sysfs_root, "pci0000:00", "0000:00:14.0", "subsystem", NULL);
+	g_assert_cmpint (symlink (link_target, link_fname), ==, 0);
+
+	sysinfo = as_system_info_new ();
+	as_system_info_set_sysfs_devices_root (sysinfo, sysfs_root);
+
+	modaliases = as_system_info_get_modaliases (sysinfo);
+	g_assert_cmpint (modaliases->len, ==, 3);
+	g_assert_cmpstr (g_ptr_array_index (modaliases, 0),
+			 ==,
+			 "pci:v00008086d0000A36Dsv00001028sd0000085Cbc0Csc03i30");
+	g_assert_cmpstr (g_ptr_array_index (modaliases, 1), ==, "platform:serial8250");
+
+	/* single globs */
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "platform:serial8250"));
+	g_assert_false (as_system_info_has_device_matching_modalias (sysinfo, "platform:serial"));
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "usb:v1130p0202d*"));
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "pci:v00008086d*sv*"));
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "*:serial8250"));
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "usb:v1130p020?d*"));
+	g_assert_false (as_system_info_has_device_matching_modalias (sysinfo, "usb:v1130p0203d*"));
+	g_assert_false (as_system_info_has_device_matching_modalias (sysinfo, "acpi:*"));
+
+	/* batch matching of components */
+	cpt_usb = asx_new_modalias_component ("org.example.UsbFirmware",
+					      "usb:v9999p0001d*",
+					      "usb:v1130p0202d*");
+	cpt_other = asx_new_modalias_component ("org.example.OtherFirmware",
+						"usb:v9999p0001d*",
+						"pci:v000010DEd*");
+	cpt_serial = asx_new_modalias_component ("org.example.SerialDriver",
+						 "platform:serial8250",
+						 NULL);
+
+	cbox = as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+	as_component_box_add (cbox, cpt_usb, NULL);
+	as_component_box_add (cbox, cpt_other, NULL);
+	as_component_box_add (cbox, cpt_serial, NULL);
+
+	matches = as_system_info_get_components_matching_hardware (sysinfo, cbox);
+	g_assert_cmpint (as_component_box_len (matches), ==, 2);
+	g_assert_cmpstr (as_component_get_id (as_component_box_index (matches, 0)),
+			 ==,
+			 "org.example.UsbFirmware");
+	g_assert_cmpstr (as_component_get_id (as_component_box_index (matches, 1)),
+			 ==,
+			 "org.example.SerialDriver");
+
+	/* a tree without devices matches nothing */
+	g_clear_object (&matches);
+	as_system_info_set_sysfs_devices_root (sysinfo, link_target);
+	as_utils_delete_dir_recursive (link_target);
+	g_mkdir_with_parents (link_target, 0755);
+	g_assert_false (as_system_info_has_device_matching_modalias (sysinfo, "*"));
+	matches = as_system_info_get_components_matching_hardware (sysinfo, cbox);
+	g_assert_cmpint (as_component_box_len (matches), ==, 0);
+
+	g_remove (link_fname);
+	as_utils_delete_dir_recursive (sysfs_root);
+}
+
+/**
+ * asx_new_snapshot_sysinfo:
+ */
+static AsSystemInfo *
+asx_new_snapshot_sysinfo (const gchar *sysfs_root, const gchar *cache_fname, const gchar *boot_id)
+{
+	AsSystemInfo *sysinfo = as_system_info_new ();
+
+	as_system_info_set_sysfs_devices_root (sysinfo, sysfs_root);
+	as_system_info_set_modalias_cache_file (sysinfo, cache_fname);
+	as_system_info_set_boot_id (sysinfo, boot_id);
+
+	return sysinfo;
+}
+
+/**
+ * test_modalias_snapshot:
+ *
+ * Reuse a modalias snapshot of a fake sysfs tree within the same boot.
+ */
+static void
+test_modalias_snapshot (void)
+{
+	g_autoptr(AsSystemInfo) sysinfo = NULL;
+	g_autofree gchar *tmp_dir = NULL;
+	g_autofree gchar *sysfs_root = NULL;
+	g_autofree gchar *cache_fname = NULL;
+	g_autofree gchar *expected_syspath = NULL;
+	g_autoptr(GError) error = NULL;
+
+	tmp_dir = g_dir_make_tmp ("as-test-snapshot-XXXXXX", &error);
+	g_assert_no_error (error);
+	sysfs_root = g_build_filename (tmp_dir, "devices", NULL);
+	cache_fname = g_build_filename (tmp_dir, "cache", "modaliases.snapshot", NULL);
+
+	asx_write_fake_modalias (sysfs_root,
+				 "pci0000:00/0000:00:14.0/usb1/1-1",
+				 "usb:v1130p0202d0100dc00dsc00dp00ic03isc00ip00in00");
+	asx_write_fake_modalias (sysfs_root, "platform/serial8250", "platform:serial8250");
+
+	/* the first scan writes the snapshot */
+	sysinfo = asx_new_snapshot_sysinfo (sysfs_root, cache_fname, "boot-1");
+	g_assert_cmpint (as_system_info_get_modaliases (sysinfo)->len, ==, 2);
+	g_assert_true (g_file_test (cache_fname, G_FILE_TEST_IS_REGULAR));
+	g_clear_object (&sysinfo);
+
+	/* devices added later are not seen during the same boot */
+	asx_write_fake_modalias (sysfs_root, "platform/i8042", "platform:i8042");
+	sysinfo = asx_new_snapshot_sysinfo (sysfs_root, cache_fname, "boot-1");
+	g_assert_cmpint (as_system_info_get_modaliases (sysinfo)->len, ==, 2);
+	g_assert_false (as_system_info_has_device_matching_modalias (sysinfo, "platform:i8042"));
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "usb:v1130p0202d*"));
+	expected_syspath = g_build_filename (sysfs_root, "platform", "serial8250", NULL);
+	g_assert_cmpstr (as_system_info_modalias_to_syspath (sysinfo, "platform:serial8250"),
+			 ==,
+			 expected_syspath);
+	g_clear_object (&sysinfo);
+
+	/* a new boot, or a different sysfs root, invalidates the snapshot */
+	sysinfo = asx_new_snapshot_sysinfo (sysfs_root, cache_fname, "boot-2");
+	g_assert_cmpint (as_system_info_get_modaliases (sysinfo)->len, ==, 3);
+	g_assert_true (as_system_info_has_device_matching_modalias (sysinfo, "platform:i8042"));
+	g_clear_object (&sysinfo);
+
+	g_clear_pointer (&expected_syspath, g_free);
+	expected_syspath = g_build_filename (sysfs_root, "platform", NULL);
+	sysinfo = asx_new_snapshot_sysinfo (expected_syspath, cache_fname, "boot-2");
+	g_assert_cmpint (as_system_info_get_modaliases (sysinfo)->len, ==, 2);
+
+	as_utils_delete_dir_recursive (tmp_dir);
+}
+#endif
+
 static gint
 asx_cpt_get_syscompat_score (AsComponent *cpt, AsSystemInfo *sysinfo)
 {
@@ -421,6 +632,8 @@ test_syscompat_scores (void)
 	g_autoptr(AsComponent) cpt_multi = NULL;
 	g_autoptr(AsComponent) cpt_phone = NULL;
 	g_autoptr(AsSystemInfo) sysinfo = NULL;
+	g_autoptr(AsComponentBox) cbox = NULL;
+	g_autoptr(GArray) scores = NULL;
 
 	cpt_desktop_im = asx_load_sample_metainfo (
 	    "syscompat/org.example.desktopapp_implicit.metainfo.xml");
@@ -454,6 +667,31 @@ test_syscompat_scores (void)
 	g_assert_cmpint (asx_cpt_get_syscompat_score (cpt_desktop_ex, sysinfo), ==, 0);
 	g_assert_cmpint (asx_cpt_get_syscompat_score (cpt_multi, sysinfo), ==, 100);
 	g_assert_cmpint (asx_cpt_get_syscompat_score (cpt_phone, sysinfo), ==, 100);
+
+	/* batch evaluation shares results between components, and must give the same scores */
+	cbox = as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+	as_component_box_add (cbox, cpt_desktop_im, NULL);
+	as_component_box_add (cbox, cpt_phone, NULL);
+	as_component_box_add (cbox, cpt_desktop_ex, NULL);
+	as_component_box_add (cbox, cpt_multi, NULL);
+
+	scores = as_component_box_get_system_compatibility_scores (cbox, sysinfo, TRUE);
+	g_assert_cmpint (scores->len, ==, 4);
+	g_assert_cmpint (g_array_index (scores, gint, 0), ==, 0);
+	g_assert_cmpint (g_array_index (scores, gint, 1), ==, 100);
+	g_assert_cmpint (g_array_index (scores, gint, 2), ==, 0);
+	g_assert_cmpint (g_array_index (scores, gint, 3), ==, 100);
+	g_clear_pointer (&scores, g_array_unref);
+
+	g_clear_pointer (&sysinfo, g_object_unref);
+	sysinfo = as_system_info_new_template_for_chassis (AS_CHASSIS_KIND_DESKTOP, NULL);
+	scores = as_component_box_get_system_compatibility_scores (cbox, sysinfo, TRUE);
+	g_assert_cmpint (scores->len, ==, 4);
+	for (guint i = 0; i < scores->len; i++)
+		g_assert_cmpint (g_array_index (scores, gint, i),
+				 ==,
+				 asx_cpt_get_syscompat_score (as_component_box_index (cbox, i),
+							      sysinfo));
 }
 
 int
@@ -481,6 +719,10 @@ main (int argc, char **argv)
 	g_test_add_func ("/AppStream/Misc/StripLocaleEncoding", test_locale_strip_encoding);
 	g_test_add_func ("/AppStream/Misc/RelationSatisfyCheck", test_relation_satisfy_check);
 	g_test_add_func ("/AppStream/Misc/SysCompatScores", test_syscompat_scores);
+#if defined(__linux__)
+	g_test_add_func ("/AppStream/Misc/ModaliasMatching", test_modalias_matching);
+	g_test_add_func ("/AppStream/Misc/ModaliasSnapshot", test_modalias_snapshot);
+#endif
 
 	ret = g_test_run ();
 	g_free (datadir);
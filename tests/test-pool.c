@@ -689,6 +689,88 @@ test_search_stemming (void)
 }
 #endif
 
+typedef struct {
+	guint n_started;
+	guint n_updated;
+	guint n_unchanged;
+	guint n_failed;
+} TestRefreshProgress;
+
+static void
+test_pool_refresh_progress_cb (const gchar *section,
+			       AsPoolSectionState state,
+			       gint64 duration_usec,
+			       gpointer user_data)
+{
+	TestRefreshProgress *progress = user_data;
+
+	g_assert_nonnull (section);
+	switch (state) {
+	case AS_POOL_SECTION_STATE_STARTED:
+		g_assert_cmpint (duration_usec, ==, 0);
+		progress->n_started++;
+		break;
+	case AS_POOL_SECTION_STATE_UPDATED:
+		progress->n_updated++;
+		break;
+	case AS_POOL_SECTION_STATE_UNCHANGED:
+		progress->n_unchanged++;
+		break;
+	default:
+		progress->n_failed++;
+	}
+}
+
+/**
+ * test_pool_refresh_parallel:
+ *
+ * Test refreshing multiple cache sections at the same time.
+ */
+static void
+test_pool_refresh_parallel (void)
+{
+	g_autoptr(AsPool) pool = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *mdata_dir = NULL;
+	TestRefreshProgress progress = { 0 };
+	gboolean caches_updated = FALSE;
+	gboolean ret;
+
+	/* the sample catalog data, and its XML directory as a second, independent section */
+	pool = test_get_sampledata_pool (TRUE);
+	mdata_dir = g_build_filename (datadir, "catalog", "xml", NULL);
+	as_pool_add_extra_data_location (pool, mdata_dir, AS_FORMAT_STYLE_CATALOG);
+
+	ret = as_pool_refresh_system_cache (pool,
+					    TRUE,
+					    4,
+					    test_pool_refresh_progress_cb,
+					    &progress,
+					    &caches_updated,
+					    &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_true (caches_updated);
+	g_assert_cmpint (progress.n_started, ==, 2);
+	g_assert_cmpint (progress.n_updated, ==, 2);
+	g_assert_cmpint (progress.n_failed, ==, 0);
+
+	/* nothing changed, so a second refresh can use the existing sections */
+	progress = (TestRefreshProgress) { 0 };
+	ret = as_pool_refresh_system_cache (pool,
+					    FALSE,
+					    0,
+					    test_pool_refresh_progress_cb,
+					    &progress,
+					    &caches_updated,
+					    &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_false (caches_updated);
+	g_assert_cmpint (progress.n_started, ==, 2);
+	g_assert_cmpint (progress.n_unchanged, ==, 2);
+}
+
 /**
  * test_pool_empty:
  *
@@ -1082,6 +1164,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/AppStream/PoolRead", test_pool_read);
 	g_test_add_func ("/AppStream/PoolReadAsync", test_pool_read_async);
 	g_test_add_func ("/AppStream/PoolEmpty", test_pool_empty);
+	g_test_add_func ("/AppStream/PoolRefreshParallel", test_pool_refresh_parallel);
 	g_test_add_func ("/AppStream/Cache", test_cache);
 	g_test_add_func ("/AppStream/Merges", test_merge_components);
 #ifdef HAVE_STEMMING
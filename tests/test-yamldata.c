@@ -24,6 +24,7 @@
 #include "appstream.h"
 #include "as-screenshot-private.h"
 #include "as-metadata.h"
+#include "as-metadata-private.h"
 #include "as-test-utils.h"
 
 static gchar *datadir = NULL;
@@ -1907,6 +1908,159 @@ test_yaml_rw_branding (void)
 	g_assert_true (as_yaml_test_compare_yaml (res, yamldata_tags));
 }
 
+/**
+ * test_convert_catalog_data:
+ *
+ * Convert catalog data with all components in memory.
+ */
+static gchar *
+test_convert_catalog_data (const gchar *data, AsFormatKind in_format, AsFormatKind out_format)
+{
+	g_autoptr(AsMetadata) metad = NULL;
+	g_autoptr(GError) error = NULL;
+	gchar *res;
+
+	metad = as_metadata_new ();
+	as_metadata_set_locale (metad, "ALL");
+	as_metadata_set_format_style (metad, AS_FORMAT_STYLE_CATALOG);
+
+	as_metadata_parse_data (metad, data, -1, in_format, &error);
+	g_assert_no_error (error);
+	res = as_metadata_components_to_catalog (metad, out_format, &error);
+	g_assert_no_error (error);
+
+	return res;
+}
+
+/**
+ * test_convert_catalog_stream:
+ *
+ * Convert catalog data component by component.
+ */
+static gchar *
+test_convert_catalog_stream (const gchar *data,
+			     AsFormatKind in_format,
+			     AsFormatKind out_format,
+			     guint n_threads)
+{
+	g_autoptr(AsMetadata) metad = NULL;
+	g_autoptr(GInputStream) istream = NULL;
+	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(GError) error = NULL;
+
+	metad = as_metadata_new ();
+	as_metadata_set_locale (metad, "ALL");
+
+	istream = g_memory_input_stream_new_from_data (data, -1, NULL);
+	ostream = g_memory_output_stream_new_resizable ();
+	as_metadata_convert_catalog_stream (metad,
+					    istream,
+					    in_format,
+					    NULL,
+					    ostream,
+					    out_format,
+					    n_threads,
+					    &error);
+	g_assert_no_error (error);
+
+	/* terminate the string */
+	g_output_stream_write_all (ostream, "", 1, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_output_stream_close (ostream, NULL, &error);
+	g_assert_no_error (error);
+
+	return g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (ostream));
+}
+
+/**
+ * test_yaml_convert_stream:
+ *
+ * Test that converting catalog data in a stream produces exactly the same
+ * data as converting it in memory, regardless of the number of threads.
+ */
+static void
+test_yaml_convert_stream (void)
+{
+	g_autofree gchar *path = NULL;
+	g_autofree gchar *yaml_data = NULL;
+	g_autofree gchar *xml_data = NULL;
+	g_autofree gchar *yaml_data_rt = NULL;
+	g_autofree gchar *many_xml_data = NULL;
+	g_autofree gchar *many_yaml_data = NULL;
+	g_autofree gchar *many_xml_data_rt = NULL;
+	g_autoptr(AsMetadata) metad = NULL;
+	g_autoptr(GError) error = NULL;
+	const guint n_threads[] = { 1, 4 };
+
+	path = g_build_filename (datadir, "dep11-0.16.yml", NULL);
+	g_file_get_contents (path, &yaml_data, NULL, &error);
+	g_assert_no_error (error);
+
+	/* YAML -> XML */
+	xml_data = test_convert_catalog_data (yaml_data, AS_FORMAT_KIND_YAML, AS_FORMAT_KIND_XML);
+	for (guint i = 0; i < G_N_ELEMENTS (n_threads); i++) {
+		g_autofree gchar *data = NULL;
+		data = test_convert_catalog_stream (yaml_data,
+						    AS_FORMAT_KIND_YAML,
+						    AS_FORMAT_KIND_XML,
+						    n_threads[i]);
+		g_assert_cmpstr (data, ==, xml_data);
+	}
+
+	/* XML -> YAML */
+	yaml_data_rt = test_convert_catalog_data (xml_data, AS_FORMAT_KIND_XML, AS_FORMAT_KIND_YAML);
+	for (guint i = 0; i < G_N_ELEMENTS (n_threads); i++) {
+		g_autofree gchar *data = NULL;
+		data = test_convert_catalog_stream (xml_data,
+						    AS_FORMAT_KIND_XML,
+						    AS_FORMAT_KIND_YAML,
+						    n_threads[i]);
+		g_assert_cmpstr (data, ==, yaml_data_rt);
+	}
+
+	/* enough components for multiple batches to be in flight, in both directions */
+	metad = as_metadata_new ();
+	as_metadata_set_origin (metad, "streamtest");
+	for (guint i = 0; i < 500; i++) {
+		g_autoptr(AsComponent) cpt = as_component_new ();
+		g_autofree gchar *cid = g_strdup_printf ("org.example.Stream%u", i);
+		g_autofree gchar *name = g_strdup_printf ("Stream Test %u", i);
+
+		as_component_set_kind (cpt, AS_COMPONENT_KIND_DESKTOP_APP);
+		as_component_set_id (cpt, cid);
+		as_component_set_name (cpt, name, "C");
+		as_component_set_name (cpt, name, "de");
+		as_component_set_summary (cpt, "A component for testing catalog streams", "C");
+		as_component_set_description (cpt, "<p>Catalog streams preserve the order.</p>", "C");
+		as_metadata_add_component (metad, cpt);
+	}
+	many_xml_data = as_metadata_components_to_catalog (metad, AS_FORMAT_KIND_XML, &error);
+	g_assert_no_error (error);
+	many_yaml_data = test_convert_catalog_data (many_xml_data,
+						    AS_FORMAT_KIND_XML,
+						    AS_FORMAT_KIND_YAML);
+	many_xml_data_rt = test_convert_catalog_data (many_yaml_data,
+						      AS_FORMAT_KIND_YAML,
+						      AS_FORMAT_KIND_XML);
+
+	for (guint i = 0; i < G_N_ELEMENTS (n_threads); i++) {
+		g_autofree gchar *data_yaml = NULL;
+		g_autofree gchar *data_xml = NULL;
+
+		data_yaml = test_convert_catalog_stream (many_xml_data,
+							 AS_FORMAT_KIND_XML,
+							 AS_FORMAT_KIND_YAML,
+							 n_threads[i]);
+		g_assert_cmpstr (data_yaml, ==, many_yaml_data);
+
+		data_xml = test_convert_catalog_stream (many_yaml_data,
+							AS_FORMAT_KIND_YAML,
+							AS_FORMAT_KIND_XML,
+							n_threads[i]);
+		g_assert_cmpstr (data_xml, ==, many_xml_data_rt);
+	}
+}
+
 /**
  * main:
  */
@@ -1972,6 +2126,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/YAML/ReadWrite/Tags", test_yaml_rw_tags);
 	g_test_add_func ("/YAML/ReadWrite/Branding", test_yaml_rw_branding);
 
+	g_test_add_func ("/YAML/ConvertStream", test_yaml_convert_stream);
+
 	ret = g_test_run ();
 	g_free (datadir);
 	return ret;
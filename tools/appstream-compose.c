@@ -181,7 +181,11 @@ main (int argc, char **argv)
 	g_autofree gchar *media_baseurl = NULL;
 	g_autofree gchar *prefix = NULL;
 	g_autofree gchar *components_str = NULL;
+	g_autofree gchar *trace_fname = NULL;
+	g_autofree gchar *stats_summary = NULL;
 	gboolean no_partial_urls = FALSE;
+	gboolean fast_gcid_hash = FALSE;
+	gboolean spill_results = FALSE;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(AscCompose) compose = NULL;
 	AscComposeFlags compose_flags;
@@ -261,6 +265,24 @@ main (int argc, char **argv)
 		    G_OPTION_ARG_NONE, &no_partial_urls,
 		    /* TRANSLATORS: ascompose flag description for: --no-partial-urls */
 					    _("Makes all URLs in output data complete URLs and avoids the use of a shared URL prefix for all metadata."),
+		       NULL },
+					    { "trace",
+		    '\0', 0,
+		    G_OPTION_ARG_FILENAME, &trace_fname,
+		    /* TRANSLATORS: ascompose flag description for: --trace */
+					    _("Write a Chrome trace-event file of the time spent in each processing stage, and print a summary"),
+		       "FILE" },
+					    { "fast-gcid-hash",
+		    '\0', 0,
+		    G_OPTION_ARG_NONE, &fast_gcid_hash,
+		    /* TRANSLATORS: ascompose flag description for: --fast-gcid-hash */
+					    _("Use a fast hash function instead of MD5 to build global component IDs (changes media paths)."),
+		       NULL },
+					    { "spill-results",
+		    '\0', 0,
+		    G_OPTION_ARG_NONE, &spill_results,
+		    /* TRANSLATORS: ascompose flag description for: --spill-results */
+					    _("Move generated data of finished units to temporary files to reduce memory usage."),
 		       NULL },
 					    { "components",
 		      '\0', 0,
@@ -336,6 +358,10 @@ main (int argc, char **argv)
 		as_flags_remove (compose_flags, ASC_COMPOSE_FLAG_ALLOW_NET);
 	if (no_partial_urls)
 		as_flags_add (compose_flags, ASC_COMPOSE_FLAG_NO_PARTIAL_URLS);
+	if (fast_gcid_hash)
+		as_flags_add (compose_flags, ASC_COMPOSE_FLAG_FAST_GCID_HASH);
+	if (spill_results)
+		as_flags_add (compose_flags, ASC_COMPOSE_FLAG_SPILL_RESULTS);
 	asc_compose_set_flags (compose, compose_flags);
 
 	/* sanity checks & defaults */
@@ -387,6 +413,7 @@ main (int argc, char **argv)
 	asc_compose_set_hints_result_dir (compose, hints_dir);
 	asc_compose_set_media_result_dir (compose, media_dir);
 	asc_compose_set_media_baseurl (compose, media_baseurl);
+	asc_compose_set_trace_filename (compose, trace_fname);
 
 	/* we need at least one unit to process */
 	if (argc == 1) {
@@ -450,6 +477,19 @@ main (int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
+	stats_summary = asc_compose_get_statistics_summary (compose);
+	if (stats_summary != NULL)
+		/* TRANSLATORS: Header of the media processing statistics of appstream-compose */
+		g_print ("%s\n%s", _("Media processing statistics:"), stats_summary);
+
+	if (trace_fname != NULL) {
+		g_autofree gchar *summary = asc_compose_get_trace_summary (compose);
+		/* TRANSLATORS: Header of the per-stage timing summary of appstream-compose */
+		g_print ("%s\n%s", _("Time spent per processing stage:"), summary);
+		/* TRANSLATORS: Information message, the placeholder is a file path */
+		ascli_print_stdout (_("Trace written to: %s"), trace_fname);
+	}
+
 	if (asc_compose_has_errors (compose)) {
 		/* TRANSLATORS: appstream-compose failed to include all data */
 		g_print ("%s\n", _("Run failed, some data was ignored."));
@@ -36,6 +36,8 @@
 #include "ascli-actions-validate.h"
 #include "ascli-actions-pkgmgr.h"
 #include "ascli-actions-misc.h"
+#include "ascli-actions-benchmark.h"
+#include "ascli-daemon.h"
 
 #define ASCLI_BIN_NAME "appstreamcli"
 
@@ -270,6 +272,7 @@ as_client_run_refresh_cache (const gchar *command, char **argv, int argc)
 	g_autoptr(GOptionContext) opt_context = NULL;
 	gint ret;
 	gboolean optn_force = FALSE;
+	gint optn_jobs = 0;
 	g_auto(GStrv) optn_sources = NULL;
 	g_auto(GStrv) optn_sources_real = NULL;
 
@@ -287,6 +290,13 @@ as_client_run_refresh_cache (const gchar *command, char **argv, int argc)
 		    /* TRANSLATORS: ascli flag description for: --source in a refresh action. Don't translate strings in backticks: `name` */
 		    _("Limit cache refresh to data from a specific source, e.g. `os` or `flatpak`. May be specified multiple times."),
 		       NULL },
+		    { "jobs",
+		      'j',
+		      0, G_OPTION_ARG_INT,
+		      &optn_jobs,
+		      /* TRANSLATORS: ascli flag description for: --jobs in a refresh action */
+		      _("Number of cache sections to rebuild at the same time (0 to use one per CPU core)."),
+		      NULL },
 		    { NULL }
 	     };
 
@@ -297,6 +307,11 @@ as_client_run_refresh_cache (const gchar *command, char **argv, int argc)
 	if (ret != 0)
 		return ret;
 
+	if (optn_jobs < 0) {
+		ascli_print_stderr (_("The number of jobs must not be negative."));
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+
 	if (optn_sources != NULL) {
 		if (g_strv_length (optn_sources) == 1)
 			optn_sources_real = g_strsplit (optn_sources[0], ",", -1);
@@ -307,7 +322,8 @@ as_client_run_refresh_cache (const gchar *command, char **argv, int argc)
 	return ascli_refresh_cache (optn_cachepath,
 				    optn_datapath,
 				    (const gchar *const *) optn_sources_real,
-				    optn_force);
+				    optn_force,
+				    (guint) optn_jobs);
 }
 
 /**
@@ -320,15 +336,73 @@ as_client_run_search (const gchar *command, char **argv, int argc)
 {
 	g_autoptr(GOptionContext) opt_context = NULL;
 	g_autoptr(GString) search = NULL;
+	g_auto(GStrv) fields = NULL;
+	const gchar *optn_output_format = NULL;
+	const gchar *optn_fields = NULL;
+	gint optn_limit = 0;
+	gint optn_offset = 0;
+	AsCliOutputFormat oformat;
 	gint ret;
 
+	const GOptionEntry search_options[] = {
+		{ "format",
+		  0, 0,
+		  G_OPTION_ARG_STRING, &optn_output_format,
+		  /* TRANSLATORS: ascli flag description for: --format as part of the search command */
+		  N_ ("Output format of the search results ('text', 'json' or 'ndjson')."),
+		  NULL },
+		{ "fields",
+		  0, 0,
+		  G_OPTION_ARG_STRING, &optn_fields,
+		  /* TRANSLATORS: ascli flag description for: --fields as part of the search command */
+		  N_ ("Comma-separated list of fields to include in JSON output."),
+		  NULL },
+		{ "limit",
+		  'l', 0,
+		  G_OPTION_ARG_INT, &optn_limit,
+		  /* TRANSLATORS: ascli flag description for: --limit as part of the search command */
+		  N_ ("Show at most this number of results (0 for unlimited)."),
+		  NULL },
+		{ "offset",
+		  0, 0,
+		  G_OPTION_ARG_INT, &optn_offset,
+		  /* TRANSLATORS: ascli flag description for: --offset as part of the search command */
+		  N_ ("Skip this number of results before showing any."),
+		  NULL },
+		{ NULL }
+	};
+
 	opt_context = as_client_new_subcommand_option_context (command, find_options);
 	g_option_context_add_main_entries (opt_context, data_catalog_options, NULL);
+	g_option_context_add_main_entries (opt_context, search_options, NULL);
 
 	ret = as_client_option_context_parse (opt_context, command, &argc, &argv);
 	if (ret != 0)
 		return ret;
 
+	oformat = ascli_output_format_from_string (optn_output_format);
+	if (oformat == ASCLI_OUTPUT_FORMAT_UNKNOWN) {
+		/* TRANSLATORS: An invalid output format was passed to `appstreamcli search` */
+		ascli_print_stderr (_("Invalid output format '%s'. Valid values are 'text', 'json' and 'ndjson'."),
+				    optn_output_format);
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+	if (optn_limit < 0 || optn_offset < 0) {
+		ascli_print_stderr (_("The limit and offset of results must not be negative."));
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+	if (optn_fields != NULL) {
+		if (oformat == ASCLI_OUTPUT_FORMAT_TEXT) {
+			ascli_print_stderr (_("Fields can only be selected for JSON output."));
+			return ASCLI_EXIT_CODE_BAD_INPUT;
+		}
+		fields = g_strsplit (optn_fields, ",", -1);
+		for (guint i = 0; fields[i] != NULL; i++)
+			g_strstrip (fields[i]);
+		if (!ascli_json_fields_validate (fields))
+			return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+
 	search = g_string_new ("");
 	if (argc > 2) {
 		for (gint i = 2; i < argc; i++) {
@@ -343,7 +417,11 @@ as_client_run_search (const gchar *command, char **argv, int argc)
 	return ascli_search_component (optn_cachepath,
 				       (search->len == 0) ? NULL : search->str,
 				       optn_details,
-				       optn_no_cache);
+				       optn_no_cache,
+				       oformat,
+				       (guint) optn_offset,
+				       (guint) optn_limit,
+				       fields);
 }
 
 /**
@@ -426,6 +504,83 @@ as_client_run_what_provides (const gchar *command, char **argv, int argc)
 	return ascli_what_provides (optn_cachepath, vtype, vvalue, optn_details);
 }
 
+/**
+ * as_client_run_daemon:
+ *
+ * Keep the metadata pool loaded and answer queries from other appstreamcli processes.
+ */
+static int
+as_client_run_daemon (const gchar *command, char **argv, int argc)
+{
+	g_autoptr(GOptionContext) opt_context = NULL;
+	g_autofree gchar *optn_socket = NULL;
+	gint ret;
+
+	const GOptionEntry daemon_options[] = {
+		{ "socket",
+		  0, 0,
+		  G_OPTION_ARG_FILENAME, &optn_socket,
+		  /* TRANSLATORS: ascli flag description for: --socket (used by the "daemon" command) */
+		  _("Listen on a different socket than the one queries are sent to by default."),
+		  NULL },
+		{ NULL }
+	};
+
+	opt_context = as_client_new_subcommand_option_context (command, daemon_options);
+	g_option_context_add_main_entries (opt_context, data_catalog_options, NULL);
+
+	ret = as_client_option_context_parse (opt_context, command, &argc, &argv);
+	if (ret != 0)
+		return ret;
+
+	return ascli_run_daemon (optn_socket, optn_cachepath, optn_no_cache);
+}
+
+/**
+ * as_client_run_benchmark:
+ *
+ * Measure the performance of common metadata pool operations.
+ */
+static int
+as_client_run_benchmark (const gchar *command, char **argv, int argc)
+{
+	g_autoptr(GOptionContext) opt_context = NULL;
+	const gchar *optn_output_format = NULL;
+	gint optn_iterations = 10;
+	const gchar *catalog_dir = NULL;
+	gint ret;
+
+	const GOptionEntry benchmark_options[] = {
+		{ "iterations",
+		  'n', 0,
+		  G_OPTION_ARG_INT, &optn_iterations,
+		  /* TRANSLATORS: ascli flag description for: --iterations (used by the "benchmark" command) */
+		  N_ ("How often each operation is run (default: 10)."),
+		  NULL },
+		{ "format",
+		  0, 0,
+		  G_OPTION_ARG_STRING, &optn_output_format,
+		  /* TRANSLATORS: ascli flag description for: --format (used by the "benchmark" command) */
+		  N_ ("Format of the generated report (valid values are 'text' and 'json')."),
+		  NULL },
+		{ NULL }
+	};
+
+	opt_context = as_client_new_subcommand_option_context (command, benchmark_options);
+	ret = as_client_option_context_parse (opt_context, command, &argc, &argv);
+	if (ret != 0)
+		return ret;
+
+	if (optn_iterations <= 0) {
+		ascli_print_stderr (_("The number of iterations must be positive."));
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+	if (argc > 2)
+		catalog_dir = argv[2];
+
+	return ascli_benchmark (catalog_dir, (guint) optn_iterations, optn_output_format);
+}
+
 /**
  * as_client_run_list_categories:
  *
@@ -464,12 +619,29 @@ as_client_run_validate (const gchar *command, char **argv, int argc)
 {
 	g_autoptr(GOptionContext) opt_context = NULL;
 	gint ret;
+	gint optn_jobs = 1;
+
+	const GOptionEntry validate_files_options[] = {
+		{ "jobs",
+		  'j', 0,
+		  G_OPTION_ARG_INT, &optn_jobs,
+		  /* TRANSLATORS: ascli flag description for: --jobs (used by the "validate" command) */
+		  N_ ("Number of files to validate at the same time (0 to use one per CPU core)."),
+		  NULL },
+		{ NULL }
+	};
 
 	opt_context = as_client_new_subcommand_option_context (command, validate_options);
+	g_option_context_add_main_entries (opt_context, validate_files_options, NULL);
 	ret = as_client_option_context_parse (opt_context, command, &argc, &argv);
 	if (ret != 0)
 		return ret;
 
+	if (optn_jobs < 0) {
+		ascli_print_stderr (_("The number of jobs must not be negative."));
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+
 	if (optn_format == NULL) {
 		return ascli_validate_files (&argv[2],
 					     argc - 2,
@@ -477,14 +649,16 @@ as_client_run_validate (const gchar *command, char **argv, int argc)
 					     optn_explain,
 					     optn_validate_strict,
 					     !optn_no_net,
-					     optn_issue_overrides);
+					     optn_issue_overrides,
+					     (guint) optn_jobs);
 	} else {
 		return ascli_validate_files_format (&argv[2],
 						    argc - 2,
 						    optn_format,
 						    optn_validate_strict,
 						    !optn_no_net,
-						    optn_issue_overrides);
+						    optn_issue_overrides,
+						    (guint) optn_jobs);
 	}
 }
 
@@ -801,20 +975,36 @@ as_client_run_convert (const gchar *command, char **argv, int argc)
 	gint ret;
 	const gchar *fname1 = NULL;
 	const gchar *fname2 = NULL;
+	gint optn_jobs = 0;
 	AsFormatKind mformat;
 
+	const GOptionEntry convert_options[] = {
+		{ "jobs",
+		  'j', 0,
+		  G_OPTION_ARG_INT, &optn_jobs,
+		  /* TRANSLATORS: ascli flag description for: --jobs (used by the "convert" command) */
+		  N_ ("Number of threads to convert components with (0 to use one per CPU core)."),
+		  NULL },
+		{ NULL }
+	};
+
 	opt_context = as_client_new_subcommand_option_context (command, format_options);
+	g_option_context_add_main_entries (opt_context, convert_options, NULL);
 	ret = as_client_option_context_parse (opt_context, command, &argc, &argv);
 	if (ret != 0)
 		return ret;
 
+	if (optn_jobs < 0) {
+		ascli_print_stderr (_("The number of jobs must not be negative."));
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
 	if (argc > 2)
 		fname1 = argv[2];
 	if (argc > 3)
 		fname2 = argv[3];
 
 	mformat = as_format_kind_from_string (optn_format);
-	return ascli_convert_data (fname1, fname2, mformat);
+	return ascli_convert_data (fname1, fname2, mformat, (guint) optn_jobs);
 }
 
 /**
@@ -1425,6 +1615,14 @@ as_client_run (char **argv, int argc)
 		       NULL,
 		       /* TRANSLATORS: `appstreamcli refresh-cache` command description. */
 		       _("Rebuild the component metadata cache."), as_client_run_refresh_cache);
+	ascli_add_cmd (commands,
+		       1,
+		       "daemon",
+		       NULL,
+		       NULL,
+		       /* TRANSLATORS: `appstreamcli daemon` command description. */
+		       _("Keep the metadata loaded and answer queries of other appstreamcli processes quickly."),
+		       as_client_run_daemon);
 
 	ascli_add_cmd (commands,
 		       2,
@@ -1497,6 +1695,14 @@ as_client_run (char **argv, int argc)
 		       /* TRANSLATORS: `appstreamcli sysinfo` command description. */
 		       _("Show information about the current device and used operating system."),
 			  as_client_run_sysinfo);
+	ascli_add_cmd (commands,
+		       4,
+		       "benchmark",
+		       NULL,
+		       "[DIRECTORY]",
+		       /* TRANSLATORS: `appstreamcli benchmark` command description. */
+		       _("Measure the performance of loading and querying metadata."),
+		       as_client_run_benchmark);
 	ascli_add_cmd (commands,
 		       4,
 		       "put",
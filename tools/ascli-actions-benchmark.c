@@ -0,0 +1,529 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2012-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ascli-actions-benchmark.h"
+
+#include <config.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "as-utils-private.h"
+#include "as-pool-private.h"
+#include "ascli-utils.h"
+#include "ascli-daemon.h"
+
+/* number of components looked up by ID in each iteration */
+#define ASCLI_BENCHMARK_MAX_IDS 100
+
+/* representative queries, modelled after what software centers ask for */
+static const gchar *ascli_benchmark_search_terms[] = {
+	"editor", "web browser", "game", "image", "music", "terminal", "office", "mail", NULL
+};
+
+static const gchar *ascli_benchmark_categories[] = {
+	"AudioVideo", "Development", "Education", "Game",     "Graphics", "Network",
+	"Office",     "Science",     "Settings",  "System",   "Utility",  NULL
+};
+
+typedef struct {
+	const gchar *name;
+	GArray *samples; /* of gdouble, in milliseconds */
+	gboolean failed;
+} AsCliBenchmarkOp;
+
+typedef struct {
+	const gchar *catalog_dir;
+	gchar *cache_dir;
+	GPtrArray *ops;
+} AsCliBenchmark;
+
+static void
+ascli_benchmark_op_free (AsCliBenchmarkOp *op)
+{
+	g_array_unref (op->samples);
+	g_free (op);
+}
+
+/**
+ * ascli_benchmark_add_op:
+ *
+ * Register a new operation to collect timing samples for.
+ */
+static AsCliBenchmarkOp *
+ascli_benchmark_add_op (AsCliBenchmark *bench, const gchar *name)
+{
+	AsCliBenchmarkOp *op = g_new0 (AsCliBenchmarkOp, 1);
+
+	op->name = name;
+	op->samples = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	g_ptr_array_add (bench->ops, op);
+	return op;
+}
+
+/**
+ * ascli_benchmark_op_fail:
+ *
+ * Drop all samples of an operation that could not be completed,
+ * so partial results are not mistaken for real ones.
+ */
+static void
+ascli_benchmark_op_fail (AsCliBenchmarkOp *op, const gchar *reason)
+{
+	g_debug ("Benchmark operation %s failed: %s", op->name, reason);
+	g_array_set_size (op->samples, 0);
+	op->failed = TRUE;
+}
+
+static void
+ascli_benchmark_op_add_sample (AsCliBenchmarkOp *op, gint64 start_usec)
+{
+	gdouble msec = (g_get_monotonic_time () - start_usec) / 1000.0;
+	g_array_append_val (op->samples, msec);
+}
+
+static gint
+ascli_benchmark_cmp_samples (gconstpointer a, gconstpointer b)
+{
+	gdouble da = *((const gdouble *) a);
+	gdouble db = *((const gdouble *) b);
+
+	if (da < db)
+		return -1;
+	if (da > db)
+		return 1;
+	return 0;
+}
+
+/**
+ * ascli_benchmark_percentile:
+ *
+ * Get a percentile of sorted samples, using the nearest-rank method.
+ */
+static gdouble
+ascli_benchmark_percentile (GArray *sorted, guint percent)
+{
+	guint rank;
+
+	if (sorted->len == 0)
+		return 0;
+	rank = (sorted->len * percent + 99) / 100;
+	if (rank == 0)
+		rank = 1;
+	return g_array_index (sorted, gdouble, rank - 1);
+}
+
+/**
+ * ascli_benchmark_read_memory:
+ *
+ * Read the current and peak resident set size of this process, in KiB.
+ */
+static gboolean
+ascli_benchmark_read_memory (guint64 *rss_kib, guint64 *peak_kib)
+{
+	g_autofree gchar *status = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	*rss_kib = 0;
+	*peak_kib = 0;
+	if (!g_file_get_contents ("/proc/self/status", &status, NULL, NULL))
+		return FALSE;
+
+	lines = g_strsplit (status, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		if (g_str_has_prefix (lines[i], "VmRSS:"))
+			*rss_kib = g_ascii_strtoull (lines[i] + 6, NULL, 10);
+		else if (g_str_has_prefix (lines[i], "VmHWM:"))
+			*peak_kib = g_ascii_strtoull (lines[i] + 6, NULL, 10);
+	}
+
+	return TRUE;
+}
+
+/**
+ * ascli_benchmark_pool_new:
+ *
+ * Create a pool for the data we benchmark, using a private cache location.
+ */
+static AsPool *
+ascli_benchmark_pool_new (AsCliBenchmark *bench, gboolean ignore_cache)
+{
+	AsPool *pool = as_pool_new ();
+
+	if (bench->catalog_dir != NULL) {
+		as_pool_remove_flags (pool,
+				      AS_POOL_FLAG_LOAD_OS_CATALOG | AS_POOL_FLAG_LOAD_OS_METAINFO |
+					  AS_POOL_FLAG_LOAD_OS_DESKTOP_FILES |
+					  AS_POOL_FLAG_LOAD_FLATPAK);
+		as_pool_add_extra_data_location (pool,
+						 bench->catalog_dir,
+						 AS_FORMAT_STYLE_CATALOG);
+	}
+	if (ignore_cache)
+		as_pool_add_flags (pool, AS_POOL_FLAG_IGNORE_CACHE_AGE);
+
+	/* never touch the caches that are used by other applications */
+	as_pool_override_cache_locations (pool, bench->cache_dir, bench->cache_dir);
+
+	return pool;
+}
+
+/**
+ * ascli_benchmark_print_text:
+ */
+static void
+ascli_benchmark_print_text (AsCliBenchmark *bench,
+			    guint n_components,
+			    guint64 rss_kib,
+			    guint64 peak_kib)
+{
+	/* TRANSLATORS: Header of the `appstreamcli benchmark` results */
+	g_print ("%s: %u\n", _("Components"), n_components);
+	if (peak_kib > 0) {
+		g_print ("%s: %.1f MiB\n", _("Memory (resident)"), rss_kib / 1024.0);
+		g_print ("%s: %.1f MiB\n", _("Memory (peak)"), peak_kib / 1024.0);
+	}
+	g_print ("\n%-16s %8s %10s %10s %10s %10s %10s\n",
+		 _("Operation"),
+		 _("Samples"),
+		 "min ms",
+		 "p50 ms",
+		 "p90 ms",
+		 "p99 ms",
+		 "max ms");
+
+	for (guint i = 0; i < bench->ops->len; i++) {
+		AsCliBenchmarkOp *op = g_ptr_array_index (bench->ops, i);
+		if (op->failed) {
+			/* TRANSLATORS: A benchmark operation could not be completed */
+			g_print ("%-16s %8s\n", op->name, _("failed"));
+			continue;
+		}
+		if (op->samples->len == 0)
+			continue;
+		g_print ("%-16s %8u %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			 op->name,
+			 op->samples->len,
+			 g_array_index (op->samples, gdouble, 0),
+			 ascli_benchmark_percentile (op->samples, 50),
+			 ascli_benchmark_percentile (op->samples, 90),
+			 ascli_benchmark_percentile (op->samples, 99),
+			 g_array_index (op->samples, gdouble, op->samples->len - 1));
+	}
+}
+
+static void
+ascli_benchmark_json_append_msec (GString *json, const gchar *key, gdouble value, gboolean last)
+{
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	/* JSON numbers must not depend on the locale */
+	g_string_append_printf (json,
+				"\"%s\":%s%s",
+				key,
+				g_ascii_formatd (buf, sizeof (buf), "%.3f", value),
+				last ? "" : ",");
+}
+
+/**
+ * ascli_benchmark_print_json:
+ */
+static void
+ascli_benchmark_print_json (AsCliBenchmark *bench,
+			    guint n_components,
+			    guint64 rss_kib,
+			    guint64 peak_kib)
+{
+	g_autoptr(GString) json = g_string_new ("");
+	gboolean first = TRUE;
+
+	g_string_append_printf (json,
+				"{\"version\":\"%s\",\"components\":%u,",
+				PACKAGE_VERSION,
+				n_components);
+	if (peak_kib > 0)
+		g_string_append_printf (json,
+					"\"memory\":{\"rss_kib\":%" G_GUINT64_FORMAT
+					",\"peak_rss_kib\":%" G_GUINT64_FORMAT "},",
+					rss_kib,
+					peak_kib);
+	else
+		g_string_append (json, "\"memory\":null,");
+
+	g_string_append (json, "\"operations\":[");
+	for (guint i = 0; i < bench->ops->len; i++) {
+		AsCliBenchmarkOp *op = g_ptr_array_index (bench->ops, i);
+		if (op->samples->len == 0 && !op->failed)
+			continue;
+
+		if (!first)
+			g_string_append_c (json, ',');
+		first = FALSE;
+		if (op->failed) {
+			g_string_append_printf (json,
+						"{\"name\":\"%s\",\"samples\":0,\"failed\":true}",
+						op->name);
+			continue;
+		}
+		g_string_append_printf (json,
+					"{\"name\":\"%s\",\"samples\":%u,",
+					op->name,
+					op->samples->len);
+		ascli_benchmark_json_append_msec (json,
+						  "min_ms",
+						  g_array_index (op->samples, gdouble, 0),
+						  FALSE);
+		ascli_benchmark_json_append_msec (json,
+						  "p50_ms",
+						  ascli_benchmark_percentile (op->samples, 50),
+						  FALSE);
+		ascli_benchmark_json_append_msec (json,
+						  "p90_ms",
+						  ascli_benchmark_percentile (op->samples, 90),
+						  FALSE);
+		ascli_benchmark_json_append_msec (json,
+						  "p99_ms",
+						  ascli_benchmark_percentile (op->samples, 99),
+						  FALSE);
+		ascli_benchmark_json_append_msec (json,
+						  "max_ms",
+						  g_array_index (op->samples,
+								 gdouble,
+								 op->samples->len - 1),
+						  TRUE);
+		g_string_append_c (json, '}');
+	}
+	g_string_append (json, "]}\n");
+
+	g_print ("%s", json->str);
+}
+
+/**
+ * ascli_benchmark:
+ * @catalog_dir: (nullable): Directory with catalog metadata, or %NULL to use the system pool.
+ * @iterations: How often each operation is run.
+ * @format_str: (nullable): The output format, "text" or "json".
+ *
+ * Time the most important pool operations and print statistics about them.
+ * All caches are written to a temporary location, so the caches of the system
+ * and the current user are neither used nor modified.
+ */
+int
+ascli_benchmark (const gchar *catalog_dir, guint iterations, const gchar *format_str)
+{
+	AsCliBenchmark bench = { 0 };
+	AsCliOutputFormat oformat;
+	AsCliBenchmarkOp *op_rebuild;
+	AsCliBenchmarkOp *op_load_cold;
+	AsCliBenchmarkOp *op_load_warm;
+	AsCliBenchmarkOp *op_get_by_id;
+	AsCliBenchmarkOp *op_categories;
+	AsCliBenchmarkOp *op_search;
+	AsCliBenchmarkOp *op_iterate;
+	AsCliBenchmarkOp *op_daemon;
+	g_autoptr(AsPool) pool = NULL;
+	g_autoptr(AsComponentBox) all_cpts = NULL;
+	g_autoptr(GPtrArray) ids = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *socket_path = NULL;
+	AsCliDaemonServer *daemon = NULL;
+	guint n_components = 0;
+	guint64 rss_kib;
+	guint64 peak_kib;
+	gint ret = ASCLI_EXIT_CODE_SUCCESS;
+
+	oformat = ascli_output_format_from_string (format_str);
+	if (oformat != ASCLI_OUTPUT_FORMAT_TEXT && oformat != ASCLI_OUTPUT_FORMAT_JSON) {
+		/* TRANSLATORS: An invalid output format was passed to `appstreamcli benchmark` */
+		ascli_print_stderr (_("Invalid output format '%s'. Valid values are 'text' and 'json'."),
+				    format_str);
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+	if (catalog_dir != NULL && !g_file_test (catalog_dir, G_FILE_TEST_IS_DIR)) {
+		ascli_print_stderr (_("Directory '%s' does not exist."), catalog_dir);
+		return ASCLI_EXIT_CODE_BAD_INPUT;
+	}
+	if (iterations == 0)
+		iterations = 1;
+
+	bench.catalog_dir = catalog_dir;
+	bench.cache_dir = g_dir_make_tmp ("appstream-benchmark-XXXXXX", &error);
+	if (bench.cache_dir == NULL) {
+		ascli_print_stderr (_("Unable to create temporary cache directory: %s"),
+				    error->message);
+		return ASCLI_EXIT_CODE_FAILED;
+	}
+	bench.ops = g_ptr_array_new_with_free_func ((GDestroyNotify) ascli_benchmark_op_free);
+
+	op_rebuild = ascli_benchmark_add_op (&bench, "cache-rebuild");
+	op_load_cold = ascli_benchmark_add_op (&bench, "load-cold");
+	op_load_warm = ascli_benchmark_add_op (&bench, "load-warm");
+	op_get_by_id = ascli_benchmark_add_op (&bench, "get-by-id");
+	op_categories = ascli_benchmark_add_op (&bench, "categories");
+	op_search = ascli_benchmark_add_op (&bench, "search");
+	op_iterate = ascli_benchmark_add_op (&bench, "iterate");
+	op_daemon = ascli_benchmark_add_op (&bench, "daemon-search");
+
+	/* parse all metadata and write a new cache */
+	for (guint i = 0; i < iterations; i++) {
+		g_autoptr(AsPool) tmp_pool = ascli_benchmark_pool_new (&bench, TRUE);
+		gint64 start = g_get_monotonic_time ();
+
+		if (!as_pool_load (tmp_pool, NULL, &error)) {
+			ascli_print_stderr (_("Unable to load metadata pool: %s"), error->message);
+			ret = ASCLI_EXIT_CODE_FAILED;
+			goto out;
+		}
+		ascli_benchmark_op_add_sample (op_rebuild, start);
+	}
+
+	/* load a new pool from the up-to-date cache, as a freshly started application would */
+	for (guint i = 0; i < iterations; i++) {
+		g_autoptr(AsPool) tmp_pool = NULL;
+		gint64 start = g_get_monotonic_time ();
+
+		tmp_pool = ascli_benchmark_pool_new (&bench, FALSE);
+		if (!as_pool_load (tmp_pool, NULL, &error)) {
+			ascli_print_stderr (_("Unable to load metadata pool: %s"), error->message);
+			ret = ASCLI_EXIT_CODE_FAILED;
+			goto out;
+		}
+		ascli_benchmark_op_add_sample (op_load_cold, start);
+	}
+
+	/* reload a pool that is already in use */
+	pool = ascli_benchmark_pool_new (&bench, FALSE);
+	for (guint i = 0; i < iterations + 1; i++) {
+		gint64 start = g_get_monotonic_time ();
+
+		if (!as_pool_load (pool, NULL, &error)) {
+			ascli_print_stderr (_("Unable to load metadata pool: %s"), error->message);
+			ret = ASCLI_EXIT_CODE_FAILED;
+			goto out;
+		}
+		/* the first load only brings the pool into its warm state */
+		if (i > 0)
+			ascli_benchmark_op_add_sample (op_load_warm, start);
+	}
+
+	all_cpts = as_pool_get_components (pool);
+	n_components = as_component_box_len (all_cpts);
+
+	/* pick IDs spread over the whole pool */
+	ids = g_ptr_array_new_with_free_func (g_free);
+	for (guint i = 0; i < MIN (n_components, ASCLI_BENCHMARK_MAX_IDS); i++) {
+		guint idx = (guint) (((guint64) i * n_components) /
+				     MIN (n_components, ASCLI_BENCHMARK_MAX_IDS));
+		AsComponent *cpt = as_component_box_index (all_cpts, idx);
+		g_ptr_array_add (ids, g_strdup (as_component_get_id (cpt)));
+	}
+	g_clear_object (&all_cpts);
+
+	for (guint i = 0; i < iterations; i++) {
+		for (guint j = 0; j < ids->len; j++) {
+			g_autoptr(AsComponentBox) result = NULL;
+			gint64 start = g_get_monotonic_time ();
+
+			result = as_pool_get_components_by_id (pool, g_ptr_array_index (ids, j));
+			ascli_benchmark_op_add_sample (op_get_by_id, start);
+		}
+
+		for (guint j = 0; ascli_benchmark_categories[j] != NULL; j++) {
+			g_autoptr(AsComponentBox) result = NULL;
+			gchar *categories[] = { (gchar *) ascli_benchmark_categories[j], NULL };
+			gint64 start = g_get_monotonic_time ();
+
+			result = as_pool_get_components_by_categories (pool, categories);
+			ascli_benchmark_op_add_sample (op_categories, start);
+		}
+
+		for (guint j = 0; ascli_benchmark_search_terms[j] != NULL; j++) {
+			g_autoptr(AsComponentBox) result = NULL;
+			gint64 start = g_get_monotonic_time ();
+
+			result = as_pool_search (pool, ascli_benchmark_search_terms[j]);
+			ascli_benchmark_op_add_sample (op_search, start);
+		}
+
+		{
+			g_autoptr(AsComponentBox) result = NULL;
+			gint64 start = g_get_monotonic_time ();
+			gsize n_chars = 0;
+
+			/* touch the data that list views typically show */
+			result = as_pool_get_components (pool);
+			for (guint j = 0; j < as_component_box_len (result); j++) {
+				AsComponent *cpt = as_component_box_index (result, j);
+				const gchar *name = as_component_get_name (cpt);
+				const gchar *summary = as_component_get_summary (cpt);
+				n_chars += name == NULL ? 0 : strlen (name);
+				n_chars += summary == NULL ? 0 : strlen (summary);
+			}
+			ascli_benchmark_op_add_sample (op_iterate, start);
+			g_debug ("Iterated over %" G_GSIZE_FORMAT " characters of text.", n_chars);
+		}
+	}
+
+	/* measure the same searches with a query daemon serving the pool we just used,
+	 * so the difference is the cost of the round trip */
+	socket_path = g_build_filename (bench.cache_dir, "query.socket", NULL);
+	daemon = ascli_daemon_server_start (pool, socket_path, &error);
+	if (daemon == NULL) {
+		ascli_benchmark_op_fail (op_daemon, error->message);
+		g_clear_error (&error);
+	}
+	for (guint i = 0; daemon != NULL && i < iterations; i++) {
+		for (guint j = 0; ascli_benchmark_search_terms[j] != NULL; j++) {
+			g_autoptr(AsComponentBox) result = NULL;
+			g_autoptr(GError) tmp_error = NULL;
+			gint64 start = g_get_monotonic_time ();
+
+			result = ascli_daemon_query (socket_path,
+						     ASCLI_QUERY_KIND_SEARCH,
+						     ascli_benchmark_search_terms[j],
+						     NULL,
+						     &tmp_error);
+			if (result == NULL) {
+				ascli_benchmark_op_fail (op_daemon, tmp_error->message);
+				goto daemon_done;
+			}
+			ascli_benchmark_op_add_sample (op_daemon, start);
+		}
+	}
+daemon_done:
+	g_clear_pointer (&daemon, ascli_daemon_server_stop);
+
+	ascli_benchmark_read_memory (&rss_kib, &peak_kib);
+
+	for (guint i = 0; i < bench.ops->len; i++) {
+		AsCliBenchmarkOp *op = g_ptr_array_index (bench.ops, i);
+		g_array_sort (op->samples, ascli_benchmark_cmp_samples);
+	}
+
+	if (oformat == ASCLI_OUTPUT_FORMAT_JSON)
+		ascli_benchmark_print_json (&bench, n_components, rss_kib, peak_kib);
+	else
+		ascli_benchmark_print_text (&bench, n_components, rss_kib, peak_kib);
+
+out:
+	g_ptr_array_unref (bench.ops);
+	as_utils_delete_dir_recursive (bench.cache_dir);
+	g_free (bench.cache_dir);
+	return ret;
+}
@@ -24,10 +24,46 @@
 #include <glib/gi18n-lib.h>
 #include <stdio.h>
 #include <glib/gstdio.h>
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#include <gio/gunixoutputstream.h>
+#endif
 
 #include "ascli-utils.h"
+#include "ascli-daemon.h"
 #include "as-utils-private.h"
 #include "as-pool-private.h"
+#include "as-metadata-private.h"
+
+/**
+ * ascli_refresh_progress_cb:
+ *
+ * Print the result of refreshing a cache section.
+ */
+static void
+ascli_refresh_progress_cb (const gchar *section,
+			   AsPoolSectionState state,
+			   gint64 duration_usec,
+			   gpointer user_data)
+{
+	g_autofree gchar *duration = NULL;
+
+	if (state == AS_POOL_SECTION_STATE_STARTED) {
+		g_debug ("Refreshing cache section: %s", section);
+		return;
+	}
+
+	duration = g_strdup_printf ("%.2f s", duration_usec / (gdouble) G_USEC_PER_SEC);
+	if (state == AS_POOL_SECTION_STATE_UPDATED)
+		/* TRANSLATORS: In ascli: A cache section was rebuilt, e.g. "os-catalog: updated (1.20 s)" */
+		g_print ("  %s: %s (%s)\n", section, _("updated"), duration);
+	else if (state == AS_POOL_SECTION_STATE_UNCHANGED)
+		/* TRANSLATORS: In ascli: A cache section did not need to be rebuilt */
+		g_print ("  %s: %s (%s)\n", section, _("up to date"), duration);
+	else
+		/* TRANSLATORS: In ascli: Rebuilding a cache section failed */
+		g_print ("  %s: %s (%s)\n", section, _("failed"), duration);
+}
 
 /**
  * ascli_refresh_cache:
@@ -36,7 +72,8 @@ int
 ascli_refresh_cache (const gchar *cachepath,
 		     const gchar *datapath,
 		     const gchar *const *sources_str,
-		     gboolean forced)
+		     gboolean forced,
+		     guint n_jobs)
 {
 	g_autoptr(AsPool) pool = NULL;
 	g_autoptr(GError) error = NULL;
@@ -81,7 +118,13 @@ ascli_refresh_cache (const gchar *cachepath,
 	}
 
 	if (cachepath == NULL) {
-		ret = as_pool_refresh_system_cache (pool, forced, &cache_updated, &error);
+		ret = as_pool_refresh_system_cache (pool,
+						    forced,
+						    n_jobs,
+						    ascli_refresh_progress_cb,
+						    NULL,
+						    &cache_updated,
+						    &error);
 	} else {
 		as_pool_override_cache_locations (pool, cachepath, NULL);
 		ret = as_pool_load (pool, NULL, &error);
@@ -122,7 +165,6 @@ ascli_get_component (const gchar *cachepath,
 		     gboolean detailed,
 		     gboolean no_cache)
 {
-	g_autoptr(AsPool) dpool = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(AsComponentBox) result = NULL;
 
@@ -132,13 +174,17 @@ ascli_get_component (const gchar *cachepath,
 		return 2;
 	}
 
-	dpool = ascli_data_pool_new_and_open (cachepath, no_cache, &error);
-	if (error != NULL) {
+	result = ascli_query_components (cachepath,
+					 no_cache,
+					 ASCLI_QUERY_KIND_GET,
+					 identifier,
+					 NULL,
+					 &error);
+	if (result == NULL) {
 		g_printerr ("%s\n", error->message);
 		return 1;
 	}
 
-	result = as_pool_get_components_by_id (dpool, identifier);
 	if (as_component_box_is_empty (result)) {
 		ascli_print_stderr (_("Unable to find component with ID '%s'!"), identifier);
 		return 4;
@@ -151,35 +197,69 @@ ascli_get_component (const gchar *cachepath,
 
 /**
  * ascli_search_component:
+ *
+ * Search for components, and print a page of the results as text or JSON.
  */
 int
 ascli_search_component (const gchar *cachepath,
 			const gchar *search_term,
 			gboolean detailed,
-			gboolean no_cache)
+			gboolean no_cache,
+			AsCliOutputFormat oformat,
+			guint offset,
+			guint limit,
+			gchar **fields)
 {
-	g_autoptr(AsPool) pool = NULL;
 	g_autoptr(AsComponentBox) result = NULL;
 	g_autoptr(GError) error = NULL;
+	guint n_results;
 
 	if (search_term == NULL) {
 		fprintf (stderr, "%s\n", _("You need to specify a term to search for."));
 		return 2;
 	}
 
-	pool = ascli_data_pool_new_and_open (cachepath, no_cache, &error);
-	if (error != NULL) {
+	result = ascli_query_components (cachepath,
+					 no_cache,
+					 ASCLI_QUERY_KIND_SEARCH,
+					 search_term,
+					 NULL,
+					 &error);
+	if (result == NULL) {
 		g_printerr ("%s\n", error->message);
 		return 1;
 	}
 
-	result = as_pool_search (pool, search_term);
+	if (oformat == ASCLI_OUTPUT_FORMAT_JSON || oformat == ASCLI_OUTPUT_FORMAT_NDJSON) {
+		/* machine-readable output is printed even for an empty result */
+		ascli_print_components_json (result,
+					     offset,
+					     limit,
+					     fields,
+					     oformat == ASCLI_OUTPUT_FORMAT_NDJSON);
+		return 0;
+	}
+
 	if (as_component_box_is_empty (result)) {
 		/* TRANSLATORS: We got no full-text search results */
 		ascli_print_stdout (_("No component matching '%s' found."), search_term);
 		return 0;
 	}
 
+	/* drop the results outside of the requested page */
+	n_results = as_component_box_len (result);
+	if (offset > 0 || (limit > 0 && limit < n_results)) {
+		g_autoptr(AsComponentBox) page = as_component_box_new_simple ();
+		guint end = n_results;
+
+		if (limit > 0 && offset < n_results && limit < n_results - offset)
+			end = offset + limit;
+		for (guint i = offset; i < end; i++)
+			as_component_box_add (page, as_component_box_index (result, i), NULL);
+		g_clear_pointer (&result, g_object_unref);
+		result = g_steal_pointer (&page);
+	}
+
 	/* show the result */
 	ascli_print_components (result, detailed);
 
@@ -197,7 +277,6 @@ ascli_what_provides (const gchar *cachepath,
 		     const gchar *item,
 		     gboolean detailed)
 {
-	g_autoptr(AsPool) pool = NULL;
 	g_autoptr(AsComponentBox) result = NULL;
 	AsProvidedKind kind;
 	g_autoptr(GError) error = NULL;
@@ -216,13 +295,17 @@ ascli_what_provides (const gchar *cachepath,
 		return 3;
 	}
 
-	pool = ascli_data_pool_new_and_open (cachepath, FALSE, &error);
-	if (error != NULL) {
+	result = ascli_query_components (cachepath,
+					 FALSE,
+					 ASCLI_QUERY_KIND_PROVIDES,
+					 kind_str,
+					 item,
+					 &error);
+	if (result == NULL) {
 		g_printerr ("%s\n", error->message);
 		return 1;
 	}
 
-	result = as_pool_get_components_by_provided_item (pool, kind, item);
 	if (as_component_box_len (result)) {
 		/* TRANSLATORS: Search for provided items (e.g. mimetypes, modaliases, ..) yielded no results */
 		ascli_print_stdout (
@@ -370,17 +453,163 @@ ascli_put_metainfo (const gchar *fname, const gchar *origin, gboolean for_user)
 	return 0;
 }
 
+/**
+ * ascli_open_output_stream:
+ *
+ * Open a stream to write converted metadata to, compressing it if the
+ * file name requests that.
+ */
+static GOutputStream *
+ascli_open_output_stream (const gchar *out_fname, GFileOutputStream **fos_out, GError **error)
+{
+	g_autoptr(GFile) outfile = NULL;
+	g_autoptr(GFileOutputStream) fos = NULL;
+
+	if (g_strcmp0 (out_fname, "-") == 0) {
+#ifdef G_OS_UNIX
+		return g_unix_output_stream_new (STDOUT_FILENO, FALSE);
+#else
+		return g_memory_output_stream_new_resizable ();
+#endif
+	}
+
+	outfile = g_file_new_for_path (out_fname);
+	fos = g_file_replace (outfile, NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, NULL, error);
+	if (fos == NULL)
+		return NULL;
+	*fos_out = g_object_ref (fos);
+
+	if (g_str_has_suffix (out_fname, ".gz")) {
+		g_autoptr(GZlibCompressor) compressor = NULL;
+
+		compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+		return g_converter_output_stream_new (G_OUTPUT_STREAM (fos), G_CONVERTER (compressor));
+	}
+
+	return G_OUTPUT_STREAM (g_steal_pointer (&fos));
+}
+
+/**
+ * ascli_convert_catalog_stream:
+ *
+ * Convert catalog data component by component, without loading
+ * the whole catalog into memory.
+ */
+static int
+ascli_convert_catalog_stream (AsMetadata *metad,
+			      GFile *infile,
+			      const gchar *in_fname,
+			      const gchar *out_fname,
+			      AsFormatKind mformat,
+			      guint n_jobs)
+{
+	g_autoptr(GFileInfo) info = NULL;
+	g_autoptr(GInputStream) file_stream = NULL;
+	g_autoptr(GInputStream) istream = NULL;
+	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(GFileOutputStream) fos = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *content_type = NULL;
+	AsFormatKind in_format = AS_FORMAT_KIND_XML;
+
+	if (mformat != AS_FORMAT_KIND_XML && mformat != AS_FORMAT_KIND_YAML) {
+		ascli_print_stderr (_("Catalog metadata can only be converted to XML or YAML."));
+		return 3;
+	}
+
+	info = g_file_query_info (infile,
+				  G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+				  G_FILE_QUERY_INFO_NONE,
+				  NULL,
+				  NULL);
+	if (info != NULL)
+		content_type = g_file_info_get_attribute_string (
+		    info,
+		    G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
+
+	/* detect the input format the same way as_metadata_parse_file() does */
+	if (g_strcmp0 (content_type, "application/x-yaml") == 0 ||
+	    g_str_has_suffix (in_fname, ".yml.gz") || g_str_has_suffix (in_fname, ".yaml.gz") ||
+	    g_str_has_suffix (in_fname, ".yml") || g_str_has_suffix (in_fname, ".yaml"))
+		in_format = AS_FORMAT_KIND_YAML;
+
+	file_stream = G_INPUT_STREAM (g_file_read (infile, NULL, &error));
+	if (file_stream == NULL) {
+		g_printerr ("%s\n", error->message);
+		return 1;
+	}
+	if (g_strcmp0 (content_type, "application/gzip") == 0 ||
+	    g_strcmp0 (content_type, "application/x-gzip") == 0) {
+		g_autoptr(GZlibDecompressor) decompressor = NULL;
+
+		decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+		istream = g_converter_input_stream_new (file_stream, G_CONVERTER (decompressor));
+	} else {
+		istream = g_object_ref (file_stream);
+	}
+
+	ostream = ascli_open_output_stream (out_fname, &fos, &error);
+	if (ostream == NULL) {
+		g_printerr ("%s\n", error->message);
+		return 1;
+	}
+
+	if (!as_metadata_convert_catalog_stream (metad,
+						 istream,
+						 in_format,
+						 in_fname,
+						 ostream,
+						 mformat,
+						 n_jobs,
+						 &error)) {
+		if (fos != NULL) {
+			g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+
+			/* keep any existing file, instead of replacing it with partial data */
+			g_cancellable_cancel (cancellable);
+			g_output_stream_close (G_OUTPUT_STREAM (fos), cancellable, NULL);
+		}
+		g_printerr ("%s\n", error->message);
+		return 1;
+	}
+
+	if (fos == NULL) {
+		/* we print to stdout */
+		if (!g_output_stream_write_all (ostream, "\n", 1, NULL, NULL, &error)) {
+			g_printerr ("%s\n", error->message);
+			return 1;
+		}
+#ifndef G_OS_UNIX
+		fwrite (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+			1,
+			g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream)),
+			stdout);
+#endif
+	}
+
+	if (!g_output_stream_close (ostream, NULL, &error)) {
+		g_printerr ("%s\n", error->message);
+		return 1;
+	}
+
+	return 0;
+}
+
 /**
  * ascli_convert_data:
  *
  * Convert data from YAML to XML and vice versa.
  */
 int
-ascli_convert_data (const gchar *in_fname, const gchar *out_fname, AsFormatKind mformat)
+ascli_convert_data (const gchar *in_fname,
+		    const gchar *out_fname,
+		    AsFormatKind mformat,
+		    guint n_jobs)
 {
 	g_autoptr(AsMetadata) metad = NULL;
 	g_autoptr(GFile) infile = NULL;
 	g_autoptr(GError) error = NULL;
+	gboolean is_yaml;
 
 	if (in_fname == NULL || out_fname == NULL) {
 		ascli_print_stderr (_("You need to specify an input and output file."));
@@ -394,16 +623,39 @@ ascli_convert_data (const gchar *in_fname, const gchar *out_fname, AsFormatKind
 		return 4;
 	}
 
+	is_yaml = g_str_has_suffix (in_fname, ".yml.gz") || g_str_has_suffix (in_fname, ".yaml.gz") ||
+		  g_str_has_suffix (in_fname, ".yml") || g_str_has_suffix (in_fname, ".yaml");
+
+	if (mformat == AS_FORMAT_KIND_UNKNOWN) {
+		if (g_str_has_suffix (in_fname, ".xml") || g_str_has_suffix (in_fname, ".xml.gz"))
+			mformat = AS_FORMAT_KIND_YAML;
+		else if (is_yaml)
+			mformat = AS_FORMAT_KIND_XML;
+
+		if (mformat == AS_FORMAT_KIND_UNKNOWN) {
+			/* TRANSLATORS: User is trying to convert a file in ascli */
+			ascli_print_stderr (
+			    _("Unable to convert file: Could not determine output format, please set it explicitly using '--format='."));
+			return 3;
+		}
+	}
+
 	metad = as_metadata_new ();
 	as_metadata_set_locale (metad, "ALL");
 
-	if ((g_str_has_suffix (in_fname, ".yml.gz")) || (g_str_has_suffix (in_fname, ".yaml.gz")) ||
-	    (g_str_has_suffix (in_fname, ".yml")) || (g_str_has_suffix (in_fname, ".yaml"))) {
-		/* if we have YAML, we also automatically assume a catalog style */
-		as_metadata_set_format_style (metad, AS_FORMAT_STYLE_CATALOG);
-	} else if (g_str_has_suffix (in_fname, ".metainfo.xml") ||
-		   g_str_has_suffix (in_fname, ".appdata.xml")) {
+	if (g_str_has_suffix (in_fname, ".metainfo.xml") ||
+	    g_str_has_suffix (in_fname, ".appdata.xml")) {
 		as_metadata_set_format_style (metad, AS_FORMAT_STYLE_METAINFO);
+	} else if (is_yaml || g_str_has_suffix (in_fname, ".xml") ||
+		   g_str_has_suffix (in_fname, ".xml.gz")) {
+		/* if we have YAML, we also automatically assume a catalog style,
+		 * which we can convert without having all components in memory */
+		return ascli_convert_catalog_stream (metad,
+						     infile,
+						     in_fname,
+						     out_fname,
+						     mformat,
+						     n_jobs);
 	} else {
 		as_metadata_set_format_style (metad, AS_FORMAT_STYLE_CATALOG);
 	}
@@ -417,23 +669,6 @@ ascli_convert_data (const gchar *in_fname, const gchar *out_fname, AsFormatKind
 	/* since YAML files are always catalog-YAMLs, we will always run in catalog mode */
 	as_metadata_set_format_style (metad, AS_FORMAT_STYLE_CATALOG);
 
-	if (mformat == AS_FORMAT_KIND_UNKNOWN) {
-		if (g_str_has_suffix (in_fname, ".xml") || g_str_has_suffix (in_fname, ".xml.gz"))
-			mformat = AS_FORMAT_KIND_YAML;
-		else if (g_str_has_suffix (in_fname, ".yml") ||
-			 g_str_has_suffix (in_fname, ".yml.gz") ||
-			 g_str_has_suffix (in_fname, ".yaml") ||
-			 g_str_has_suffix (in_fname, ".yaml.gz"))
-			mformat = AS_FORMAT_KIND_XML;
-
-		if (mformat == AS_FORMAT_KIND_UNKNOWN) {
-			/* TRANSLATORS: User is trying to convert a file in ascli */
-			ascli_print_stderr (
-			    _("Unable to convert file: Could not determine output format, please set it explicitly using '--format='."));
-			return 3;
-		}
-	}
-
 	if (g_strcmp0 (out_fname, "-") == 0) {
 		g_autofree gchar *data = NULL;
 
@@ -24,6 +24,8 @@
 #include <glib-object.h>
 #include <appstream.h>
 
+#include "ascli-utils.h"
+
 G_BEGIN_DECLS
 
 int  ascli_what_provides (const gchar *cachepath,
@@ -31,10 +33,14 @@ int  ascli_what_provides (const gchar *cachepath,
 			  const gchar *item,
 			  gboolean     detailed);
 
-int  ascli_search_component (const gchar *cachepath,
-			     const gchar *search_term,
-			     gboolean	  detailed,
-			     gboolean	  no_cache);
+int  ascli_search_component (const gchar	   *cachepath,
+			     const gchar	   *search_term,
+			     gboolean		    detailed,
+			     gboolean		    no_cache,
+			     AsCliOutputFormat oformat,
+			     guint		    offset,
+			     guint		    limit,
+			     gchar		  **fields);
 
 int  ascli_get_component (const gchar *cachepath,
 			  const gchar *identifier,
@@ -49,7 +55,8 @@ int  ascli_list_categories (const gchar *cachepath,
 int  ascli_refresh_cache (const gchar	     *cachepath,
 			  const gchar	     *datapath,
 			  const gchar *const *sources_str,
-			  gboolean	      forced);
+			  gboolean	      forced,
+			  guint		      n_jobs);
 
 int  ascli_dump_component (const gchar *cachepath,
 			   const gchar *identifier,
@@ -58,7 +65,10 @@ int  ascli_dump_component (const gchar *cachepath,
 
 int  ascli_put_metainfo (const gchar *fname, const gchar *origin, gboolean for_user);
 
-int  ascli_convert_data (const gchar *in_fname, const gchar *out_fname, AsFormatKind mformat);
+int  ascli_convert_data (const gchar *in_fname,
+			 const gchar *out_fname,
+			 AsFormatKind mformat,
+			 guint	      n_jobs);
 
 int  ascli_create_metainfo_template (const gchar *out_fname,
 				     const gchar *cpt_kind_str,
@@ -116,7 +116,8 @@ create_issue_info_print_string (AsValidatorIssue *issue, guint indent)
  * print_single_issue:
  **/
 static gboolean
-print_single_issue (AsValidatorIssue *issue,
+print_single_issue (GString *out,
+		    AsValidatorIssue *issue,
 		    gboolean pedantic,
 		    gboolean explained,
 		    gint indent,
@@ -160,9 +161,9 @@ print_single_issue (AsValidatorIssue *issue,
 		    as_validator_issue_get_explanation (issue),
 		    100,
 		    indent + 3);
-		g_print ("%s\n%s\n\n", title, explanation);
+		g_string_append_printf (out, "%s\n%s\n\n", title, explanation);
 	} else {
-		g_print ("%s\n", title);
+		g_string_append_printf (out, "%s\n", title);
 	}
 
 	return no_errors;
@@ -170,9 +171,11 @@ print_single_issue (AsValidatorIssue *issue,
 
 /**
  * ascli_print_validation_result:
+ * @out: String to append the printable result to.
  */
 static gboolean
 ascli_print_validation_result (AsValidator *validator,
+			       GString *out,
 			       gboolean pedantic,
 			       gboolean explain,
 			       gboolean strict,
@@ -200,16 +203,23 @@ ascli_print_validation_result (AsValidator *validator,
 			if (filename == NULL)
 				filename = "<unknown>";
 			if (ascli_get_output_colored ())
-				g_print ("%c[%dm%s%c[%dm\n", 0x1B, 1, filename, 0x1B, 0);
+				g_string_append_printf (out,
+							"%c[%dm%s%c[%dm\n",
+							0x1B,
+							1,
+							filename,
+							0x1B,
+							0);
 			else
-				g_print ("%s\n", filename);
+				g_string_append_printf (out, "%s\n", filename);
 		}
 
 		for (guint i = 0; i < issues->len; i++) {
 			AsValidatorIssue *issue = AS_VALIDATOR_ISSUE (
 			    g_ptr_array_index (issues, i));
 
-			if (!print_single_issue (issue,
+			if (!print_single_issue (out,
+						 issue,
 						 pedantic,
 						 explain,
 						 print_filenames ? 2 : 0,
@@ -226,7 +236,7 @@ ascli_print_validation_result (AsValidator *validator,
 
 		/* space out contents from different files a bit more if we only show tags */
 		if (!explain)
-			g_print ("\n");
+			g_string_append_c (out, '\n');
 	}
 
 	return validation_passed;
@@ -274,60 +284,213 @@ ascli_validate_apply_overrides_from_string (AsValidator *validator, const gchar
 	return TRUE;
 }
 
+typedef struct {
+	const gchar *fname;
+
+	gboolean done;
+	gboolean exists;
+	gboolean passed;
+	GString *output;
+	gulong error_count;
+	gulong warning_count;
+	gulong info_count;
+	gulong pedantic_count;
+} AscliValidateJob;
+
+typedef struct {
+	GPtrArray *validators_all; /* one validator per worker */
+	GAsyncQueue *validators;   /* the currently idle validators */
+	GThreadPool *pool;
+	GMutex mutex;
+	GCond cond;
+
+	gboolean yaml_report;
+	gboolean print_filenames;
+	gboolean pedantic;
+	gboolean explain;
+	gboolean strict;
+} AscliValidateContext;
+
+static void
+ascli_validate_job_free (AscliValidateJob *job)
+{
+	if (job->output != NULL)
+		g_string_free (job->output, TRUE);
+	g_free (job);
+}
+
 /**
- * ascli_validate_file:
+ * ascli_validate_job_run:
+ *
+ * Validate a single file with one of the idle validators, and store
+ * the printable result. May be called from multiple threads at once.
  **/
-static gboolean
-ascli_validate_file (AsValidator *validator,
-		     const gchar *fname,
-		     gboolean print_filename,
-		     gboolean pedantic,
-		     gboolean explain,
-		     gboolean validate_strict,
-		     gboolean use_net,
-		     const gchar *overrides_str,
-		     gulong *error_count,
-		     gulong *warning_count,
-		     gulong *info_count,
-		     gulong *pedantic_count)
+static void
+ascli_validate_job_run (gpointer data, gpointer user_data)
 {
-	GFile *file;
-	gboolean validation_passed = TRUE;
+	AscliValidateJob *job = (AscliValidateJob *) data;
+	AscliValidateContext *ctx = (AscliValidateContext *) user_data;
+	AsValidator *validator;
+	g_autoptr(GFile) file = NULL;
+
+	file = g_file_new_for_path (job->fname);
+	job->exists = g_file_query_exists (file, NULL);
+	if (job->exists) {
+		validator = g_async_queue_pop (ctx->validators);
+
+		/* validate! */
+		job->passed = as_validator_validate_file (validator, file);
+		if (ctx->yaml_report) {
+			g_autofree gchar *yaml_result = as_validator_get_report_yaml (validator,
+										      NULL);
+			job->output = g_string_new (yaml_result);
+		} else {
+			job->output = g_string_new ("");
+			job->passed = ascli_print_validation_result (validator,
+								     job->output,
+								     ctx->pedantic,
+								     ctx->explain,
+								     ctx->strict,
+								     ctx->print_filenames,
+								     &job->error_count,
+								     &job->warning_count,
+								     &job->info_count,
+								     &job->pedantic_count)
+					  ? job->passed
+					  : FALSE;
+		}
 
-	file = g_file_new_for_path (fname);
-	if (!g_file_query_exists (file, NULL)) {
-		g_printerr (_("File '%s' does not exist."), fname);
-		g_printerr ("\n");
-		g_object_unref (file);
-		return FALSE;
+		g_async_queue_push (ctx->validators, validator);
 	}
 
-	as_validator_set_check_urls (validator, use_net);
-	as_validator_set_strict (validator, validate_strict);
+	g_mutex_lock (&ctx->mutex);
+	job->done = TRUE;
+	g_cond_broadcast (&ctx->cond);
+	g_mutex_unlock (&ctx->mutex);
+}
 
-	/* apply user overrides */
-	if (!ascli_validate_apply_overrides_from_string (validator, overrides_str))
-		return FALSE;
+/**
+ * ascli_validate_context_new:
+ * @n_jobs: Number of files to validate at the same time, or 0 to use one per CPU.
+ * @n_files: Number of files that will be validated.
+ *
+ * Create the state to validate files with, and one validator per worker.
+ *
+ * Returns: A new #AscliValidateContext
+ **/
+static AscliValidateContext *
+ascli_validate_context_new (guint n_jobs, guint n_files, gboolean use_net, gboolean validate_strict)
+{
+	AscliValidateContext *ctx = g_new0 (AscliValidateContext, 1);
 
-	/* validate! */
-	if (!as_validator_validate_file (validator, file))
-		validation_passed = FALSE;
+	if (n_jobs == 0)
+		n_jobs = g_get_num_processors ();
+	n_jobs = MAX (MIN (n_jobs, n_files), 1);
 
-	validation_passed = ascli_print_validation_result (validator,
-							   pedantic,
-							   explain,
-							   validate_strict,
-							   print_filename,
-							   error_count,
-							   warning_count,
-							   info_count,
-							   pedantic_count)
-				? validation_passed
-				: FALSE;
+	g_mutex_init (&ctx->mutex);
+	g_cond_init (&ctx->cond);
+	ctx->strict = validate_strict;
+	ctx->validators = g_async_queue_new ();
+	ctx->validators_all = g_ptr_array_new_with_free_func (g_object_unref);
+	for (guint i = 0; i < n_jobs; i++) {
+		AsValidator *validator = as_validator_new ();
 
-	g_object_unref (file);
+		as_validator_set_check_urls (validator, use_net);
+		as_validator_set_strict (validator, validate_strict);
+		g_ptr_array_add (ctx->validators_all, validator);
+		g_async_queue_push (ctx->validators, validator);
+	}
 
-	return validation_passed;
+	if (n_jobs > 1)
+		ctx->pool = g_thread_pool_new (ascli_validate_job_run, ctx, n_jobs, FALSE, NULL);
+
+	return ctx;
+}
+
+/**
+ * ascli_validate_context_setup:
+ * @release_files: Release metadata files to add to every validator.
+ * @exit_code: (out): Exit code to use if this function fails.
+ *
+ * Apply the same settings to all validators. Errors are printed to stderr.
+ *
+ * Returns: %TRUE on success.
+ **/
+static gboolean
+ascli_validate_context_setup (AscliValidateContext *ctx,
+			      GPtrArray *release_files,
+			      const gchar *overrides_str,
+			      gint *exit_code)
+{
+	for (guint i = 0; i < ctx->validators_all->len; i++) {
+		AsValidator *validator = g_ptr_array_index (ctx->validators_all, i);
+
+		for (guint j = 0; j < release_files->len; j++) {
+			g_autoptr(GError) local_error = NULL;
+			g_autoptr(GFile) file = g_file_new_for_path (
+			    g_ptr_array_index (release_files, j));
+			if (!as_validator_add_release_file (validator, file, &local_error)) {
+				ascli_print_stderr (_("Unable to add release metadata file: %s"),
+						       local_error->message);
+				*exit_code = ASCLI_EXIT_CODE_FATAL;
+				return FALSE;
+			}
+		}
+
+		/* apply user overrides */
+		if (!ascli_validate_apply_overrides_from_string (validator, overrides_str)) {
+			*exit_code = ASCLI_EXIT_CODE_BAD_INPUT;
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static void
+ascli_validate_context_free (AscliValidateContext *ctx)
+{
+	if (ctx->pool != NULL)
+		g_thread_pool_free (ctx->pool, FALSE, TRUE);
+	g_async_queue_unref (ctx->validators);
+	g_ptr_array_unref (ctx->validators_all);
+	g_mutex_clear (&ctx->mutex);
+	g_cond_clear (&ctx->cond);
+	g_free (ctx);
+}
+
+/**
+ * ascli_validate_context_start:
+ *
+ * Queue all files for validation.
+ **/
+static void
+ascli_validate_context_start (AscliValidateContext *ctx, GPtrArray *jobs)
+{
+	if (ctx->pool == NULL)
+		return;
+	for (guint i = 0; i < jobs->len; i++)
+		g_thread_pool_push (ctx->pool, g_ptr_array_index (jobs, i), NULL);
+}
+
+/**
+ * ascli_validate_context_wait:
+ *
+ * Wait until the given job is done, so results can be printed in the order
+ * the files were passed in.
+ **/
+static void
+ascli_validate_context_wait (AscliValidateContext *ctx, AscliValidateJob *job)
+{
+	if (ctx->pool == NULL) {
+		ascli_validate_job_run (job, ctx);
+		return;
+	}
+
+	g_mutex_lock (&ctx->mutex);
+	while (!job->done)
+		g_cond_wait (&ctx->cond, &ctx->mutex);
+	g_mutex_unlock (&ctx->mutex);
 }
 
 /**
@@ -381,63 +544,80 @@ ascli_validate_files (gchar **argv,
 		      gboolean explain,
 		      gboolean validate_strict,
 		      gboolean use_net,
-		      const gchar *overrides_str)
+		      const gchar *overrides_str,
+		      guint n_jobs)
 {
 	gboolean ret = TRUE;
 	gulong error_count = 0;
 	gulong warning_count = 0;
 	gulong info_count = 0;
 	gulong pedantic_count = 0;
-	g_autoptr(AsValidator) validator = NULL;
-	g_autoptr(GPtrArray) metainfo_files = NULL;
+	gint exit_code = ASCLI_EXIT_CODE_SUCCESS;
+	AscliValidateContext *ctx;
+	g_autoptr(GPtrArray) release_files = NULL;
+	g_autoptr(GPtrArray) jobs = NULL;
 
 	if (argc < 1) {
 		g_printerr ("%s\n", _("You need to specify at least one file to validate!"));
 		return ASCLI_EXIT_CODE_FAILED;
 	}
 
-	validator = as_validator_new ();
-	metainfo_files = g_ptr_array_new ();
+	release_files = g_ptr_array_new ();
+	jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) ascli_validate_job_free);
 	for (gint i = 0; i < argc; i++) {
 		if (g_strstr_len (argv[i], -1, ".releases.xml") != NULL) {
-			g_autoptr(GError) local_error = NULL;
-			g_autoptr(GFile) file = g_file_new_for_path (argv[i]);
-			if (!as_validator_add_release_file (validator, file, &local_error)) {
-				ascli_print_stderr (_("Unable to add release metadata file: %s"),
-						       local_error->message);
-				return ASCLI_EXIT_CODE_FATAL;
-			}
+			g_ptr_array_add (release_files, argv[i]);
 		} else {
-			g_ptr_array_add (metainfo_files, argv[i]);
+			AscliValidateJob *job = g_new0 (AscliValidateJob, 1);
+			job->fname = argv[i];
+			g_ptr_array_add (jobs, job);
 		}
 	}
-	if (metainfo_files->len == 0) {
+	if (jobs->len == 0) {
 		g_printerr ("%s\n",
 			    _("You need to specify at least one MetaInfo file to validate.\n"
 				      "Release metadata files can currently not be validated without their accompanying MetaInfo file."));
 		return ASCLI_EXIT_CODE_FAILED;
 	}
 
-	for (guint i = 0; i < metainfo_files->len; i++) {
-		const gchar *fname = (const gchar *) g_ptr_array_index (metainfo_files, i);
-		ret = ascli_validate_file (
-			  validator,
-			  fname,
-			  metainfo_files->len >=
-			      2, /* print filenames if we validate multiple files */
-			  pedantic,
-			  explain,
-			  validate_strict,
-			  use_net,
-			  overrides_str,
-			  &error_count,
-			  &warning_count,
-			  &info_count,
-			  &pedantic_count)
-			  ? ret
-			  : FALSE;
+	ctx = ascli_validate_context_new (n_jobs, jobs->len, use_net, validate_strict);
+	ctx->pedantic = pedantic;
+	ctx->explain = explain;
+	ctx->print_filenames = jobs->len >= 2; /* print filenames if we validate multiple files */
+	if (!ascli_validate_context_setup (ctx, release_files, overrides_str, &exit_code)) {
+		ascli_validate_context_free (ctx);
+		if (exit_code != ASCLI_EXIT_CODE_BAD_INPUT)
+			return exit_code;
+		/* no file can be validated with broken overrides */
+		ret = FALSE;
+		goto out;
 	}
 
+	/* files are validated concurrently, but their results are printed in order */
+	ascli_validate_context_start (ctx, jobs);
+	for (guint i = 0; i < jobs->len; i++) {
+		AscliValidateJob *job = g_ptr_array_index (jobs, i);
+
+		ascli_validate_context_wait (ctx, job);
+		if (!job->exists) {
+			g_printerr (_("File '%s' does not exist."), job->fname);
+			g_printerr ("\n");
+			ret = FALSE;
+			continue;
+		}
+
+		g_print ("%s", job->output->str);
+		g_string_free (g_steal_pointer (&job->output), TRUE);
+		error_count += job->error_count;
+		warning_count += job->warning_count;
+		info_count += job->info_count;
+		pedantic_count += job->pedantic_count;
+		if (!job->passed)
+			ret = FALSE;
+	}
+	ascli_validate_context_free (ctx);
+
+out:
 	if (ret) {
 		if ((error_count == 0) && (warning_count == 0) && (info_count == 0) &&
 		    (pedantic_count == 0)) {
@@ -475,7 +655,8 @@ ascli_validate_files_format (gchar **argv,
 			     const gchar *format,
 			     gboolean validate_strict,
 			     gboolean use_net,
-			     const gchar *overrides_str)
+			     const gchar *overrides_str,
+			     guint n_jobs)
 {
 	if (g_strcmp0 (format, "text") == 0) {
 		/* "text" is pretty much the default output,
@@ -487,39 +668,56 @@ ascli_validate_files_format (gchar **argv,
 					     TRUE, /* explain */
 					     validate_strict,
 					     use_net,
-					     overrides_str);
+					     overrides_str,
+					     n_jobs);
 	}
 
 	if (g_strcmp0 (format, "yaml") == 0) {
 		gboolean validation_passed = TRUE;
-		g_autoptr(AsValidator) validator = NULL;
-		g_autofree gchar *yaml_result = NULL;
+		AscliValidateContext *ctx;
+		g_autoptr(GPtrArray) jobs = NULL;
 
 		if (argc < 1) {
 			g_print ("%s\n", _("You need to specify at least one file to validate!"));
 			return 1;
 		}
 
-		validator = as_validator_new ();
-		as_validator_set_check_urls (validator, use_net);
-		as_validator_set_strict (validator, validate_strict);
-
+		jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) ascli_validate_job_free);
 		for (gint i = 0; i < argc; i++) {
-			g_autoptr(GFile) file = NULL;
+			AscliValidateJob *job;
 
-			file = g_file_new_for_path (argv[i]);
-			if (!g_file_query_exists (file, NULL)) {
+			if (!g_file_test (argv[i], G_FILE_TEST_EXISTS)) {
 				g_print (_("File '%s' does not exist."), argv[i]);
 				g_print ("\n");
 				return FALSE;
 			}
 
-			if (!as_validator_validate_file (validator, file))
+			job = g_new0 (AscliValidateJob, 1);
+			job->fname = argv[i];
+			g_ptr_array_add (jobs, job);
+		}
+
+		ctx = ascli_validate_context_new (n_jobs, jobs->len, use_net, validate_strict);
+		ctx->yaml_report = TRUE;
+
+		/* every report is a complete YAML stream, so they can simply be concatenated */
+		ascli_validate_context_start (ctx, jobs);
+		for (guint i = 0; i < jobs->len; i++) {
+			AscliValidateJob *job = g_ptr_array_index (jobs, i);
+
+			ascli_validate_context_wait (ctx, job);
+			if (!job->exists) {
+				validation_passed = FALSE;
+				continue;
+			}
+
+			g_print ("%s", job->output->str);
+			g_string_free (g_steal_pointer (&job->output), TRUE);
+			if (!job->passed)
 				validation_passed = FALSE;
 		}
+		ascli_validate_context_free (ctx);
 
-		yaml_result = as_validator_get_report_yaml (validator, NULL);
-		g_print ("%s", yaml_result);
 		return validation_passed ? 0 : 3;
 	}
 
@@ -542,6 +740,7 @@ ascli_validate_tree (const gchar *root_dir,
 {
 	gboolean validation_passed = TRUE;
 	AsValidator *validator;
+	g_autoptr(GString) out = NULL;
 	gulong error_count = 0;
 	gulong warning_count = 0;
 	gulong info_count = 0;
@@ -560,7 +759,9 @@ ascli_validate_tree (const gchar *root_dir,
 		return 1;
 
 	as_validator_validate_tree (validator, root_dir);
+	out = g_string_new ("");
 	validation_passed = ascli_print_validation_result (validator,
+							   out,
 							   pedantic,
 							   explain,
 							   validate_strict,
@@ -569,6 +770,7 @@ ascli_validate_tree (const gchar *root_dir,
 							   &warning_count,
 							   &info_count,
 							   &pedantic_count);
+	g_print ("%s", out->str);
 	g_object_unref (validator);
 
 	if (validation_passed) {
@@ -31,13 +31,15 @@ gint ascli_validate_files (gchar      **argv,
 			   gboolean	pedantic,
 			   gboolean	validate_strict,
 			   gboolean	use_net,
-			   const gchar *overrides_str);
+			   const gchar *overrides_str,
+			   guint	n_jobs);
 gint ascli_validate_files_format (gchar	     **argv,
 				  gint	       argc,
 				  const gchar *format,
 				  gboolean     validate_strict,
 				  gboolean     use_net,
-				  const gchar *overrides_str);
+				  const gchar *overrides_str,
+				  guint	       n_jobs);
 
 gint ascli_validate_tree (const gchar *root_dir,
 			  gboolean     explain,
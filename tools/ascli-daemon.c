@@ -0,0 +1,698 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2012-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The query daemon keeps a loaded #AsPool around and answers queries
+ * from short-lived appstreamcli processes over a local UNIX socket, so they
+ * do not need to load the metadata cache themselves.
+ *
+ * Protocol: The client sends one request per line, with tab-separated fields
+ * that are escaped using g_strescape():
+ *   AS1 <TAB> KIND <TAB> LOCALE <TAB> VALUE <TAB> EXTRA
+ * The daemon replies with "OK <length>" followed by a line break and <length> bytes
+ * of catalog XML containing the found components, or with "ERR <message>".
+ */
+
+#include "ascli-daemon.h"
+
+#include <config.h>
+#include <errno.h>
+#include <string.h>
+#include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <glib-unix.h>
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include "ascli-utils.h"
+#include "as-utils-private.h"
+#include "as-metadata-private.h"
+
+#define ASCLI_DAEMON_PROTOCOL "AS1"
+
+/* maximum number of queries we answer in parallel */
+#define ASCLI_DAEMON_MAX_THREADS 8
+
+/* seconds to wait for the daemon before loading data ourselves */
+#define ASCLI_DAEMON_CLIENT_TIMEOUT 10
+
+/* refuse replies that are unreasonably large */
+#define ASCLI_DAEMON_MAX_REPLY_SIZE (512 * 1024 * 1024)
+
+static const gchar *ascli_query_kind_names[] = { "unknown", "search", "get", "provides", NULL };
+
+static const gchar *
+ascli_query_kind_to_string (AsCliQueryKind kind)
+{
+	if (kind >= ASCLI_QUERY_KIND_LAST)
+		return ascli_query_kind_names[ASCLI_QUERY_KIND_UNKNOWN];
+	return ascli_query_kind_names[kind];
+}
+
+static AsCliQueryKind
+ascli_query_kind_from_string (const gchar *str)
+{
+	for (guint i = ASCLI_QUERY_KIND_UNKNOWN + 1; i < ASCLI_QUERY_KIND_LAST; i++) {
+		if (g_strcmp0 (str, ascli_query_kind_names[i]) == 0)
+			return (AsCliQueryKind) i;
+	}
+	return ASCLI_QUERY_KIND_UNKNOWN;
+}
+
+/**
+ * ascli_daemon_get_default_socket_path:
+ *
+ * Get the socket the query daemon listens on by default.
+ */
+gchar *
+ascli_daemon_get_default_socket_path (void)
+{
+	return g_build_filename (g_get_user_runtime_dir (), "appstream", "query.socket", NULL);
+}
+
+/**
+ * ascli_pool_query:
+ *
+ * Run a query on a loaded pool.
+ */
+static AsComponentBox *
+ascli_pool_query (AsPool *pool,
+		  AsCliQueryKind kind,
+		  const gchar *value,
+		  const gchar *extra,
+		  GError **error)
+{
+	AsProvidedKind provided_kind;
+
+	switch (kind) {
+	case ASCLI_QUERY_KIND_SEARCH:
+		return as_pool_search (pool, value);
+	case ASCLI_QUERY_KIND_GET:
+		return as_pool_get_components_by_id (pool, value);
+	case ASCLI_QUERY_KIND_PROVIDES:
+		provided_kind = as_provided_kind_from_string (value);
+		if (provided_kind == AS_PROVIDED_KIND_UNKNOWN) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_ARGUMENT,
+				     "Invalid type for provided item: %s",
+				     value);
+			return NULL;
+		}
+		return as_pool_get_components_by_provided_item (pool, provided_kind, extra);
+	default:
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_NOT_SUPPORTED,
+				     "Unknown query type.");
+		return NULL;
+	}
+}
+
+/**
+ * ascli_daemon_components_to_data:
+ * @cbox: The components to send.
+ * @locale: The locale the components were loaded for.
+ * @error: A #GError
+ *
+ * Serialize components for a query reply. Internal data like the origin
+ * and scope of the components is included, so the client gets the same
+ * components a query on its own pool would have returned.
+ *
+ * Returns: (transfer full): Catalog XML data, or %NULL on error.
+ */
+gchar *
+ascli_daemon_components_to_data (AsComponentBox *cbox, const gchar *locale, GError **error)
+{
+	g_autoptr(AsMetadata) mdata = as_metadata_new ();
+
+	as_metadata_set_locale (mdata, locale);
+	as_metadata_set_format_style (mdata, AS_FORMAT_STYLE_CATALOG);
+	as_metadata_set_internal_mode (mdata, TRUE);
+	for (guint i = 0; i < as_component_box_len (cbox); i++)
+		as_metadata_add_component (mdata, as_component_box_index (cbox, i));
+
+	return as_metadata_components_to_catalog (mdata, AS_FORMAT_KIND_XML, error);
+}
+
+/**
+ * ascli_daemon_components_from_data:
+ * @data: Catalog XML data, as created by ascli_daemon_components_to_data()
+ * @data_len: Length of @data, or -1 if it is NUL-terminated.
+ * @locale: The locale the components were loaded for.
+ * @error: A #GError
+ *
+ * Load the components of a query reply.
+ *
+ * Returns: (transfer full): The components, or %NULL on error.
+ */
+AsComponentBox *
+ascli_daemon_components_from_data (const gchar *data,
+				   gssize data_len,
+				   const gchar *locale,
+				   GError **error)
+{
+	g_autoptr(AsComponentBox) cbox = NULL;
+	g_autoptr(AsMetadata) mdata = as_metadata_new ();
+	GPtrArray *cpts;
+
+	as_metadata_set_locale (mdata, locale);
+	as_metadata_set_format_style (mdata, AS_FORMAT_STYLE_CATALOG);
+	as_metadata_set_internal_mode (mdata, TRUE);
+	if (!as_metadata_parse_data (mdata, data, data_len, AS_FORMAT_KIND_XML, error))
+		return NULL;
+
+	cbox = as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+	cpts = as_metadata_get_components (mdata);
+	for (guint i = 0; i < cpts->len; i++)
+		as_component_box_add (cbox, AS_COMPONENT (g_ptr_array_index (cpts, i)), NULL);
+
+	return g_steal_pointer (&cbox);
+}
+
+#ifdef G_OS_UNIX
+
+/**
+ * ascli_daemon_connect:
+ */
+static GSocketConnection *
+ascli_daemon_connect (const gchar *socket_path, GError **error)
+{
+	g_autoptr(GSocketClient) client = NULL;
+	g_autoptr(GSocketAddress) address = NULL;
+
+	client = g_socket_client_new ();
+	g_socket_client_set_timeout (client, ASCLI_DAEMON_CLIENT_TIMEOUT);
+	address = g_unix_socket_address_new (socket_path);
+	return g_socket_client_connect (client, G_SOCKET_CONNECTABLE (address), NULL, error);
+}
+
+/**
+ * ascli_daemon_handle_request:
+ *
+ * Answer a single request line.
+ */
+static GString *
+ascli_daemon_handle_request (AsPool *pool, const gchar *request)
+{
+	g_auto(GStrv) fields = NULL;
+	g_autofree gchar *locale = NULL;
+	g_autofree gchar *value = NULL;
+	g_autofree gchar *extra = NULL;
+	g_autofree gchar *xml_data = NULL;
+	g_autofree gchar *error_msg = NULL;
+	g_autoptr(AsComponentBox) cbox = NULL;
+	g_autoptr(GError) error = NULL;
+	GString *response = g_string_new ("");
+
+	fields = g_strsplit (request, "\t", -1);
+	if (g_strv_length (fields) != 5 || g_strcmp0 (fields[0], ASCLI_DAEMON_PROTOCOL) != 0) {
+		g_string_append (response, "ERR Unsupported request.\n");
+		return response;
+	}
+	locale = g_strcompress (fields[2]);
+	value = g_strcompress (fields[3]);
+	extra = g_strcompress (fields[4]);
+
+	/* we can only answer queries for the locale our data was loaded for */
+	if (g_strcmp0 (locale, as_pool_get_locale (pool)) != 0) {
+		error_msg = g_strdup_printf ("Data is loaded for locale %s, not %s.",
+					     as_pool_get_locale (pool),
+					     locale);
+	} else {
+		cbox = ascli_pool_query (pool,
+					 ascli_query_kind_from_string (fields[1]),
+					 value,
+					 extra,
+					 &error);
+		if (cbox == NULL)
+			error_msg = g_strdup (error->message);
+	}
+
+	if (cbox != NULL && !as_component_box_is_empty (cbox)) {
+		xml_data = ascli_daemon_components_to_data (cbox, as_pool_get_locale (pool), &error);
+		if (xml_data == NULL)
+			error_msg = g_strdup (error->message);
+	}
+
+	if (error_msg != NULL) {
+		g_autofree gchar *error_msg_esc = g_strescape (error_msg, NULL);
+		g_string_append_printf (response, "ERR %s\n", error_msg_esc);
+		return response;
+	}
+
+	if (xml_data == NULL) {
+		g_string_append (response, "OK 0\n");
+	} else {
+		g_string_append_printf (response, "OK %" G_GSIZE_FORMAT "\n", strlen (xml_data));
+		g_string_append (response, xml_data);
+	}
+	return response;
+}
+
+/**
+ * ascli_daemon_run_cb:
+ *
+ * Answer all requests of a client connection.
+ */
+static gboolean
+ascli_daemon_run_cb (GThreadedSocketService *service,
+		     GSocketConnection *connection,
+		     GObject *source_object,
+		     AsPool *pool)
+{
+	GOutputStream *out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+	g_autoptr(GDataInputStream) din = NULL;
+
+	din = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+	while (TRUE) {
+		g_autofree gchar *request = NULL;
+		g_autoptr(GString) response = NULL;
+		g_autoptr(GError) error = NULL;
+
+		request = g_data_input_stream_read_line (din, NULL, NULL, &error);
+		if (request == NULL) {
+			if (error != NULL)
+				g_debug ("Unable to read query request: %s", error->message);
+			break;
+		}
+
+		response = ascli_daemon_handle_request (pool, request);
+		if (!g_output_stream_write_all (out,
+						response->str,
+						response->len,
+						NULL,
+						NULL,
+						&error)) {
+			g_debug ("Unable to send query reply: %s", error->message);
+			break;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * ascli_daemon_quit_cb:
+ */
+static gboolean
+ascli_daemon_quit_cb (GMainLoop *loop)
+{
+	g_main_loop_quit (loop);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * ascli_daemon_listen:
+ *
+ * Start answering queries for @pool on @socket_path. Connections are accepted
+ * in the thread-default main context of the calling thread.
+ */
+static GSocketService *
+ascli_daemon_listen (AsPool *pool, const gchar *socket_path, GError **error)
+{
+	g_autoptr(GSocketService) service = NULL;
+	g_autoptr(GSocketAddress) address = NULL;
+
+	service = g_threaded_socket_service_new (ASCLI_DAEMON_MAX_THREADS);
+	address = g_unix_socket_address_new (socket_path);
+	if (!g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+					    address,
+					    G_SOCKET_TYPE_STREAM,
+					    G_SOCKET_PROTOCOL_DEFAULT,
+					    NULL,
+					    NULL,
+					    error))
+		return NULL;
+	g_chmod (socket_path, 0600);
+	g_signal_connect (service, "run", G_CALLBACK (ascli_daemon_run_cb), pool);
+
+	g_socket_service_start (service);
+	return g_steal_pointer (&service);
+}
+
+struct _AsCliDaemonServer {
+	AsPool *pool;
+	gchar *socket_path;
+	GMainContext *context;
+	GMainLoop *loop;
+	GSocketService *service;
+	GThread *thread;
+};
+
+/**
+ * ascli_daemon_server_thread:
+ */
+static gpointer
+ascli_daemon_server_thread (AsCliDaemonServer *server)
+{
+	g_main_context_push_thread_default (server->context);
+	g_main_loop_run (server->loop);
+
+	g_socket_service_stop (server->service);
+	g_socket_listener_close (G_SOCKET_LISTENER (server->service));
+	g_main_context_pop_thread_default (server->context);
+
+	return NULL;
+}
+
+#endif /* G_OS_UNIX */
+
+/**
+ * ascli_daemon_server_start:
+ * @pool: The loaded pool to answer queries for.
+ * @socket_path: The socket to listen on.
+ * @error: A #GError
+ *
+ * Answer queries for @pool on @socket_path in a background thread
+ * of this process, like a separately started query daemon would.
+ *
+ * Returns: (transfer full): The running server, or %NULL on error.
+ */
+AsCliDaemonServer *
+ascli_daemon_server_start (AsPool *pool, const gchar *socket_path, GError **error)
+{
+#ifdef G_OS_UNIX
+	AsCliDaemonServer *server = g_new0 (AsCliDaemonServer, 1);
+
+	server->pool = g_object_ref (pool);
+	server->socket_path = g_strdup (socket_path);
+	server->context = g_main_context_new ();
+	server->loop = g_main_loop_new (server->context, FALSE);
+
+	/* accept connections in the context of our thread, not the caller's */
+	g_main_context_push_thread_default (server->context);
+	server->service = ascli_daemon_listen (pool, socket_path, error);
+	g_main_context_pop_thread_default (server->context);
+	if (server->service == NULL) {
+		ascli_daemon_server_stop (server);
+		return NULL;
+	}
+
+	server->thread = g_thread_new ("ascli-daemon",
+				       (GThreadFunc) ascli_daemon_server_thread,
+				       server);
+	return server;
+#else
+	g_set_error_literal (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_SUPPORTED,
+			     "The query daemon is not supported on this platform.");
+	return NULL;
+#endif
+}
+
+/**
+ * ascli_daemon_server_stop:
+ * @server: (nullable): A server created by ascli_daemon_server_start()
+ *
+ * Stop answering queries and free @server.
+ */
+void
+ascli_daemon_server_stop (AsCliDaemonServer *server)
+{
+#ifdef G_OS_UNIX
+	if (server == NULL)
+		return;
+
+	if (server->thread != NULL) {
+		g_main_loop_quit (server->loop);
+		g_thread_join (server->thread);
+		g_unlink (server->socket_path);
+	}
+	g_clear_object (&server->service);
+	g_main_loop_unref (server->loop);
+	g_main_context_unref (server->context);
+	g_object_unref (server->pool);
+	g_free (server->socket_path);
+	g_free (server);
+#endif
+}
+
+/**
+ * ascli_run_daemon:
+ *
+ * Load the metadata pool and answer queries on @socket_path until
+ * we receive SIGINT or SIGTERM.
+ */
+int
+ascli_run_daemon (const gchar *socket_path, const gchar *cachepath, gboolean no_cache)
+{
+#ifdef G_OS_UNIX
+	g_autofree gchar *socket_path_default = NULL;
+	g_autofree gchar *socket_dir = NULL;
+	g_autoptr(AsPool) pool = NULL;
+	g_autoptr(GSocketService) service = NULL;
+	g_autoptr(GMainLoop) loop = NULL;
+	g_autoptr(GError) error = NULL;
+
+	if (socket_path == NULL) {
+		socket_path_default = ascli_daemon_get_default_socket_path ();
+		socket_path = socket_path_default;
+	}
+
+	/* refuse to replace a running daemon, but clean up after one that went away */
+	if (g_file_test (socket_path, G_FILE_TEST_EXISTS)) {
+		g_autoptr(GSocketConnection) conn = ascli_daemon_connect (socket_path, NULL);
+		if (conn != NULL) {
+			/* TRANSLATORS: Another appstreamcli daemon is already running */
+			ascli_print_stderr (_("A query daemon is already listening on '%s'."),
+					    socket_path);
+			return ASCLI_EXIT_CODE_FAILED;
+		}
+		g_unlink (socket_path);
+	}
+	socket_dir = g_path_get_dirname (socket_path);
+	if (g_mkdir_with_parents (socket_dir, 0700) != 0) {
+		/* TRANSLATORS: The directory for the appstreamcli daemon socket could not be created */
+		ascli_print_stderr (_("Unable to create directory '%s': %s"),
+				    socket_dir,
+				    g_strerror (errno));
+		return ASCLI_EXIT_CODE_FAILED;
+	}
+
+	/* keep the data up to date for as long as we are running */
+	pool = as_pool_new ();
+	as_pool_add_flags (pool, AS_POOL_FLAG_MONITOR);
+	if (no_cache)
+		as_pool_add_flags (pool, AS_POOL_FLAG_IGNORE_CACHE_AGE);
+	if (cachepath != NULL)
+		as_pool_override_cache_locations (pool, cachepath, cachepath);
+	if (!as_pool_load (pool, NULL, &error)) {
+		g_printerr ("%s\n", error->message);
+		return ASCLI_EXIT_CODE_FAILED;
+	}
+
+	service = ascli_daemon_listen (pool, socket_path, &error);
+	if (service == NULL) {
+		/* TRANSLATORS: The appstreamcli daemon could not listen on its socket */
+		ascli_print_stderr (_("Unable to listen on '%s': %s"), socket_path, error->message);
+		return ASCLI_EXIT_CODE_FAILED;
+	}
+
+	loop = g_main_loop_new (NULL, FALSE);
+	g_unix_signal_add (SIGINT, (GSourceFunc) ascli_daemon_quit_cb, loop);
+	g_unix_signal_add (SIGTERM, (GSourceFunc) ascli_daemon_quit_cb, loop);
+
+	/* TRANSLATORS: The appstreamcli daemon is ready */
+	ascli_print_stdout (_("Answering metadata queries on '%s'."), socket_path);
+	g_main_loop_run (loop);
+
+	g_socket_service_stop (service);
+	g_socket_listener_close (G_SOCKET_LISTENER (service));
+	g_unlink (socket_path);
+
+	return ASCLI_EXIT_CODE_SUCCESS;
+#else
+	/* TRANSLATORS: The appstreamcli daemon needs UNIX sockets */
+	ascli_print_stderr (_("The query daemon is not supported on this platform."));
+	return ASCLI_EXIT_CODE_FAILED;
+#endif
+}
+
+/**
+ * ascli_daemon_query:
+ * @socket_path: The socket the daemon listens on.
+ * @kind: The kind of query.
+ * @value: The search term, component ID or provided item kind.
+ * @extra: The provided item, or %NULL
+ * @error: A #GError
+ *
+ * Ask a running query daemon for components.
+ *
+ * Returns: (transfer full): The found components, or %NULL on error.
+ */
+AsComponentBox *
+ascli_daemon_query (const gchar *socket_path,
+		    AsCliQueryKind kind,
+		    const gchar *value,
+		    const gchar *extra,
+		    GError **error)
+{
+#ifdef G_OS_UNIX
+	g_autoptr(GSocketConnection) conn = NULL;
+	g_autoptr(GDataInputStream) din = NULL;
+	g_autofree gchar *locale = NULL;
+	g_autofree gchar *locale_esc = NULL;
+	g_autofree gchar *value_esc = NULL;
+	g_autofree gchar *extra_esc = NULL;
+	g_autofree gchar *request = NULL;
+	g_autofree gchar *reply = NULL;
+	g_autofree gchar *data = NULL;
+	guint64 data_len;
+	gsize bytes_read;
+
+	conn = ascli_daemon_connect (socket_path, error);
+	if (conn == NULL)
+		return NULL;
+
+	locale = as_get_current_locale_bcp47 ();
+	locale_esc = g_strescape (locale, NULL);
+	value_esc = g_strescape (value != NULL ? value : "", NULL);
+	extra_esc = g_strescape (extra != NULL ? extra : "", NULL);
+	request = g_strdup_printf ("%s\t%s\t%s\t%s\t%s\n",
+				   ASCLI_DAEMON_PROTOCOL,
+				   ascli_query_kind_to_string (kind),
+				   locale_esc,
+				   value_esc,
+				   extra_esc);
+	if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (conn)),
+					request,
+					strlen (request),
+					NULL,
+					NULL,
+					error))
+		return NULL;
+
+	din = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (conn)));
+	reply = g_data_input_stream_read_line (din, NULL, NULL, error);
+	if (reply == NULL) {
+		if (error != NULL && *error == NULL)
+			g_set_error_literal (error,
+					     G_IO_ERROR,
+					     G_IO_ERROR_CONNECTION_CLOSED,
+					     "The query daemon closed the connection.");
+		return NULL;
+	}
+	if (g_str_has_prefix (reply, "ERR ")) {
+		g_autofree gchar *msg = g_strcompress (reply + 4);
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", msg);
+		return NULL;
+	}
+	if (!g_str_has_prefix (reply, "OK ")) {
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     "Invalid reply from the query daemon.");
+		return NULL;
+	}
+	data_len = g_ascii_strtoull (reply + 3, NULL, 10);
+	if (data_len > ASCLI_DAEMON_MAX_REPLY_SIZE) {
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     "Reply from the query daemon is too large.");
+		return NULL;
+	}
+
+	if (data_len == 0)
+		return as_component_box_new (AS_COMPONENT_BOX_FLAG_NO_CHECKS);
+
+	data = g_malloc (data_len + 1);
+	if (!g_input_stream_read_all (G_INPUT_STREAM (din),
+				      data,
+				      data_len,
+				      &bytes_read,
+				      NULL,
+				      error))
+		return NULL;
+	if (bytes_read != data_len) {
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_PARTIAL_INPUT,
+				     "Reply from the query daemon is incomplete.");
+		return NULL;
+	}
+	data[data_len] = '\0';
+
+	return ascli_daemon_components_from_data (data, data_len, locale, error);
+#else
+	g_set_error_literal (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_SUPPORTED,
+			     "The query daemon is not supported on this platform.");
+	return NULL;
+#endif
+}
+
+/**
+ * ascli_query_components:
+ * @cachepath: Manually selected cache location, or %NULL
+ * @no_cache: %TRUE if the cache should be rebuilt
+ * @kind: The kind of query.
+ * @value: The search term, component ID or provided item kind.
+ * @extra: The provided item, or %NULL
+ * @error: A #GError
+ *
+ * Query components, preferably from a running query daemon. If none is running
+ * or it can not answer the query, the metadata is loaded by this process.
+ *
+ * Returns: (transfer full): The found components, or %NULL on error.
+ */
+AsComponentBox *
+ascli_query_components (const gchar *cachepath,
+			gboolean no_cache,
+			AsCliQueryKind kind,
+			const gchar *value,
+			const gchar *extra,
+			GError **error)
+{
+	g_autoptr(AsPool) pool = NULL;
+	g_autoptr(GError) tmp_error = NULL;
+
+	/* the daemon only serves the default data */
+	if (cachepath == NULL && !no_cache) {
+		g_autofree gchar *socket_path = ascli_daemon_get_default_socket_path ();
+
+		if (g_file_test (socket_path, G_FILE_TEST_EXISTS)) {
+			AsComponentBox *cbox = ascli_daemon_query (socket_path,
+								   kind,
+								   value,
+								   extra,
+								   &tmp_error);
+			if (cbox != NULL)
+				return cbox;
+			g_debug ("Query daemon can not be used, loading data directly: %s",
+				 tmp_error->message);
+			g_clear_error (&tmp_error);
+		}
+	}
+
+	pool = ascli_data_pool_new_and_open (cachepath, no_cache, &tmp_error);
+	if (tmp_error != NULL) {
+		g_propagate_error (error, g_steal_pointer (&tmp_error));
+		return NULL;
+	}
+
+	return ascli_pool_query (pool, kind, value, extra, error);
+}
@@ -0,0 +1,83 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2012-2023 Matthias Klumpp <matthias@tenstral.net>
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 2.1 of the license, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ASCLI_DAEMON_H
+#define __ASCLI_DAEMON_H
+
+#include <glib-object.h>
+#include <appstream.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AsCliQueryKind:
+ * @ASCLI_QUERY_KIND_UNKNOWN:	Unknown query.
+ * @ASCLI_QUERY_KIND_SEARCH:	Full-text search for a term.
+ * @ASCLI_QUERY_KIND_GET:	Get components by their ID.
+ * @ASCLI_QUERY_KIND_PROVIDES:	Get components providing an item.
+ *
+ * Pool queries that can be answered by the query daemon.
+ **/
+typedef enum {
+	ASCLI_QUERY_KIND_UNKNOWN,
+	ASCLI_QUERY_KIND_SEARCH,
+	ASCLI_QUERY_KIND_GET,
+	ASCLI_QUERY_KIND_PROVIDES,
+	/*< private >*/
+	ASCLI_QUERY_KIND_LAST
+} AsCliQueryKind;
+
+typedef struct _AsCliDaemonServer AsCliDaemonServer;
+
+gchar	       *ascli_daemon_get_default_socket_path (void);
+
+int		ascli_run_daemon (const gchar *socket_path,
+				  const gchar *cachepath,
+				  gboolean     no_cache);
+
+gchar	       *ascli_daemon_components_to_data (AsComponentBox *cbox,
+						 const gchar	*locale,
+						 GError	       **error);
+AsComponentBox *ascli_daemon_components_from_data (const gchar *data,
+						   gssize	data_len,
+						   const gchar *locale,
+						   GError     **error);
+
+AsComponentBox *ascli_daemon_query (const gchar	*socket_path,
+				    AsCliQueryKind kind,
+				    const gchar	*value,
+				    const gchar	*extra,
+				    GError	     **error);
+
+AsCliDaemonServer *ascli_daemon_server_start (AsPool	    *pool,
+					      const gchar *socket_path,
+					      GError	 **error);
+void		   ascli_daemon_server_stop (AsCliDaemonServer *server);
+
+AsComponentBox *ascli_query_components (const gchar   *cachepath,
+					gboolean       no_cache,
+					AsCliQueryKind kind,
+					const gchar   *value,
+					const gchar   *extra,
+					GError	     **error);
+
+G_END_DECLS
+
+#endif /* __ASCLI_DAEMON_H */
@@ -266,6 +266,31 @@ ascli_ptrarray_to_pretty (GPtrArray *array, guint indent)
 	return g_string_free (rstr, FALSE);
 }
 
+/**
+ * ascli_component_find_icon:
+ *
+ * Find the icon we show for a component.
+ */
+static AsIcon *
+ascli_component_find_icon (AsComponent *cpt)
+{
+	AsIcon *icon;
+	GPtrArray *icons;
+
+	icon = as_component_get_icon_by_size (cpt, 64, 64);
+	if (icon != NULL)
+		return icon;
+
+	icons = as_component_get_icons (cpt);
+	for (guint j = 0; j < icons->len; j++) {
+		AsIcon *tmp_icon = AS_ICON (g_ptr_array_index (icons, j));
+		if (as_icon_get_kind (tmp_icon) == AS_ICON_KIND_STOCK)
+			return tmp_icon;
+	}
+
+	return NULL;
+}
+
 /**
  * ascli_print_component:
  *
@@ -285,18 +310,7 @@ ascli_print_component (AsComponent *cpt, gboolean show_detailed)
 	if (as_component_get_pkgnames (cpt) != NULL)
 		pkgs_str = g_strjoinv (", ", as_component_get_pkgnames (cpt));
 	bundles_str = as_get_bundle_str (cpt);
-
-	icon = as_component_get_icon_by_size (cpt, 64, 64);
-	if (icon == NULL) {
-		GPtrArray *icons = as_component_get_icons (cpt);
-		for (guint j = 0; j < icons->len; j++) {
-			AsIcon *tmp_icon = AS_ICON (g_ptr_array_index (icons, j));
-			if (as_icon_get_kind (tmp_icon) == AS_ICON_KIND_STOCK) {
-				icon = tmp_icon;
-				break;
-			}
-		}
-	}
+	icon = ascli_component_find_icon (cpt);
 
 	ascli_print_key_value (_("Identifier"), short_idline, FALSE);
 	if (show_detailed && as_component_get_kind (cpt) != AS_COMPONENT_KIND_OPERATING_SYSTEM)
@@ -460,6 +474,377 @@ ascli_print_components (AsComponentBox *cbox, gboolean show_detailed)
 	}
 }
 
+/**
+ * ascli_json_append_string:
+ *
+ * Append a string as JSON value.
+ */
+static void
+ascli_json_append_string (GString *json, const gchar *value)
+{
+	if (value == NULL) {
+		g_string_append (json, "null");
+		return;
+	}
+
+	g_string_append_c (json, '"');
+	for (const gchar *p = value; *p != '\0'; p++) {
+		switch (*p) {
+		case '"':
+			g_string_append (json, "\\\"");
+			break;
+		case '\\':
+			g_string_append (json, "\\\\");
+			break;
+		case '\n':
+			g_string_append (json, "\\n");
+			break;
+		case '\t':
+			g_string_append (json, "\\t");
+			break;
+		case '\r':
+			g_string_append (json, "\\r");
+			break;
+		default:
+			if ((guchar) *p < 0x20)
+				g_string_append_printf (json, "\\u%04x", (guint) *p);
+			else
+				g_string_append_c (json, *p);
+		}
+	}
+	g_string_append_c (json, '"');
+}
+
+/**
+ * ascli_json_append_ptrarray:
+ *
+ * Append an array of strings as JSON value.
+ */
+static void
+ascli_json_append_ptrarray (GString *json, GPtrArray *array)
+{
+	g_string_append_c (json, '[');
+	for (guint i = 0; array != NULL && i < array->len; i++) {
+		if (i > 0)
+			g_string_append_c (json, ',');
+		ascli_json_append_string (json, g_ptr_array_index (array, i));
+	}
+	g_string_append_c (json, ']');
+}
+
+static void
+ascli_json_field_id (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_id (cpt));
+}
+
+static void
+ascli_json_field_kind (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_kind_to_string (as_component_get_kind (cpt)));
+}
+
+static void
+ascli_json_field_data_id (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_data_id (cpt));
+}
+
+static void
+ascli_json_field_name (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_name (cpt));
+}
+
+static void
+ascli_json_field_summary (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_summary (cpt));
+}
+
+static void
+ascli_json_field_description (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_description (cpt));
+}
+
+static void
+ascli_json_field_packages (GString *json, AsComponent *cpt)
+{
+	gchar **pkgnames = as_component_get_pkgnames (cpt);
+
+	g_string_append_c (json, '[');
+	for (guint i = 0; pkgnames != NULL && pkgnames[i] != NULL; i++) {
+		if (i > 0)
+			g_string_append_c (json, ',');
+		ascli_json_append_string (json, pkgnames[i]);
+	}
+	g_string_append_c (json, ']');
+}
+
+static void
+ascli_json_field_bundles (GString *json, AsComponent *cpt)
+{
+	gboolean first = TRUE;
+
+	g_string_append_c (json, '{');
+	for (guint i = 0; i < AS_BUNDLE_KIND_LAST; i++) {
+		AsBundle *bundle = as_component_get_bundle (cpt, (AsBundleKind) i);
+		if (bundle == NULL)
+			continue;
+		if (!first)
+			g_string_append_c (json, ',');
+		first = FALSE;
+		ascli_json_append_string (json, as_bundle_kind_to_string ((AsBundleKind) i));
+		g_string_append_c (json, ':');
+		ascli_json_append_string (json, as_bundle_get_id (bundle));
+	}
+	g_string_append_c (json, '}');
+}
+
+static void
+ascli_json_field_homepage (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_url (cpt, AS_URL_KIND_HOMEPAGE));
+}
+
+static void
+ascli_json_field_icon (GString *json, AsComponent *cpt)
+{
+	AsIcon *icon = ascli_component_find_icon (cpt);
+	ascli_json_append_string (json, icon == NULL ? NULL : as_icon_get_name (icon));
+}
+
+static void
+ascli_json_field_developer (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_developer_name (cpt));
+}
+
+static void
+ascli_json_field_license (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_project_license (cpt));
+}
+
+static void
+ascli_json_field_categories (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_ptrarray (json, as_component_get_categories (cpt));
+}
+
+static void
+ascli_json_field_origin (GString *json, AsComponent *cpt)
+{
+	ascli_json_append_string (json, as_component_get_origin (cpt));
+}
+
+typedef struct {
+	const gchar *name;
+	void (*append_fn) (GString *json, AsComponent *cpt);
+} AsCliJsonField;
+
+static const AsCliJsonField ascli_json_fields[] = {
+	{ "id",		 ascli_json_field_id	      },
+	{ "kind",	 ascli_json_field_kind	      },
+	{ "data-id",	 ascli_json_field_data_id     },
+	{ "name",	 ascli_json_field_name	      },
+	{ "summary",	 ascli_json_field_summary     },
+	{ "description", ascli_json_field_description },
+	{ "packages",	 ascli_json_field_packages    },
+	{ "bundles",	 ascli_json_field_bundles     },
+	{ "homepage",	 ascli_json_field_homepage    },
+	{ "icon",	 ascli_json_field_icon	      },
+	{ "developer",	 ascli_json_field_developer   },
+	{ "license",	 ascli_json_field_license     },
+	{ "categories",	 ascli_json_field_categories  },
+	{ "origin",	 ascli_json_field_origin      },
+	{ NULL,		 NULL			      }
+};
+
+/* the fields shown by default, matching the short text output */
+static const gchar *ascli_json_default_fields[] =
+    { "id", "kind", "name", "summary", "packages", "bundles", "homepage", "icon", NULL };
+
+/**
+ * ascli_output_format_from_string:
+ *
+ * Returns: The output format for a name, text output if @str is %NULL.
+ */
+AsCliOutputFormat
+ascli_output_format_from_string (const gchar *str)
+{
+	if (str == NULL || g_strcmp0 (str, "text") == 0)
+		return ASCLI_OUTPUT_FORMAT_TEXT;
+	if (g_strcmp0 (str, "json") == 0)
+		return ASCLI_OUTPUT_FORMAT_JSON;
+	if (g_strcmp0 (str, "ndjson") == 0)
+		return ASCLI_OUTPUT_FORMAT_NDJSON;
+	return ASCLI_OUTPUT_FORMAT_UNKNOWN;
+}
+
+/**
+ * ascli_json_fields_validate:
+ * @fields: (nullable): Names of the fields to print.
+ *
+ * Check if all requested fields are known, and print an error if they are not.
+ *
+ * Returns: %TRUE if all fields are known.
+ */
+gboolean
+ascli_json_fields_validate (gchar **fields)
+{
+	for (guint i = 0; fields != NULL && fields[i] != NULL; i++) {
+		gboolean found = FALSE;
+
+		for (guint j = 0; ascli_json_fields[j].name != NULL; j++) {
+			if (g_strcmp0 (fields[i], ascli_json_fields[j].name) == 0) {
+				found = TRUE;
+				break;
+			}
+		}
+		if (found)
+			continue;
+
+		/* TRANSLATORS: An unknown field was selected for JSON output */
+		ascli_print_stderr (_("Unknown field '%s'. Valid fields are:"), fields[i]);
+		for (guint j = 0; ascli_json_fields[j].name != NULL; j++)
+			g_printerr (" • %s\n", ascli_json_fields[j].name);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ascli_component_to_json:
+ *
+ * Append the selected fields of a component as JSON object.
+ */
+static void
+ascli_component_to_json (GString *json,
+			 AsComponent *cpt,
+			 const AsCliJsonField **fields,
+			 guint n_fields)
+{
+	g_string_append_c (json, '{');
+	for (guint i = 0; i < n_fields; i++) {
+		if (i > 0)
+			g_string_append_c (json, ',');
+		ascli_json_append_string (json, fields[i]->name);
+		g_string_append_c (json, ':');
+		fields[i]->append_fn (json, cpt);
+	}
+	g_string_append_c (json, '}');
+}
+
+/**
+ * ascli_json_fields_resolve:
+ *
+ * Look up the writers of the selected fields. Fields that are selected
+ * more than once are only written once.
+ *
+ * Returns: (transfer container): The field writers.
+ */
+static const AsCliJsonField **
+ascli_json_fields_resolve (gchar **field_names, guint *n_fields)
+{
+	const AsCliJsonField **fields;
+	const gchar *const *names;
+
+	names = field_names != NULL ? (const gchar *const *) field_names
+				    : ascli_json_default_fields;
+	fields = g_new0 (const AsCliJsonField *, g_strv_length ((gchar **) names) + 1);
+	*n_fields = 0;
+	for (guint i = 0; names[i] != NULL; i++) {
+		for (guint j = 0; ascli_json_fields[j].name != NULL; j++) {
+			gboolean duplicate = FALSE;
+
+			if (g_strcmp0 (names[i], ascli_json_fields[j].name) != 0)
+				continue;
+			for (guint k = 0; k < *n_fields; k++) {
+				if (fields[k] == &ascli_json_fields[j]) {
+					duplicate = TRUE;
+					break;
+				}
+			}
+			if (!duplicate)
+				fields[(*n_fields)++] = &ascli_json_fields[j];
+			break;
+		}
+	}
+
+	return fields;
+}
+
+/**
+ * ascli_component_to_json_string:
+ * @cpt: The component.
+ * @field_names: (nullable): Names of the fields to include, or %NULL for the default set.
+ *
+ * Get the selected fields of a component as JSON object.
+ *
+ * Returns: (transfer full): The JSON object.
+ */
+gchar *
+ascli_component_to_json_string (AsComponent *cpt, gchar **field_names)
+{
+	g_autofree const AsCliJsonField **fields = NULL;
+	GString *json = g_string_new (NULL);
+	guint n_fields;
+
+	fields = ascli_json_fields_resolve (field_names, &n_fields);
+	ascli_component_to_json (json, cpt, fields, n_fields);
+	return g_string_free (json, FALSE);
+}
+
+/**
+ * ascli_print_components_json:
+ * @cbox: The components.
+ * @offset: Number of components to skip.
+ * @limit: Maximum number of components to print, or 0 for no limit.
+ * @field_names: (nullable): Names of the fields to print, or %NULL for the default set.
+ * @ndjson: %TRUE to print one object per line, instead of a single JSON document.
+ *
+ * Print the selected fields of components as JSON to stdout.
+ * Only the fields that were selected are looked up for each component.
+ */
+void
+ascli_print_components_json (AsComponentBox *cbox,
+			     guint offset,
+			     guint limit,
+			     gchar **field_names,
+			     gboolean ndjson)
+{
+	g_autofree const AsCliJsonField **fields = NULL;
+	g_autoptr(GString) json = NULL;
+	guint n_fields;
+	guint n_cpts = as_component_box_len (cbox);
+	guint end;
+
+	/* resolve the selected fields once, instead of for each component */
+	fields = ascli_json_fields_resolve (field_names, &n_fields);
+
+	if (offset > n_cpts)
+		offset = n_cpts;
+	end = (limit == 0 || limit > n_cpts - offset) ? n_cpts : offset + limit;
+
+	json = g_string_sized_new (1024);
+	if (!ndjson)
+		g_print ("{\"total\":%u,\"offset\":%u,\"components\":[", n_cpts, offset);
+	for (guint i = offset; i < end; i++) {
+		g_string_truncate (json, 0);
+		if (!ndjson)
+			g_string_append (json, i == offset ? "\n" : ",\n");
+		ascli_component_to_json (json, as_component_box_index (cbox, i), fields, n_fields);
+		if (ndjson)
+			g_string_append_c (json, '\n');
+		g_print ("%s", json->str);
+	}
+	if (!ndjson)
+		g_print ("\n]}\n");
+}
+
 /**
  * ascli_data_pool_new_and_open:
  */
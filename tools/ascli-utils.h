@@ -34,6 +34,22 @@ G_BEGIN_DECLS
 #define ASCLI_EXIT_CODE_FATAL		  5
 #define ASCLI_EXIT_CODE_VALIDATION_FAILED 6
 
+/**
+ * AsCliOutputFormat:
+ * @ASCLI_OUTPUT_FORMAT_UNKNOWN:	Unknown output format.
+ * @ASCLI_OUTPUT_FORMAT_TEXT:		Human-readable text.
+ * @ASCLI_OUTPUT_FORMAT_JSON:		A single JSON document.
+ * @ASCLI_OUTPUT_FORMAT_NDJSON:		One JSON object per line.
+ *
+ * Output formats for component listings.
+ **/
+typedef enum {
+	ASCLI_OUTPUT_FORMAT_UNKNOWN,
+	ASCLI_OUTPUT_FORMAT_TEXT,
+	ASCLI_OUTPUT_FORMAT_JSON,
+	ASCLI_OUTPUT_FORMAT_NDJSON,
+} AsCliOutputFormat;
+
 #define ASCLI_CHAR_SUCCESS ascli_get_char_success ()
 #define ASCLI_CHAR_FAIL	   ascli_get_char_failure ()
 
@@ -51,6 +67,15 @@ const gchar *ascli_get_char_failure (void);
 void	     ascli_print_component (AsComponent *cpt, gboolean show_detailed);
 void	     ascli_print_components (AsComponentBox *cbox, gboolean show_detailed);
 
+AsCliOutputFormat ascli_output_format_from_string (const gchar *str);
+gboolean	  ascli_json_fields_validate (gchar **fields);
+gchar		 *ascli_component_to_json_string (AsComponent *cpt, gchar **field_names);
+void		  ascli_print_components_json (AsComponentBox *cbox,
+					       guint	       offset,
+					       guint	       limit,
+					       gchar	     **field_names,
+					       gboolean	       ndjson);
+
 AsPool	*ascli_data_pool_new_and_open (const gchar *cachepath, gboolean no_cache, GError **error);
 
 void	 ascli_set_output_colored (gboolean colored);